@@ -0,0 +1,513 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Benchmarks .cpp file (sparq_bench)
+ *
+ * Times the list operations and loading and saving files at several sizes, and prints the results
+ * as JSON so runs can be compared to find regressions:
+ *
+ *   sparq_bench [--sizes 10k,1M,10M] [--repeat n] [--filter text] [--dir directory] [--json file]
+ *
+ * Lines are generated from a fixed seed so every run times the same text. Each benchmark is run
+ * --repeat times (3 by default) and the median and fastest runs are reported, with heap allocations
+ * counted by replacing the global operator new.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "LinkedList.h"
+#include "Editor.h"
+#include "LineIndex.h"
+#include "ThreadPool.h"
+
+// Heap allocations since the program started, every operator new counts one
+static std::atomic<uint64_t> allocations(0);
+
+/**
+ * Summary: Every replaced operator new allocates here.
+ *
+ * @param size_t size
+ * @return memory from malloc
+ */
+static void* countedAllocation(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+} // end countedAllocation function
+
+// Once these are inlined into each other GCC sees free() given memory from operator new, not the
+// malloc() underneath it, and warns that they don't match
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+    return countedAllocation(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAllocation(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+// Seed for the generated lines, fixed so every run times the same text
+const uint64_t LineSeed = 0x5eed5eed5eed5eedULL;
+
+// Roughly how many nodes a walk benchmark visits in total, so every size takes about as long
+const uint64_t NodesPerWalk = 100000000;
+
+// Most inserts and deletes timed in the middle of the list (each walks to it)
+const uint64_t MostEdits = 1000;
+
+// One benchmark's numbers at one size
+struct Result {
+    std::string name;
+    uint64_t lines; // in the list or file
+    uint64_t ops; // timed operations in each run
+    uint64_t linesPerOp; // lines each operation goes through, for lines per second
+    uint64_t bytes; // bytes each run goes through, for bytes per second
+    std::vector<double> seconds; // each run
+    uint64_t allocations; // in the median run
+};
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: Makes line number i of the generated text. Lines are 0 to 80 characters of words,
+ * like source code or a log, and the same every run.
+ *
+ * @param uint64_t i
+ * @return line
+ */
+static std::string makeLine(uint64_t i) {
+
+    // splitmix64, so any line can be made without the ones before it
+    uint64_t state = LineSeed + i * 0x9e3779b97f4a7c15ULL;
+    auto next = [&state]() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    };
+
+    static const char* words[] = {"int", "return", "value", "node", "list", "index", "for", "if",
+                                  "the", "line", "data", "next", "= 0;", "{", "}", "// note"};
+    size_t length = next() % 81;
+    std::string line;
+    line.reserve(length + 8);
+    while (line.size() < length) {
+        line += words[next() % 16];
+        line += ' ';
+    }
+    line.resize(length);
+    return line;
+} // end makeLine function
+
+/**
+ * Summary: Fills a list with the first count generated lines.
+ *
+ * @param LinkedList &list
+ * @param uint64_t count
+ * @return bytes of text added
+ */
+static uint64_t fillList(LinkedList &list, uint64_t count) {
+
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string line = makeLine(i);
+        bytes += line.size() + 1;
+        list.Add((int) i + 1, std::move(line));
+    }
+    return bytes;
+} // end fillList function
+
+/**
+ * Summary: Writes the first count generated lines to a file.
+ *
+ * @param const string &filename
+ * @param uint64_t count
+ * @return size of the file
+ */
+static uint64_t writeFile(const std::string &filename, uint64_t count) {
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    uint64_t bytes = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        std::string line = makeLine(i);
+        if (i > 0) {
+            file << '\n';
+            bytes++;
+        }
+        file << line;
+        bytes += line.size();
+    }
+    return bytes;
+} // end writeFile function
+
+/**
+ * Summary: Times a benchmark. setUp and tearDown run outside the timing for every run.
+ *
+ * @param Result &result name, lines, ops, linesPerOp and bytes filled in
+ * @param int repeat
+ * @param function setUp
+ * @param function body the timed part
+ * @param function tearDown
+ */
+static void measure(Result &result, int repeat, const std::function<void()> &setUp,
+                    const std::function<void()> &body, const std::function<void()> &tearDown) {
+
+    std::vector<std::pair<double, uint64_t>> runs;
+
+    for (int run = 0; run < repeat; ++run) {
+        setUp();
+
+        uint64_t allocationsBefore = allocations.load(std::memory_order_relaxed);
+        auto started = std::chrono::steady_clock::now();
+        body();
+        auto finished = std::chrono::steady_clock::now();
+        uint64_t allocated = allocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+        tearDown();
+        runs.emplace_back(std::chrono::duration<double>(finished - started).count(), allocated);
+    }
+
+    std::sort(runs.begin(), runs.end());
+    for (auto &run : runs) {
+        result.seconds.push_back(run.first);
+    }
+    result.allocations = runs[runs.size() / 2].second;
+} // end measure function
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: Runs every benchmark whose name contains filter at one size.
+ *
+ * @param uint64_t lines
+ * @param int repeat
+ * @param const string &filter
+ * @param const string &directory for the files loaded and saved
+ * @param vector<Result> &results
+ */
+static void runBenchmarks(uint64_t lines, int repeat, const std::string &filter, const std::string &directory,
+                          std::vector<Result> &results) {
+
+    auto wanted = [&filter](const std::string &name) {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    };
+
+    std::unique_ptr<LinkedList> list;
+    uint64_t textBytes = 0;
+    uint64_t edits = std::max<uint64_t>(10, std::min<uint64_t>(MostEdits, NodesPerWalk / 10 / lines));
+    uint64_t walks = std::max<uint64_t>(1, NodesPerWalk / lines);
+    int middle = (int) (lines / 2);
+
+    // A fresh full list for benchmarks that change it
+    auto freshList = [&]() {
+        list.reset(new LinkedList());
+        textBytes = fillList(*list, lines);
+    };
+    auto dropList = [&]() {
+        list.reset();
+    };
+
+    if (wanted("LinkedList::Add")) {
+        Result result{"LinkedList::Add", lines, lines, 1, 0, {}, 0};
+        std::vector<std::string> text;
+        measure(result, repeat, [&]() {
+            list.reset(new LinkedList());
+            text.clear();
+            result.bytes = 0;
+            for (uint64_t i = 0; i < lines; ++i) {
+                text.push_back(makeLine(i));
+                result.bytes += text.back().size() + 1;
+            }
+        }, [&]() {
+            for (uint64_t i = 0; i < lines; ++i) {
+                list->Add((int) i + 1, std::move(text[i]));
+            }
+        }, dropList);
+        results.push_back(result);
+    }
+
+    if (wanted("LinkedList::Insert")) {
+        // Each insert walks to the middle of the list
+        Result result{"LinkedList::Insert", lines, edits, lines / 2, 0, {}, 0};
+        std::vector<std::string> text;
+        for (uint64_t i = 0; i < edits; ++i) {
+            text.push_back(makeLine(i));
+            result.bytes += text.back().size() + 1;
+        }
+        measure(result, repeat, freshList, [&]() {
+            for (uint64_t i = 0; i < edits; ++i) {
+                list->Insert(middle, middle, text[i]);
+            }
+        }, dropList);
+        results.push_back(result);
+    }
+
+    if (wanted("LinkedList::Delete")) {
+        Result result{"LinkedList::Delete", lines, edits, lines / 2, 0, {}, 0};
+        measure(result, repeat, freshList, [&]() {
+            for (uint64_t i = 0; i < edits; ++i) {
+                list->Delete(middle - (int) i);
+            }
+        }, dropList);
+        results.push_back(result);
+    }
+
+    if (wanted("LinkedList::getLineCount") || wanted("LinkedList::reorderIndexes")) {
+        freshList();
+
+        if (wanted("LinkedList::getLineCount")) {
+            Result result{"LinkedList::getLineCount", lines, walks, lines, textBytes * walks, {}, 0};
+            volatile int counted = 0;
+            measure(result, repeat, []() {}, [&]() {
+                for (uint64_t i = 0; i < walks; ++i) {
+                    counted = list->getLineCount();
+                }
+            }, []() {});
+            results.push_back(result);
+        }
+
+        if (wanted("LinkedList::reorderIndexes")) {
+            Result result{"LinkedList::reorderIndexes", lines, walks, lines, textBytes * walks, {}, 0};
+            measure(result, repeat, []() {}, [&]() {
+                for (uint64_t i = 0; i < walks; ++i) {
+                    list->reorderIndexes();
+                }
+            }, []() {});
+            results.push_back(result);
+        }
+
+        dropList();
+    }
+
+    if (!wanted("Editor::populateListFromFile") && !wanted("Editor::saveWriteFile")) {
+        return;
+    }
+
+    std::string filename = directory + "/sparq_bench_" + std::to_string(lines) + ".txt";
+    uint64_t fileBytes = writeFile(filename, lines);
+    std::ostringstream messages; // "Writing... Complete!" and the like
+
+    auto removeSidecar = [&filename]() {
+        std::remove(LineIndex::sidecarPath(filename).c_str());
+    };
+
+    if (wanted("Editor::populateListFromFile")) {
+        Result result{"Editor::populateListFromFile", lines, lines, 1, fileBytes, {}, 0};
+        std::unique_ptr<Editor> editor;
+        measure(result, repeat, [&]() {
+            removeSidecar();
+            editor.reset(new Editor());
+            editor->out = &messages;
+        }, [&]() {
+            editor->populateListFromFile(filename, &editor->list);
+        }, [&]() {
+            editor.reset();
+        });
+        results.push_back(result);
+    }
+
+    if (wanted("Editor::saveWriteFile")) {
+        Result result{"Editor::saveWriteFile", lines, lines, 1, fileBytes, {}, 0};
+        Editor editor;
+        editor.out = &messages;
+        fillList(editor.list, lines);
+        std::string savedName = filename + ".saved";
+        measure(result, repeat, []() {}, [&]() {
+            editor.saveWriteFile(savedName, &editor.list);
+        }, [&]() {
+            std::remove(savedName.c_str());
+        });
+        results.push_back(result);
+    }
+
+    removeSidecar();
+    std::remove(filename.c_str());
+} // end runBenchmarks function
+
+/**
+ * Summary: Writes the results as JSON.
+ *
+ * @param const vector<Result> &results
+ * @param int repeat
+ * @param ostream &output
+ */
+static void writeJson(const std::vector<Result> &results, int repeat, std::ostream &output) {
+
+    output << "{\n";
+    output << "  \"version\": 1,\n";
+#ifdef __VERSION__
+    output << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#endif
+#ifdef NDEBUG
+    output << "  \"optimized\": true,\n";
+#else
+    output << "  \"optimized\": false,\n";
+#endif
+    output << "  \"threads\": " << ThreadPool::shared().size() << ",\n";
+    output << "  \"repeat\": " << repeat << ",\n";
+    output << "  \"results\": [";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result &result = results[i];
+        double median = result.seconds[result.seconds.size() / 2];
+        double fastest = result.seconds.front();
+        double ops = (double) result.ops;
+
+        std::ostringstream entry;
+        entry.precision(6);
+        entry << std::fixed;
+        entry << "\n    {\"name\": \"" << result.name << "\", \"lines\": " << result.lines
+              << ", \"ops\": " << result.ops
+              << ", \"seconds\": " << median
+              << ", \"ns_per_op\": " << median * 1e9 / ops
+              << ", \"min_ns_per_op\": " << fastest * 1e9 / ops
+              << ", \"lines_per_sec\": " << (median > 0 ? ops * (double) result.linesPerOp / median : 0.0)
+              << ", \"bytes_per_sec\": " << (median > 0 ? (double) result.bytes / median : 0.0)
+              << ", \"allocations\": " << result.allocations
+              << ", \"allocations_per_op\": " << (double) result.allocations / ops << "}";
+
+        output << entry.str() << (i + 1 < results.size() ? "," : "");
+    }
+
+    output << "\n  ]\n}\n";
+} // end writeJson function
+
+/**
+ * Summary: Parses a size like 10k or 1M (powers of 1000, these are line counts).
+ *
+ * @param const string &text
+ * @return line count, 0 if it isn't a valid size
+ */
+static uint64_t parseLines(const std::string &text) {
+
+    size_t digits = 0;
+    uint64_t value = 0;
+
+    while (digits < text.size() && text[digits] >= '0' && text[digits] <= '9') {
+        value = value * 10 + (uint64_t) (text[digits] - '0');
+        digits++;
+    }
+
+    if (digits == 0) { return 0; }
+    if (digits == text.size()) { return value; }
+    if (digits + 1 != text.size()) { return 0; }
+
+    switch (text[digits]) {
+        case 'k':
+        case 'K':
+            return value * 1000;
+        case 'M':
+            return value * 1000000;
+        default:
+            return 0;
+    }
+} // end parseLines function
+
+// --------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+
+    std::vector<uint64_t> sizes = {10000, 1000000, 10000000};
+    int repeat = 3;
+    std::string filter;
+    std::string directory = ".";
+    std::string jsonName;
+
+    for (int arg = 1; arg < argc; ++arg) {
+        std::string option = argv[arg];
+
+        if (option == "--sizes" && arg + 1 < argc) {
+            sizes.clear();
+            std::istringstream list(argv[++arg]);
+            std::string size;
+            while (getline(list, size, ',')) {
+                uint64_t lines = parseLines(size);
+                if (lines == 0 || lines > INT_MAX) {
+                    std::cerr << "Invalid size '" << size << "', use a line count like 10k or 1M." << std::endl;
+                    return 1;
+                }
+                sizes.push_back(lines);
+            }
+        } else if (option == "--repeat" && arg + 1 < argc) {
+            repeat = std::atoi(argv[++arg]);
+            if (repeat < 1) {
+                std::cerr << "Invalid repeat count '" << argv[arg] << "'." << std::endl;
+                return 1;
+            }
+        } else if (option == "--filter" && arg + 1 < argc) {
+            filter = argv[++arg];
+        } else if (option == "--dir" && arg + 1 < argc) {
+            directory = argv[++arg];
+        } else if (option == "--json" && arg + 1 < argc) {
+            jsonName = argv[++arg];
+        } else {
+            std::cerr << "Usage: sparq_bench [--sizes 10k,1M,10M] [--repeat n] [--filter text] [--dir directory] [--json file]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (uint64_t lines : sizes) {
+        std::cerr << "Running " << lines << " lines..." << std::endl;
+        runBenchmarks(lines, repeat, filter, directory, results);
+    }
+
+    if (jsonName.empty()) {
+        writeJson(results, repeat, std::cout);
+        return 0;
+    }
+
+    std::ofstream json(jsonName, std::ios::trunc);
+    writeJson(results, repeat, json);
+    json.close();
+    if (json.fail()) {
+        std::cerr << "Unable to write '" << jsonName << "'." << std::endl;
+        return 1;
+    }
+    return 0;
+} // end main routine
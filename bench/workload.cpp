@@ -0,0 +1,556 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Workload .cpp file (sparq_workload)
+ *
+ * Makes synthetic files and editing sessions and replays sessions through the editor, to time it on
+ * workloads shaped like real ones:
+ *
+ *   sparq_workload file --lines n [--lengths fixed:40|uniform:0-120|lognormal:40]
+ *                       [--content words|random|repeat:k] [--seed s] [--out file]
+ *   sparq_workload trace --lines n --commands n [--mix L=20,I=10,D=10,A=60] [--seed s] [--out file]
+ *   sparq_workload replay --file file --trace file [--json file]
+ *
+ * A trace is what would have been typed at the prompt, one line each, so a recorded session can be
+ * replayed too. The replay loads the file into an Editor and runs every line through
+ * textCommandEntered() or addDataToList() like the prompt does, with the output thrown away, and
+ * reports latency percentiles for each kind of command. E isn't run, the file is never saved.
+ *
+ * The same seed always gives the same file and trace, on any platform: the random numbers and
+ * distributions are computed here rather than taken from <random>, whose distributions differ
+ * between standard libraries.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Editor.h"
+
+// Trace commands by name, with how often each is picked by default
+struct Weight {
+    std::string name;
+    double weight;
+};
+
+// Lines a generated L n m lists
+const int ListWindow = 20;
+
+// Most lines a generated D n m deletes
+const int MostDeleted = 5;
+
+// --------------------------------------------------------------------------------
+
+// splitmix64, small and the same everywhere
+class Random {
+
+private:
+    uint64_t state;
+
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // From 0 up to but not including 1
+    double unit() { return (double) (next() >> 11) / 9007199254740992.0; }
+
+    // From low to high inclusive
+    int64_t between(int64_t low, int64_t high) {
+        return low + (int64_t) (next() % (uint64_t) (high - low + 1));
+    }
+
+    // Standard normal, Box-Muller
+    double normal() {
+        double u = unit();
+        double v = unit();
+        return std::sqrt(-2.0 * std::log(1.0 - u)) * std::cos(6.283185307179586 * v);
+    }
+};
+
+/**
+ * Summary: Splits text at a separator.
+ *
+ * @param const string &text
+ * @param char separator
+ * @return parts
+ */
+static std::vector<std::string> split(const std::string &text, char separator) {
+
+    std::vector<std::string> parts;
+    std::istringstream stream(text);
+    std::string part;
+    while (getline(stream, part, separator)) {
+        parts.push_back(part);
+    }
+    return parts;
+} // end split function
+
+/**
+ * Summary: Finds the value of an option, like --lines 1000.
+ *
+ * @param const vector<string> &arguments
+ * @param const string &option
+ * @param const string &fallback returned when the option isn't given
+ * @return value
+ */
+static std::string optionValue(const std::vector<std::string> &arguments, const std::string &option,
+                               const std::string &fallback) {
+
+    for (size_t i = 0; i + 1 < arguments.size(); ++i) {
+        if (arguments[i] == option) {
+            return arguments[i + 1];
+        }
+    }
+    return fallback;
+} // end optionValue function
+
+/**
+ * Summary: Opens the output, stdout when no file is given.
+ *
+ * @param const string &filename empty or - for stdout
+ * @param ofstream &file opened here when there is a filename
+ * @return the stream to write to, nullptr if the file can't be opened
+ */
+static std::ostream* openOutput(const std::string &filename, std::ofstream &file) {
+
+    if (filename.empty() || filename == "-") {
+        return &std::cout;
+    }
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (file.fail()) {
+        std::cerr << "Unable to open '" << filename << "'." << std::endl;
+        return nullptr;
+    }
+    return &file;
+} // end openOutput function
+
+// --------------------------------------------------------------------------------
+
+// How long the generated lines are
+class LineLengths {
+
+private:
+    enum shape { shapeFixed, shapeUniform, shapeLognormal };
+    shape kind;
+    double first; // the length, the shortest, or the mean
+    double second; // the longest
+
+public:
+    LineLengths() : kind(shapeFixed), first(40), second(40) {}
+
+    /**
+     * Summary: Reads fixed:n, uniform:low-high or lognormal:mean.
+     *
+     * @param const string &text
+     * @return false if it isn't one of those
+     */
+    bool parse(const std::string &text) {
+
+        std::vector<std::string> parts = split(text, ':');
+        if (parts.size() != 2 || parts[1].empty()) {
+            return false;
+        }
+
+        if (parts[0] == "fixed") {
+            kind = shapeFixed;
+            first = second = std::atof(parts[1].c_str());
+        } else if (parts[0] == "uniform") {
+            std::vector<std::string> range = split(parts[1], '-');
+            if (range.size() != 2) {
+                return false;
+            }
+            kind = shapeUniform;
+            first = std::atof(range[0].c_str());
+            second = std::atof(range[1].c_str());
+        } else if (parts[0] == "lognormal") {
+            kind = shapeLognormal;
+            first = std::atof(parts[1].c_str());
+        } else {
+            return false;
+        }
+        return first >= 0 && second >= first;
+    }
+
+    /**
+     * Summary: Picks the length of the next line. Lognormal lengths are mostly near the mean with a
+     * long tail of long lines, like source code and logs.
+     *
+     * @param Random &random
+     * @return length
+     */
+    size_t next(Random &random) const {
+
+        switch (kind) {
+            case shapeUniform:
+                return (size_t) random.between((int64_t) first, (int64_t) second);
+            case shapeLognormal: {
+                // sigma 0.75, mu chosen so the mean comes out at the mean asked for
+                const double sigma = 0.75;
+                double mu = std::log(std::max(first, 1.0)) - sigma * sigma / 2;
+                return (size_t) std::min(std::exp(mu + sigma * random.normal()), 100000.0);
+            }
+            default:
+                return (size_t) first;
+        }
+    }
+};
+
+/**
+ * Summary: Makes one line of text.
+ *
+ * @param Random &random
+ * @param size_t length
+ * @param bool words words and spaces, otherwise any printable characters
+ * @return line
+ */
+static std::string makeText(Random &random, size_t length, bool words) {
+
+    static const char* wordList[] = {"int", "return", "value", "node", "list", "index", "for", "if",
+                                     "the", "line", "data", "next", "= 0;", "{", "}", "// note"};
+    std::string line;
+    line.reserve(length + 8);
+
+    if (words) {
+        while (line.size() < length) {
+            line += wordList[random.next() % 16];
+            line += ' ';
+        }
+        line.resize(length);
+    } else {
+        for (size_t i = 0; i < length; ++i) {
+            line += (char) (' ' + random.next() % 95);
+        }
+    }
+    return line;
+} // end makeText function
+
+/**
+ * Summary: Writes a synthetic file.
+ *
+ * @param const vector<string> &arguments
+ * @return error code
+ */
+static int generateFile(const std::vector<std::string> &arguments) {
+
+    long lines = std::atol(optionValue(arguments, "--lines", "0").c_str());
+    std::string content = optionValue(arguments, "--content", "words");
+    Random random(std::strtoull(optionValue(arguments, "--seed", "1").c_str(), nullptr, 10));
+
+    LineLengths lengths;
+    if (lines <= 0 || !lengths.parse(optionValue(arguments, "--lengths", "lognormal:40"))) {
+        std::cerr << "Usage: sparq_workload file --lines n [--lengths fixed:40|uniform:0-120|lognormal:40]"
+                  << " [--content words|random|repeat:k] [--seed s] [--out file]" << std::endl;
+        return 1;
+    }
+
+    // repeat:k draws every line from k distinct ones, like a file full of duplicates
+    std::vector<std::string> distinct;
+    if (content.compare(0, 7, "repeat:") == 0) {
+        long count = std::atol(content.c_str() + 7);
+        if (count <= 0) {
+            std::cerr << "Invalid content '" << content << "'." << std::endl;
+            return 1;
+        }
+        for (long i = 0; i < count; ++i) {
+            distinct.push_back(makeText(random, lengths.next(random), true));
+        }
+    } else if (content != "words" && content != "random") {
+        std::cerr << "Invalid content '" << content << "', use words, random or repeat:k." << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    std::ostream* output = openOutput(optionValue(arguments, "--out", ""), file);
+    if (output == nullptr) {
+        return 1;
+    }
+
+    for (long i = 0; i < lines; ++i) {
+        if (i > 0) {
+            *output << '\n';
+        }
+        if (!distinct.empty()) {
+            *output << distinct[random.next() % distinct.size()];
+        } else {
+            *output << makeText(random, lengths.next(random), content == "words");
+        }
+    }
+    output->flush();
+    return output->fail() ? 1 : 0;
+} // end generateFile function
+
+/**
+ * Summary: Writes a synthetic session for a file of the given length. Commands are picked by weight:
+ * L lists a window of lines, I inserts a line somewhere, D deletes one to a few lines, A appends a
+ * line, Lall lists the whole file. Line numbers stay within the file as it changes.
+ *
+ * @param const vector<string> &arguments
+ * @return error code
+ */
+static int generateTrace(const std::vector<std::string> &arguments) {
+
+    long lines = std::atol(optionValue(arguments, "--lines", "0").c_str());
+    long commands = std::atol(optionValue(arguments, "--commands", "0").c_str());
+    Random random(std::strtoull(optionValue(arguments, "--seed", "1").c_str(), nullptr, 10));
+
+    std::vector<Weight> mix = {{"L", 20}, {"I", 10}, {"D", 10}, {"A", 60}, {"Lall", 0}};
+    double total = 0;
+    bool valid = lines > 0 && commands > 0;
+
+    for (const std::string &entry : split(optionValue(arguments, "--mix", ""), ',')) {
+        std::vector<std::string> pair = split(entry, '=');
+        auto found = std::find_if(mix.begin(), mix.end(), [&pair](const Weight &weight) {
+            return pair.size() == 2 && weight.name == pair[0];
+        });
+        if (found == mix.end()) {
+            valid = false;
+            break;
+        }
+        found->weight = std::atof(pair[1].c_str());
+    }
+    for (const Weight &weight : mix) {
+        total += weight.weight;
+    }
+
+    if (!valid || total <= 0) {
+        std::cerr << "Usage: sparq_workload trace --lines n --commands n [--mix L=20,I=10,D=10,A=60,Lall=0]"
+                  << " [--seed s] [--out file]" << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    std::ostream* output = openOutput(optionValue(arguments, "--out", ""), file);
+    if (output == nullptr) {
+        return 1;
+    }
+
+    for (long i = 0; i < commands; ++i) {
+
+        // Pick a command by weight
+        double pick = random.unit() * total;
+        std::string name = mix.back().name;
+        for (const Weight &weight : mix) {
+            if (pick < weight.weight) {
+                name = weight.name;
+                break;
+            }
+            pick -= weight.weight;
+        }
+
+        // An empty file can only be appended to
+        if (lines == 0 && name != "Lall") {
+            name = "A";
+        }
+
+        if (name == "L") {
+            long first = random.between(1, lines);
+            *output << "L " << first << " " << std::min(lines, first + ListWindow - 1) << '\n';
+        } else if (name == "I") {
+            *output << "I " << random.between(1, lines) << '\n';
+            *output << makeText(random, (size_t) random.between(0, 80), true) << '\n';
+            lines++;
+        } else if (name == "D") {
+            long first = random.between(1, lines);
+            long last = std::min(lines, first + random.between(0, MostDeleted - 1));
+
+            // D n m needs n less than m
+            if (first == last) {
+                *output << "D " << first << '\n';
+            } else {
+                *output << "D " << first << " " << last << '\n';
+            }
+            lines -= last - first + 1;
+        } else if (name == "A") {
+            *output << makeText(random, (size_t) random.between(0, 80), true) << '\n';
+            lines++;
+        } else {
+            *output << "L" << '\n';
+        }
+    }
+
+    output->flush();
+    return output->fail() ? 1 : 0;
+} // end generateTrace function
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: Names a command for the report, the way the editor's stats do. Text is split by whether it
+ * was inserted or appended.
+ *
+ * @param command entered
+ * @param bool isInsert the editor was in insert mode, text is inserted rather than appended
+ * @return name
+ */
+static std::string commandName(command entered, bool isInsert) {
+    if (entered == cmdNone) {
+        return isInsert ? "inserted text" : "appended text";
+    }
+    return Editor::commandName(entered);
+} // end commandName function
+
+/**
+ * Summary: The latency below which the given fraction of the samples fall (nearest rank).
+ *
+ * @param const vector<double> &sorted
+ * @param double fraction
+ * @return latency
+ */
+static double percentile(const std::vector<double> &sorted, double fraction) {
+    size_t rank = (size_t) std::ceil(fraction * (double) sorted.size());
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+} // end percentile function
+
+/**
+ * Summary: Loads the file into an Editor and runs every line of the trace through it, timing each.
+ *
+ * @param const vector<string> &arguments
+ * @return error code
+ */
+static int replayTrace(const std::vector<std::string> &arguments) {
+
+    std::string filename = optionValue(arguments, "--file", "");
+    std::string traceName = optionValue(arguments, "--trace", "");
+    std::string jsonName = optionValue(arguments, "--json", "");
+
+    if (filename.empty() || traceName.empty()) {
+        std::cerr << "Usage: sparq_workload replay --file file --trace file [--json file]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream trace(traceName);
+    if (trace.fail()) {
+        std::cerr << "Unable to open '" << traceName << "'." << std::endl;
+        return 1;
+    }
+
+    // What the commands print is thrown away, a stream without a buffer writes nothing
+    std::ostream discard(nullptr);
+    std::istringstream noAnswers;
+    Editor editor;
+    editor.out = &discard;
+    editor.in = &noAnswers;
+
+    if (!editor.isFileExists(filename)) {
+        std::cerr << "Unable to open '" << filename << "'." << std::endl;
+        return 1;
+    }
+
+    auto loadStarted = std::chrono::steady_clock::now();
+    editor.myFileName = filename;
+    editor.populateListFromFile(filename, &editor.list);
+    editor.currentLineNumber = editor.list.getLineCount() + 1;
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStarted).count();
+
+    std::map<std::string, std::vector<double>> latencies; // microseconds, by command
+    std::string line;
+    auto replayStarted = std::chrono::steady_clock::now();
+
+    while (getline(trace, line)) {
+        command entered = editor.checkCommand(line);
+        if (entered == cmdE) {
+            continue; // never saved
+        }
+        std::string name = commandName(entered, editor.isInsert);
+
+        auto started = std::chrono::steady_clock::now();
+        if (!editor.textCommandEntered(line, editor.ptrCurrentLineNumber, &editor.list, editor.ptrIsInsert)) {
+            editor.addDataToList(line, editor.ptrCurrentLineNumber, &editor.list, editor.ptrIsInsert);
+        }
+        auto finished = std::chrono::steady_clock::now();
+
+        latencies[name].push_back(std::chrono::duration<double, std::micro>(finished - started).count());
+    }
+
+    double replaySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStarted).count();
+
+    // Report, a table on stdout and the same numbers as JSON if asked for
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\n  \"file\": \"" << filename << "\",\n  \"lines\": " << editor.list.getLineCount()
+         << ",\n  \"load_seconds\": " << loadSeconds << ",\n  \"replay_seconds\": " << replaySeconds
+         << ",\n  \"commands\": [";
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Loaded " << filename << " in " << loadSeconds << " s, replayed in " << replaySeconds << " s." << std::endl;
+    std::cout << std::left << std::setw(16) << "command" << std::right << std::setw(10) << "count"
+              << std::setw(12) << "mean us" << std::setw(12) << "p50 us" << std::setw(12) << "p90 us"
+              << std::setw(12) << "p99 us" << std::setw(12) << "p99.9 us" << std::setw(12) << "max us" << std::endl;
+
+    bool firstEntry = true;
+    for (auto &entry : latencies) {
+        std::vector<double> &samples = entry.second;
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        double mean = sum / (double) samples.size();
+
+        std::cout << std::left << std::setw(16) << entry.first << std::right << std::setw(10) << samples.size()
+                  << std::setw(12) << mean << std::setw(12) << percentile(samples, 0.5)
+                  << std::setw(12) << percentile(samples, 0.9) << std::setw(12) << percentile(samples, 0.99)
+                  << std::setw(12) << percentile(samples, 0.999) << std::setw(12) << samples.back() << std::endl;
+
+        json << (firstEntry ? "" : ",") << "\n    {\"command\": \"" << entry.first << "\", \"count\": " << samples.size()
+             << ", \"mean_us\": " << mean << ", \"p50_us\": " << percentile(samples, 0.5)
+             << ", \"p90_us\": " << percentile(samples, 0.9) << ", \"p99_us\": " << percentile(samples, 0.99)
+             << ", \"p999_us\": " << percentile(samples, 0.999) << ", \"max_us\": " << samples.back() << "}";
+        firstEntry = false;
+    }
+    json << "\n  ]\n}\n";
+
+    if (!jsonName.empty()) {
+        std::ofstream file(jsonName, std::ios::trunc);
+        file << json.str();
+        file.close();
+        if (file.fail()) {
+            std::cerr << "Unable to write '" << jsonName << "'." << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+} // end replayTrace function
+
+// --------------------------------------------------------------------------------
+
+int main(int argc, char **argv) {
+
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+    std::string mode = arguments.empty() ? "" : arguments[0];
+
+    if (mode == "file") {
+        return generateFile(arguments);
+    }
+    if (mode == "trace") {
+        return generateTrace(arguments);
+    }
+    if (mode == "replay") {
+        return replayTrace(arguments);
+    }
+
+    std::cerr << "Usage: sparq_workload file --lines n [--lengths ...] [--content ...] [--seed s] [--out file]" << std::endl;
+    std::cerr << "       sparq_workload trace --lines n --commands n [--mix ...] [--seed s] [--out file]" << std::endl;
+    std::cerr << "       sparq_workload replay --file file --trace file [--json file]" << std::endl;
+    return 1;
+} // end main routine
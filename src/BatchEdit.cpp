@@ -0,0 +1,224 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * BatchEdit .cpp implementation file
+ */
+
+#include "BatchEdit.h"
+#include "Editor.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+
+#ifndef _WIN32
+#include <glob.h>
+#endif
+
+// Constructor
+BatchEdit::BatchEdit() {}
+
+/**
+ * Summary: Reads the script. Lines after E are never reached. A script without E saves a file only if
+ * it changed the file, see editFile().
+ *
+ * @param istream &input
+ */
+void BatchEdit::load(std::istream &input) {
+
+    std::string line;
+    script.clear();
+
+    while (getline(input, line)) {
+        // Scripts written on Windows
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        script.push_back(line);
+        if (line == "E") {
+            return;
+        }
+    }
+} // end load method
+
+/**
+ * Summary: Expands arguments that are glob patterns (for shells that didn't, or patterns quoted to
+ * get past the argument limit). Anything that matches no file is kept as it is, so it's reported
+ * as not found.
+ *
+ * @param const vector<string> &arguments
+ * @return filenames
+ */
+std::vector<std::string> BatchEdit::expandFiles(const std::vector<std::string> &arguments) {
+
+    std::vector<std::string> files;
+
+    for (const std::string &argument : arguments) {
+#ifndef _WIN32
+        glob_t matches;
+        if (argument.find_first_of("*?[") != std::string::npos &&
+            glob(argument.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; ++i) {
+                files.push_back(matches.gl_pathv[i]);
+            }
+            globfree(&matches);
+            continue;
+        }
+#endif
+        files.push_back(argument);
+    }
+
+    return files;
+} // end expandFiles method
+
+/**
+ * Summary: Runs the script on one file in an Editor of its own, as if it were typed at the prompt,
+ * then writes what the editor printed. A file that didn't load in full is left alone, the script
+ * isn't run on it. Without an E in the script the file is saved only if the script changed it.
+ *
+ * @param const string &filename
+ * @param ostream &output
+ * @return how it went
+ */
+BatchEdit::Result BatchEdit::editFile(const std::string &filename, std::ostream &output) {
+
+    auto started = std::chrono::steady_clock::now();
+    Result result;
+    result.lines = 0;
+
+    Editor editor;
+    std::ostringstream text;
+    std::istringstream noAnswers; // the filename is always known, E never asks for one
+    editor.out = &text;
+    editor.in = &noAnswers;
+
+    // Paths are fine here, only names typed into the editor are checked
+    if (!editor.isFileExists(filename)) {
+        result.status = statusNotFound;
+    } else {
+        try {
+            editor.myFileName = filename;
+            editor.populateListFromFile(filename, &editor.list);
+            editor.currentLineNumber = editor.list.getLineCount() + 1;
+
+            // Saving part of the file would lose the rest, and E would ask for a filename nobody can answer
+            if (editor.loadIncomplete) {
+                text << "The script was not run." << std::endl;
+                result.status = statusFailed;
+            } else {
+                uint64_t loadedVersion = editor.list.getVersion();
+                bool exited = false;
+
+                for (const std::string &line : script) {
+                    if (editor.exitCommandEntered(line, editor.myFileName, &editor.list)) {
+                        exited = true;
+                        break;
+                    }
+                    if (!editor.textCommandEntered(line, editor.ptrCurrentLineNumber, &editor.list, editor.ptrIsInsert)) {
+                        editor.addDataToList(line, editor.ptrCurrentLineNumber, &editor.list, editor.ptrIsInsert);
+                    }
+                }
+
+                // No E, only a script that changed the file saves it
+                bool changed = editor.list.getVersion() != loadedVersion;
+                if (!exited && changed) {
+                    editor.exitCommandEntered("E", editor.myFileName, &editor.list);
+                }
+
+                if (editor.saved) {
+                    result.status = statusSaved;
+                } else {
+                    result.status = !exited && !changed ? statusUnchanged : statusNotSaved;
+                }
+            }
+            result.lines = editor.list.getLineCount();
+        }
+        catch (std::exception &e) {
+            text << "The script failed." << std::endl;
+            result.status = statusFailed;
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    if (!text.str().empty()) {
+        std::lock_guard<std::mutex> guard(outputLock);
+        output << "==> " << filename << " <==" << std::endl << text.str() << std::flush;
+    }
+    return result;
+} // end editFile method
+
+/**
+ * Summary: Runs the script on every file, jobs at a time, then writes a line for each file and
+ * the totals.
+ *
+ * @param const vector<string> &files
+ * @param size_t jobs most files loaded at once
+ * @param ostream &output
+ * @return true if every file was saved, or left unchanged by a script without E
+ */
+bool BatchEdit::run(const std::vector<std::string> &files, size_t jobs, std::ostream &output) {
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<Result> results(files.size());
+    std::atomic<size_t> nextFile(0);
+
+    // Each job takes the next file until there are none left
+    {
+        TaskGroup group;
+        for (size_t job = 0; job < jobs && job < files.size(); ++job) {
+            group.run([&]() {
+                size_t file;
+                while ((file = nextFile.fetch_add(1)) < files.size()) {
+                    results[file] = editFile(files[file], output);
+                }
+            });
+        }
+        group.wait();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    // Summary, in the order the files were given
+    size_t saved = 0;
+    size_t unchanged = 0;
+    output << std::endl;
+    for (size_t i = 0; i < files.size(); ++i) {
+        output << files[i] << ": ";
+        switch (results[i].status) {
+            case statusSaved:
+                saved++;
+                output << "saved, " << results[i].lines << (results[i].lines == 1 ? " line" : " lines");
+                break;
+            case statusNotFound:
+                output << "not found";
+                break;
+            case statusUnchanged:
+                unchanged++;
+                output << "unchanged, " << results[i].lines << (results[i].lines == 1 ? " line" : " lines");
+                break;
+            case statusNotSaved:
+                output << "not saved";
+                break;
+            case statusFailed:
+                output << "failed";
+                break;
+        }
+        output << " (" << std::fixed << std::setprecision(3) << results[i].seconds << " s)" << std::endl;
+    }
+
+    output << saved << " of " << files.size() << (files.size() == 1 ? " file" : " files") << " saved";
+    if (unchanged > 0) {
+        output << ", " << unchanged << " unchanged";
+    }
+    output << " in " << std::fixed << std::setprecision(3) << seconds << " s." << std::endl;
+
+    return saved + unchanged == files.size();
+} // end run method
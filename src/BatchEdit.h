@@ -0,0 +1,60 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * BatchEdit .h header file
+ *
+ * Batch mode (SparQ --apply script [--jobs n] files...). Runs the same script, the lines that would
+ * have been typed into the editor, on every file, as if the editor had been opened on each one. E in
+ * the script saves the file, a script without E saves only the files it changed. Files are edited in parallel on the thread pool, each in its own Editor, with at most
+ * jobs files loaded at a time. What the editor prints for a file is collected and written in one
+ * piece once the file is done, followed by a line per file saying how it went.
+ */
+
+#ifndef SPARQ_BATCHEDIT_H
+#define SPARQ_BATCHEDIT_H
+
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class BatchEdit {
+
+private:
+    // How a file went
+    enum fileStatus {
+        statusSaved,
+        statusUnchanged, // no E in the script and nothing changed, so not saved
+        statusNotFound,
+        statusNotSaved,
+        statusFailed
+    };
+
+    struct Result {
+        fileStatus status;
+        int lines; // in the file as saved
+        double seconds;
+    };
+
+    std::vector<std::string> script; // up to E, if it has one
+    std::mutex outputLock; // each file's output is written in one piece
+
+    Result editFile(const std::string &filename, std::ostream &output);
+
+public:
+    BatchEdit();
+
+    void load(std::istream &input);
+    bool run(const std::vector<std::string> &files, size_t jobs, std::ostream &output);
+
+    static std::vector<std::string> expandFiles(const std::vector<std::string> &arguments);
+};
+
+#endif //SPARQ_BATCHEDIT_H
@@ -0,0 +1,400 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * BlockStore .cpp implementation file
+ */
+
+#include "BlockStore.h"
+#include "LinkedList.h"
+
+#include <cstring>
+#include <iterator>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+/**
+ * Summary: Writes bytes at an offset in the swap file.
+ *
+ * @param FILE *file
+ * @param const string &data
+ * @param uint64_t offset
+ */
+static void writeSwap(std::FILE *file, const std::string &data, uint64_t offset) {
+#ifdef _WIN32
+    if (_fseeki64(file, (long long) offset, SEEK_SET) != 0 ||
+        std::fwrite(data.data(), 1, data.size(), file) != data.size()) {
+        throw SwapFileException();
+    }
+#else
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t result = pwrite(fileno(file), data.data() + written, data.size() - written,
+                                (off_t) (offset + written));
+        if (result <= 0) { throw SwapFileException(); }
+        written += (size_t) result;
+    }
+#endif
+} // end writeSwap function
+
+/**
+ * Summary: Reads bytes from an offset in the swap file.
+ *
+ * @param FILE *file
+ * @param string &data sized to the number of bytes to read
+ * @param uint64_t offset
+ */
+static void readSwap(std::FILE *file, std::string &data, uint64_t offset) {
+#ifdef _WIN32
+    if (_fseeki64(file, (long long) offset, SEEK_SET) != 0 ||
+        std::fread(&data[0], 1, data.size(), file) != data.size()) {
+        throw SwapFileException();
+    }
+#else
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t result = pread(fileno(file), &data[done], data.size() - done, (off_t) (offset + done));
+        if (result <= 0) { throw SwapFileException(); }
+        done += (size_t) result;
+    }
+#endif
+} // end readSwap function
+
+/**
+ * Constructor
+ *
+ * @param codec blockCodec
+ * @param size_t hotBlocks how many blocks stay decompressed, at least two
+ * @param size_t linesPerBlock
+ */
+BlockStore::BlockStore(codec blockCodec, size_t hotBlocks, size_t linesPerBlock)
+        : blockCodec(blockCodec), hotLimit(hotBlocks < 2 ? 2 : hotBlocks), linesPerBlock(linesPerBlock),
+          open(nullptr), blockCount(0), rawBytes(0), compressedBytes(0), memoryLimit(0), nodeCount(0),
+          residentBytes(0), memoryCompressedBytes(0), swapFile(nullptr), swapBroken(false), swapSize(0), pageIns(0) {}
+
+/**
+ * Destructor
+ *
+ * Blocks free themselves when their last member node goes away,
+ * and every list using the store holds on to it until its nodes are deleted.
+ * The swap file is deleted by the system when it is closed.
+ */
+BlockStore::~BlockStore() {
+    if (swapFile != nullptr) {
+        std::fclose(swapFile);
+    }
+}
+
+/**
+ * Summary: Limits the memory the lines use. The nodes come off the top, of what's left half is for
+ * decompressed blocks, a quarter for compressed blocks and the rest for everything else. Blocks past
+ * that go to the swap file.
+ *
+ * @param size_t bytes 0 for no limit
+ */
+void BlockStore::setMemoryLimit(size_t bytes) {
+    memoryLimit = bytes;
+    enforceLimits();
+} // end setMemoryLimit method
+
+/**
+ * Summary: The memory taken by the nodes of the store's lines, each node and its slot in a block.
+ * Text that doesn't fit in a node's string counts with the blocks.
+ *
+ * @return bytes
+ */
+size_t BlockStore::nodeUsage() const {
+    return nodeCount * (sizeof(Node) + sizeof(Node*));
+} // end nodeUsage method
+
+/**
+ * Summary: Adds a new node to the open block, compressing the block once it is full.
+ *
+ * @param Node *node
+ */
+void BlockStore::append(Node* node) {
+
+    // Start a new block when there isn't one being filled
+    if (open == nullptr) {
+        open = new Block();
+        open->store = this;
+        open->liveMembers = 0;
+        open->compressedSize = 0;
+        open->rawSize = 0;
+        open->resident = true;
+        open->inMemory = false;
+        open->swapOffset = -1;
+        open->lruPosition = hot.end();
+        open->coldPosition = cold.end();
+        open->members.reserve(linesPerBlock);
+        blockCount++;
+    }
+
+    node->block = open;
+    node->blockSlot = (int) open->members.size();
+    open->members.push_back(node);
+    open->liveMembers++;
+    nodeCount++;
+
+    if (open->members.size() >= linesPerBlock) {
+        flush();
+    }
+} // end append method
+
+/**
+ * Summary: Compresses the open block. It stays resident as the most recently used block.
+ */
+void BlockStore::flush() {
+
+    if (open != nullptr) {
+        Block* block = open;
+        open = nullptr;
+        seal(block);
+    }
+} // end flush method
+
+/**
+ * Summary: Compresses the members of a block into one buffer, each line prefixed with its length.
+ * Deleted members keep an empty slot so the slots still line up with the members.
+ *
+ * @param Block *block
+ */
+void BlockStore::seal(Block* block) {
+
+    std::string raw;
+
+    for (Node* member : block->members) {
+        uint32_t length = member == nullptr ? 0 : (uint32_t) member->data.size();
+        raw.append((const char *) &length, sizeof(length));
+        if (member != nullptr) {
+            raw += member->data;
+        }
+    }
+
+    compressBlock(blockCodec, raw.data(), raw.size(), block->compressed);
+    block->compressedSize = block->compressed.size();
+    block->inMemory = true;
+    block->rawSize = raw.size();
+    rawBytes += raw.size();
+    compressedBytes += block->compressedSize;
+    memoryCompressedBytes += block->compressedSize;
+    residentBytes += block->rawSize;
+
+    // Just written, so it counts as recently used
+    hot.push_front(block);
+    block->lruPosition = hot.begin();
+
+    enforceLimits();
+} // end seal method
+
+/**
+ * Summary: Makes sure a block's lines are in its nodes, decompressing it if needed,
+ * and marks it as the most recently used block.
+ *
+ * @param Block *block
+ */
+void BlockStore::touch(Block* block) {
+
+    // The open block is never compressed
+    if (block == open) {
+        return;
+    }
+
+    if (block->resident) {
+        if (hot.front() != block) {
+            hot.splice(hot.begin(), hot, block->lruPosition);
+        }
+        return;
+    }
+
+    std::string swapped;
+    const std::string* compressed = &block->compressed;
+
+    if (!block->inMemory) {
+        // Page the compressed lines in from the swap file, the copy there stays valid
+        swapped.resize(block->compressedSize);
+        readSwap(swapFile, swapped, (uint64_t) block->swapOffset);
+        compressed = &swapped;
+        pageIns++;
+    }
+
+    // Decompress and check every length before any member is changed, so a block that can't be
+    // read is left as it was
+    std::string raw;
+    decompressBlock(blockCodec, *compressed, raw);
+
+    size_t position = 0;
+    for (size_t slot = 0; slot < block->members.size(); ++slot) {
+        uint32_t length;
+        if (position + sizeof(length) > raw.size()) { throw CorruptBlockException(); }
+        std::memcpy(&length, raw.data() + position, sizeof(length));
+        position += sizeof(length);
+        if (length > raw.size() - position) { throw CorruptBlockException(); }
+        position += length;
+    }
+
+    // Hand each member its line back
+    position = 0;
+    for (Node* member : block->members) {
+        uint32_t length;
+        std::memcpy(&length, raw.data() + position, sizeof(length));
+        position += sizeof(length);
+
+        if (member != nullptr) {
+            member->data.assign(raw.data() + position, length);
+        }
+        position += length;
+    }
+
+    // It's in use again, so it can't be spilled
+    if (block->inMemory) {
+        cold.erase(block->coldPosition);
+        block->coldPosition = cold.end();
+    }
+
+    block->resident = true;
+    residentBytes += block->rawSize;
+    hot.push_front(block);
+    block->lruPosition = hot.begin();
+
+    // Make room, the block just loaded is at the front so it is never the one evicted
+    enforceLimits();
+} // end touch method
+
+/**
+ * Summary: Evicts and spills blocks until the store is back within its limits.
+ * The two most recently used blocks always stay, so two lines can be compared. Never throws.
+ */
+void BlockStore::enforceLimits() {
+
+    if (memoryLimit == 0) {
+        while (hot.size() > hotLimit) {
+            evict(hot.back());
+        }
+        return;
+    }
+
+    // What the nodes leave for the text
+    size_t nodes = nodeUsage();
+    size_t textLimit = memoryLimit > nodes ? memoryLimit - nodes : 0;
+
+    while (residentBytes > textLimit / 2 && hot.size() > 2) {
+        evict(hot.back());
+    }
+
+    // Lines are being added or read when this runs, so a swap file that fails isn't an error for
+    // them. The blocks stay in memory over the limit instead.
+    while (!swapBroken && memoryCompressedBytes > textLimit / 4 && !cold.empty()) {
+        try {
+            spill(cold.front());
+        }
+        catch (SwapFileException &e) {
+            swapBroken = true;
+        }
+    }
+} // end enforceLimits method
+
+/**
+ * Summary: Drops the decompressed lines of a block, the compressed copy stays.
+ *
+ * @param Block *block
+ */
+void BlockStore::evict(Block* block) {
+
+    for (Node* member : block->members) {
+        if (member != nullptr) {
+            std::string().swap(member->data); // free the memory, not just the contents
+        }
+    }
+
+    block->resident = false;
+    residentBytes -= block->rawSize;
+    hot.erase(block->lruPosition);
+    block->lruPosition = hot.end();
+
+    // A compressed copy in memory can now be spilled
+    if (block->inMemory) {
+        cold.push_back(block);
+        block->coldPosition = std::prev(cold.end());
+    }
+} // end evict method
+
+/**
+ * Summary: Moves a block's compressed lines out of memory into the swap file.
+ * Blocks never change once sealed, so a block already in the swap file isn't written again.
+ *
+ * @param Block *block
+ */
+void BlockStore::spill(Block* block) {
+
+    if (block->swapOffset < 0) {
+        if (swapFile == nullptr) {
+            // Deleted automatically when it is closed
+            swapFile = std::tmpfile();
+            if (swapFile == nullptr) { throw SwapFileException(); }
+        }
+
+        writeSwap(swapFile, block->compressed, swapSize);
+        block->swapOffset = (int64_t) swapSize;
+        swapSize += block->compressedSize;
+    }
+
+    std::string().swap(block->compressed);
+    block->inMemory = false;
+    memoryCompressedBytes -= block->compressedSize;
+    cold.erase(block->coldPosition);
+    block->coldPosition = cold.end();
+} // end spill method
+
+/**
+ * Summary: Takes a node out of its block. Used when the node is deleted or its line is replaced.
+ * The node's data is left as it is.
+ *
+ * @param Node *node
+ */
+void BlockStore::detach(Node* node) {
+
+    Block* block = node->block;
+    block->members[node->blockSlot] = nullptr;
+    node->block = nullptr;
+    node->blockSlot = -1;
+    nodeCount--;
+
+    if (--block->liveMembers == 0) {
+        release(block);
+    }
+} // end detach method
+
+/**
+ * Summary: Frees a block that no node belongs to anymore. Its space in the swap file is not reused.
+ *
+ * @param Block *block
+ */
+void BlockStore::release(Block* block) {
+
+    if (block == open) {
+        open = nullptr;
+    } else {
+        if (block->resident) {
+            hot.erase(block->lruPosition);
+            residentBytes -= block->rawSize;
+        } else if (block->inMemory) {
+            cold.erase(block->coldPosition);
+        }
+        if (block->inMemory) {
+            memoryCompressedBytes -= block->compressedSize;
+        }
+        compressedBytes -= block->compressedSize;
+        rawBytes -= block->rawSize;
+    }
+
+    blockCount--;
+    delete block;
+} // end release method
@@ -0,0 +1,108 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * BlockStore .h header file
+ *
+ * Keeps the text of loaded lines compressed in blocks. Only the most recently used blocks are
+ * decompressed back into their nodes, the rest of the text stays compressed until a node asks for it.
+ *
+ * With a memory limit, compressed blocks that haven't been used in a while are written out to a
+ * temporary swap file and read back in when one of their lines is needed. The nodes themselves can't
+ * leave memory, so they count against the limit first and the text gets what's left.
+ */
+
+#ifndef SPARQ_BLOCKSTORE_H
+#define SPARQ_BLOCKSTORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "Compress.h"
+
+class Node;
+
+class BlockStore {
+
+public:
+    // A group of lines compressed together. The member nodes can be anywhere in the list.
+    struct Block {
+        BlockStore* store;
+        std::vector<Node*> members; // nullptr where a member was deleted or edited
+        size_t liveMembers;
+        std::string compressed; // empty while the block is only in the swap file
+        size_t compressedSize;
+        size_t rawSize; // length prefixed lines before compression
+        bool resident; // the members' data currently holds their text
+        bool inMemory; // compressed holds the compressed lines
+        int64_t swapOffset; // where the compressed lines are in the swap file, -1 if they were never written
+        std::list<Block*>::iterator lruPosition;
+        std::list<Block*>::iterator coldPosition;
+    };
+
+private:
+    codec blockCodec;
+    size_t hotLimit; // most blocks kept decompressed at once
+    size_t linesPerBlock;
+    Block* open; // block still being filled, not compressed yet
+    std::list<Block*> hot; // resident sealed blocks, most recently used first
+    std::list<Block*> cold; // compressed blocks in memory that could be spilled, least recently used first
+    size_t blockCount;
+    size_t rawBytes;
+    size_t compressedBytes;
+
+    size_t memoryLimit; // bytes the lines may use in memory, nodes included, 0 for no limit
+    size_t nodeCount; // nodes belonging to a block
+    size_t residentBytes; // decompressed text of the hot blocks
+    size_t memoryCompressedBytes; // compressed text held in memory
+    std::FILE* swapFile;
+    bool swapBroken; // the swap file couldn't be created or written, blocks stay in memory
+    uint64_t swapSize;
+    size_t pageIns;
+
+    void seal(Block* block);
+    void evict(Block* block);
+    void spill(Block* block);
+    void release(Block* block);
+    void enforceLimits();
+
+public:
+    BlockStore(codec blockCodec, size_t hotBlocks, size_t linesPerBlock = 256);
+    virtual ~BlockStore();
+
+    void append(Node* node); // add a freshly created node to the open block
+    void touch(Block* block); // make sure the block is resident and mark it most recently used
+    void detach(Node* node); // node is being deleted or rewritten, it no longer belongs to its block
+    void flush(); // compress the open block now
+    void setMemoryLimit(size_t bytes);
+
+    size_t blocks() const { return blockCount; }
+    size_t uncompressedSize() const { return rawBytes; }
+    size_t compressedSize() const { return compressedBytes; }
+    size_t nodeUsage() const; // memory the nodes take whatever happens to their text
+    size_t memoryUsage() const { return nodeUsage() + residentBytes + memoryCompressedBytes; }
+    size_t memoryBudget() const { return memoryLimit; }
+    bool overBudget() const { return memoryLimit > 0 && nodeUsage() >= memoryLimit; }
+    uint64_t swapUsage() const { return swapSize; }
+    bool swapFailed() const { return swapBroken; }
+    size_t swapReads() const { return pageIns; }
+};
+
+// Custom Exceptions
+struct SwapFileException : public std::exception {
+public:
+    const std::string what() {
+        return "Unable to use the swap file.";
+    }
+};//end SwapFileException struct
+
+#endif //SPARQ_BLOCKSTORE_H
@@ -0,0 +1,376 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * BufferList .cpp implementation file
+ */
+
+#include "BufferList.h"
+
+#include <algorithm>
+#include <cstdio>
+
+/**
+ * Constructor
+ *
+ * @param function<void(Editor &)> setUp called for each new buffer before anything is loaded into it
+ */
+BufferList::BufferList(std::function<void(Editor &)> setUp) : currentBuffer(0), setUp(std::move(setUp)), memoryLimit(0) {}
+
+/**
+ * Summary: Adds an empty buffer with no file and makes it the current one.
+ *
+ * @return the new buffer
+ */
+Editor &BufferList::add() {
+
+    std::unique_ptr<Editor> editor(new Editor());
+    editor->currentLineNumber = 1;
+    if (setUp) {
+        setUp(*editor);
+    }
+    editor->onBackgroundUpdate = onBackgroundUpdate;
+
+    buffers.push_back(std::move(editor));
+    currentBuffer = buffers.size() - 1;
+    shareMemory();
+    return current();
+} // end add method
+
+/**
+ * Summary: Adds a buffer for a file and makes it the current one. A big file finishes loading in
+ * the background. An invalid name leaves the buffer empty, E asks for a name.
+ *
+ * @param const string &filename
+ * @param bool follow append lines written to the file from now on, like tail -f
+ * @return the new buffer
+ */
+Editor &BufferList::open(const std::string &filename, bool follow) {
+
+    Editor &editor = add();
+    editor.myFileName = filename;
+
+    // Check if the filename is a valid file name.
+    if (!editor.isValidFileName(editor.myFileName)) {
+        return editor;
+    }
+
+    // If file is valid but no '.' exists, assume .txt as the file extension
+    if (editor.myFileName.find('.') == std::string::npos) {
+        editor.myFileName += DefaultFileExt;
+    }
+
+    // Add each line of the file to the list, big files finish loading in the background
+    editor.loadInBackground = true;
+    editor.populateListFromFile(editor.myFileName, &editor.list);
+
+    // Get the current line from the number of lines
+    // (locked, the rest of a big file may already be loading in the background)
+    {
+        std::lock_guard<std::mutex> guard(editor.listLock);
+        editor.currentLineNumber = editor.list.getLineCount() + 1;
+        editor.autosavedVersion = editor.list.getVersion(); // set again once a background load finishes
+    }
+
+    // Lines written to the file from now on are appended as they arrive
+    if (follow && editor.followFile(editor.myFileName)) {
+        *editor.out << "Following " << editor.myFileName << ", new lines are added to the end." << std::endl;
+    }
+
+    return editor;
+} // end open method
+
+/**
+ * Summary: Closes the current buffer once E has saved it. The buffer before it becomes the current one.
+ *
+ * @param bool removeAutosave remove the autosave copy if the file was saved
+ * @return false if it was the last buffer
+ */
+bool BufferList::closeCurrent(bool removeAutosave) {
+
+    Editor &editor = current();
+    editor.stopBackground(); // an autosave still being written would bring the file back
+    if (removeAutosave && editor.saved) {
+        std::remove((editor.myFileName + AutosaveExt).c_str());
+    }
+
+    buffers.erase(buffers.begin() + (std::ptrdiff_t) currentBuffer);
+    if (buffers.empty()) {
+        return false;
+    }
+    shareMemory();
+
+    if (currentBuffer > 0) {
+        currentBuffer--;
+    }
+    *current().out << "Editing " << describe(current()) << "." << std::endl;
+    return true;
+} // end closeCurrent method
+
+/**
+ * Summary: Checks the input for a buffer command and runs it.
+ * [B, B n, OPEN file, COPY n m b, MOVE n m b] as commands.
+ *
+ * @param const string &input
+ * @return true if input has been recognized as a command.
+ */
+bool BufferList::commandEntered(const std::string &input) {
+
+    // Every other line is text or an editor command, skip the regexes for those
+    if (input.empty() || (input[0] != 'B' && input[0] != 'O' && input[0] != 'C' && input[0] != 'M')) {
+        return false;
+    }
+
+    static const std::regex buffersExpr("B");
+    static const std::regex bufferNumExpr("B[\\s][0-9]+"); // B -> space -> buffer number
+    static const std::regex openExpr("OPEN[\\s].+"); // OPEN -> space -> filename
+    static const std::regex copyExpr("COPY[\\s][0-9]+[\\s][0-9]+[\\s][0-9]+"); // COPY n m -> space -> buffer number
+    static const std::regex moveExpr("MOVE[\\s][0-9]+[\\s][0-9]+[\\s][0-9]+"); // MOVE n m -> space -> buffer number
+
+    std::istringstream ss(input);
+    std::string cmd;
+    int n = 0;
+    int m = 0;
+    size_t buffer = 0;
+
+    if (regex_match(input, buffersExpr)) {
+        cmdBuffers();
+    } else if (regex_match(input, bufferNumExpr)) {
+        ss >> cmd;
+        ss >> buffer;
+        cmdSwitch(buffer);
+    } else if (regex_match(input, openExpr)) {
+        // Everything after the command and the space is the filename
+        cmdOpen(input.substr(5));
+    } else if (regex_match(input, copyExpr) || regex_match(input, moveExpr)) {
+        ss >> cmd;
+        ss >> n;
+        ss >> m;
+        ss >> buffer;
+
+        // Lines that can't be read back from a block store leave both buffers as they were
+        try {
+            cmdTransfer(n, m, buffer, cmd == "MOVE");
+            shareMemory();
+        }
+        catch (SwapFileException &e) {
+            *current().out << e.what() << " The lines were not " << (cmd == "MOVE" ? "moved." : "copied.") << std::endl;
+        }
+        catch (CorruptBlockException &e) {
+            *current().out << e.what() << " The lines were not " << (cmd == "MOVE" ? "moved." : "copied.") << std::endl;
+        }
+    } else {
+        return false;
+    }
+    return true;
+} // end commandEntered method
+
+/**
+ * Summary: Sets what every buffer calls when there is news for the prompt, see Editor::onBackgroundUpdate.
+ *
+ * @param function<void()> update
+ */
+void BufferList::setBackgroundUpdate(std::function<void()> update) {
+
+    onBackgroundUpdate = std::move(update);
+    for (auto &editor : buffers) {
+        std::lock_guard<std::mutex> guard(editor->listLock);
+        editor->onBackgroundUpdate = onBackgroundUpdate;
+    }
+} // end setBackgroundUpdate method
+
+/**
+ * Summary: Sets the memory budget every buffer's lines share (--max-mem).
+ *
+ * @param size_t bytes 0 for no limit
+ */
+void BufferList::setMemoryLimit(size_t bytes) {
+    memoryLimit = bytes;
+    shareMemory();
+} // end setMemoryLimit method
+
+/**
+ * Summary: Splits the memory budget between the buffers' block stores, so all of them together stay
+ * within it. Nodes can't leave memory, so each store gets what its nodes take plus an even share of
+ * what the nodes leave for text. Done whenever a buffer is added or closed and lines move between them,
+ * the nodes a buffer loads after that come out of its own share.
+ */
+void BufferList::shareMemory() {
+
+    if (memoryLimit == 0) {
+        return;
+    }
+
+    std::vector<size_t> nodes(buffers.size(), 0);
+    size_t allNodes = 0;
+    size_t stores = 0;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        std::lock_guard<std::mutex> guard(buffers[i]->listLock);
+        BlockStore* store = buffers[i]->list.getStore();
+        if (store != nullptr) {
+            nodes[i] = store->nodeUsage();
+            allNodes += nodes[i];
+            stores++;
+        }
+    }
+    if (stores == 0) {
+        return;
+    }
+
+    size_t text = memoryLimit > allNodes ? (memoryLimit - allNodes) / stores : 0;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        std::lock_guard<std::mutex> guard(buffers[i]->listLock);
+        BlockStore* store = buffers[i]->list.getStore();
+        if (store != nullptr) {
+            store->setMemoryLimit(std::max<size_t>(nodes[i] + text, 1)); // 0 would be no limit
+        }
+    }
+} // end shareMemory method
+
+/**
+ * Summary: Stops every buffer's background threads, see Editor::stopBackground.
+ */
+void BufferList::stopBackground() {
+    for (auto &editor : buffers) {
+        editor->stopBackground();
+    }
+} // end stopBackground method
+
+/**
+ * Summary: Names a buffer for messages.
+ *
+ * @param const Editor &editor
+ * @return its filename
+ */
+std::string BufferList::describe(const Editor &editor) const {
+    return editor.myFileName.empty() ? "a new file" : editor.myFileName;
+} // end describe method
+
+/**
+ * Summary: This function implements the B command, lists the buffers.
+ * The current buffer is marked with a *.
+ */
+void BufferList::cmdBuffers() {
+
+    std::ostream &out = *current().out;
+
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        Editor &editor = *buffers[i];
+
+        // A buffer still loading in the background shows the lines loaded so far
+        int lines;
+        {
+            std::lock_guard<std::mutex> guard(editor.listLock);
+            lines = editor.list.getLineCount();
+        }
+
+        out << (i == currentBuffer ? "* " : "  ") << i + 1 << ": " << describe(editor) << " (" << lines
+            << (lines == 1 ? " line" : " lines") << ")" << std::endl;
+    }
+} // end cmdBuffers method
+
+/**
+ * Summary: This function implements the B n command, switches to buffer n.
+ *
+ * @param size_t buffer
+ */
+void BufferList::cmdSwitch(size_t buffer) {
+
+    if (buffer < 1 || buffer > buffers.size()) {
+        *current().out << "There is no buffer " << buffer << "." << std::endl;
+        return;
+    }
+
+    currentBuffer = buffer - 1;
+    *current().out << "Editing " << describe(current()) << "." << std::endl;
+} // end cmdSwitch method
+
+/**
+ * Summary: This function implements the OPEN file command, opens a file in a new buffer. A file
+ * that's open already is switched to instead.
+ *
+ * @param const string &filename
+ */
+void BufferList::cmdOpen(const std::string &filename) {
+
+    std::string withExtension = filename.find('.') == std::string::npos ? filename + DefaultFileExt : filename;
+
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        if (buffers[i]->myFileName == withExtension) {
+            *current().out << withExtension << " is open in buffer " << i + 1 << "." << std::endl;
+            cmdSwitch(i + 1);
+            return;
+        }
+    }
+
+    // Don't leave a buffer behind for a name that can't be used
+    if (!current().isValidFileName(filename)) {
+        return;
+    }
+
+    open(filename, false);
+    *current().out << "Editing " << describe(current()) << " in buffer " << buffers.size() << "." << std::endl;
+} // end cmdOpen method
+
+/**
+ * Summary: This function implements the COPY n m b and MOVE n m b commands. Lines n to m of the
+ * current buffer go in at buffer b's current line, as if they were typed there.
+ *
+ * @param int n
+ * @param int m
+ * @param size_t buffer
+ * @param bool move remove them from the current buffer
+ */
+void BufferList::cmdTransfer(int n, int m, size_t buffer, bool move) {
+
+    Editor &source = current();
+    std::ostream &out = *source.out;
+
+    if (buffer < 1 || buffer > buffers.size()) {
+        out << "There is no buffer " << buffer << "." << std::endl;
+        return;
+    }
+
+    Editor &target = *buffers[buffer - 1];
+    if (&target == &source) {
+        out << "The lines are already in this buffer." << std::endl;
+        return;
+    }
+
+    // Both files have to be loaded, then both lists are locked together
+    for (Editor* editor : {&source, &target}) {
+        std::unique_lock<std::mutex> guard(editor->listLock);
+        editor->waitForLines(guard, INT_MAX);
+    }
+    std::lock(source.listLock, target.listLock);
+    std::lock_guard<std::mutex> sourceGuard(source.listLock, std::adopt_lock);
+    std::lock_guard<std::mutex> targetGuard(target.listLock, std::adopt_lock);
+
+    int lineCount = source.list.getLineCount();
+
+    // If n is less than 1, set to 1, and m past the end is the last line
+    if (n < 1) { n = 1; }
+    if (m > lineCount) { m = lineCount; }
+    if (n > m) {
+        return;
+    }
+
+    int lines = m - n + 1;
+    if (move) {
+        target.list.moveRangeFrom(source.list, n, m, target.currentLineNumber);
+        source.currentLineNumber = lineCount - lines + 1;
+    } else {
+        target.list.copyRangeFrom(source.list, n, m, target.currentLineNumber);
+    }
+
+    // The target's current line moves past them
+    target.currentLineNumber += lines;
+
+    out << lines << (lines == 1 ? " line " : " lines ") << (move ? "moved" : "copied") << " to "
+        << describe(target) << "." << std::endl;
+} // end cmdTransfer method
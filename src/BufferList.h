@@ -0,0 +1,71 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * BufferList .h header file
+ *
+ * The files open in the interactive editor, one Editor each. Commands go to the current buffer,
+ * switching only changes which one that is. Lines copied or moved to another buffer go in at its
+ * current line, moved lines are relinked rather than copied.
+ *
+ *   B            lists the buffers
+ *   B n          switches to buffer n
+ *   OPEN file    opens another file and switches to it
+ *   COPY n m b   copies lines n to m to buffer b
+ *   MOVE n m b   moves lines n to m to buffer b
+ *
+ * E saves and closes the current buffer, the editor exits once the last one is closed.
+ *
+ * With --max-mem every buffer has a block store of its own, and the one budget is split between them.
+ */
+
+#ifndef SPARQ_BUFFERLIST_H
+#define SPARQ_BUFFERLIST_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Editor.h"
+
+class BufferList {
+
+private:
+    std::vector<std::unique_ptr<Editor>> buffers;
+    size_t currentBuffer;
+    std::function<void(Editor &)> setUp; // gives a new buffer the command line's storage options
+    std::function<void()> onBackgroundUpdate; // handed to every buffer
+    size_t memoryLimit; // --max-mem for all the buffers together, 0 for no limit
+
+    std::string describe(const Editor &editor) const;
+    void shareMemory();
+    void cmdBuffers();
+    void cmdSwitch(size_t buffer);
+    void cmdOpen(const std::string &filename);
+    void cmdTransfer(int n, int m, size_t buffer, bool move);
+
+public:
+    explicit BufferList(std::function<void(Editor &)> setUp);
+    BufferList(const BufferList &) = delete;
+
+    Editor &current() { return *buffers[currentBuffer]; }
+    Editor &at(size_t buffer) { return *buffers[buffer]; }
+    size_t count() const { return buffers.size(); }
+
+    Editor &add();
+    Editor &open(const std::string &filename, bool follow);
+    bool closeCurrent(bool removeAutosave); // false once no buffer is left
+
+    bool commandEntered(const std::string &input);
+    void setBackgroundUpdate(std::function<void()> update);
+    void setMemoryLimit(size_t bytes);
+    void stopBackground();
+};
+
+#endif //SPARQ_BUFFERLIST_H
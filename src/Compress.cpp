@@ -0,0 +1,301 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Compress .cpp implementation file
+ *
+ * The LZ codec follows the LZ4 block layout: a token byte holding the literal and match lengths,
+ * the literal bytes, then a two byte offset back into the output for the match.
+ * Adapted from: https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+ */
+
+#include "Compress.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef SPARQ_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+static const int HashBits = 14;
+static const size_t MinMatch = 4;
+static const size_t MaxOffset = 65535;
+
+/**
+ * Summary: Writes a number 7 bits at a time, low bits first.
+ *
+ * @param string &output
+ * @param size_t value
+ */
+static void writeVarint(std::string &output, size_t value) {
+    while (value >= 0x80) {
+        output += (char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    output += (char) value;
+} // end writeVarint function
+
+/**
+ * Summary: Reads a number written by writeVarint.
+ *
+ * @param const string &input
+ * @param size_t *position
+ * @return the number
+ */
+static size_t readVarint(const std::string &input, size_t *position) {
+    size_t value = 0;
+    int shift = 0;
+
+    while (*position < input.size()) {
+        unsigned char byte = (unsigned char) input[(*position)++];
+        value |= (size_t) (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+        shift += 7;
+        if (shift > 63) { break; }
+    }
+
+    throw CorruptBlockException();
+} // end readVarint function
+
+/**
+ * Summary: Writes the part of a length that didn't fit in the token's four bits.
+ *
+ * @param string &output
+ * @param size_t length
+ */
+static void writeLengthExtra(std::string &output, size_t length) {
+    while (length >= 255) {
+        output += (char) 255;
+        length -= 255;
+    }
+    output += (char) length;
+} // end writeLengthExtra function
+
+/**
+ * Summary: Reads the extra bytes of a length and adds them on.
+ *
+ * @param const string &input
+ * @param size_t *position
+ * @return the extra length
+ */
+static size_t readLengthExtra(const std::string &input, size_t *position) {
+    size_t length = 0;
+    unsigned char byte;
+
+    do {
+        if (*position >= input.size()) { throw CorruptBlockException(); }
+        byte = (unsigned char) input[(*position)++];
+        length += byte;
+    } while (byte == 255);
+
+    return length;
+} // end readLengthExtra function
+
+static uint32_t read32(const char *data) {
+    uint32_t value;
+    std::memcpy(&value, data, 4);
+    return value;
+}
+
+/**
+ * Summary: Writes one sequence, the literals since the last match followed by a match.
+ * A match length of zero marks the final sequence, which has no offset.
+ *
+ * @param string &output
+ * @param const char *literals
+ * @param size_t literalLength
+ * @param size_t offset
+ * @param size_t matchLength
+ */
+static void writeSequence(std::string &output, const char *literals, size_t literalLength,
+                          size_t offset, size_t matchLength) {
+
+    size_t matchCode = matchLength == 0 ? 0 : matchLength - MinMatch;
+    unsigned char token = (unsigned char) (((literalLength < 15 ? literalLength : 15) << 4) |
+                                           (matchCode < 15 ? matchCode : 15));
+    output += (char) token;
+
+    if (literalLength >= 15) { writeLengthExtra(output, literalLength - 15); }
+    output.append(literals, literalLength);
+
+    if (matchLength == 0) { return; }
+
+    output += (char) (offset & 0xff);
+    output += (char) (offset >> 8);
+
+    if (matchCode >= 15) { writeLengthExtra(output, matchCode - 15); }
+} // end writeSequence function
+
+/**
+ * Summary: Compresses with the built-in LZ codec.
+ * Looks up the last position each 4 byte sequence was seen at and turns repeats into back references.
+ *
+ * @param const char *data
+ * @param size_t size
+ * @param string &output
+ */
+static void compressLZ(const char *data, size_t size, std::string &output) {
+
+    std::vector<int32_t> table((size_t) 1 << HashBits, -1);
+    size_t anchor = 0; // start of the literals not written yet
+    size_t i = 0;
+
+    while (i + MinMatch <= size) {
+        uint32_t sequence = read32(data + i);
+        uint32_t slot = (sequence * 2654435761U) >> (32 - HashBits);
+        int32_t candidate = table[slot];
+        table[slot] = (int32_t) i;
+
+        if (candidate >= 0 && i - candidate <= MaxOffset && read32(data + candidate) == sequence) {
+
+            // Extend the match as far as it goes
+            size_t length = MinMatch;
+            while (i + length < size && data[candidate + length] == data[i + length]) {
+                length++;
+            }
+
+            writeSequence(output, data + anchor, i - anchor, i - candidate, length);
+            i += length;
+            anchor = i;
+        } else {
+            // Step faster through data that isn't compressing
+            i += 1 + ((i - anchor) >> 6);
+        }
+    }
+
+    // Whatever is left goes out as literals
+    writeSequence(output, data + anchor, size - anchor, 0, 0);
+} // end compressLZ function
+
+/**
+ * Summary: Decompresses the built-in LZ codec, checking every length against the buffers.
+ *
+ * @param const string &input
+ * @param size_t position
+ * @param size_t size uncompressed size
+ * @param string &output
+ */
+static void decompressLZ(const std::string &input, size_t position, size_t size, std::string &output) {
+
+    output.resize(size);
+    char *out = &output[0];
+    size_t written = 0;
+
+    while (written < size) {
+        if (position >= input.size()) { throw CorruptBlockException(); }
+        unsigned char token = (unsigned char) input[position++];
+
+        // Literals
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) { literalLength += readLengthExtra(input, &position); }
+        if (literalLength > size - written || literalLength > input.size() - position) {
+            throw CorruptBlockException();
+        }
+        std::memcpy(out + written, input.data() + position, literalLength);
+        written += literalLength;
+        position += literalLength;
+
+        if (written == size) { break; }
+
+        // Match
+        if (position + 2 > input.size()) { throw CorruptBlockException(); }
+        size_t offset = (unsigned char) input[position] | ((size_t) (unsigned char) input[position + 1] << 8);
+        position += 2;
+
+        size_t matchLength = (token & 0x0f);
+        if (matchLength == 15) { matchLength += readLengthExtra(input, &position); }
+        matchLength += MinMatch;
+
+        if (offset == 0 || offset > written || matchLength > size - written) {
+            throw CorruptBlockException();
+        }
+
+        // Byte by byte, a match may overlap the bytes it is producing
+        const char *from = out + written - offset;
+        for (size_t k = 0; k < matchLength; ++k) {
+            out[written + k] = from[k];
+        }
+        written += matchLength;
+    }
+} // end decompressLZ function
+
+/**
+ * Summary: Checks whether a codec was compiled in.
+ *
+ * @param codec which
+ * @return true if compressBlock can use it
+ */
+bool isCodecAvailable(codec which) {
+#ifdef SPARQ_HAVE_ZLIB
+    (void) which;
+    return true;
+#else
+    return which == codecLZ;
+#endif
+} // end isCodecAvailable function
+
+/**
+ * Summary: Compresses a block. The output starts with the uncompressed size.
+ *
+ * @param codec which
+ * @param const char *data
+ * @param size_t size
+ * @param string &output
+ */
+void compressBlock(codec which, const char *data, size_t size, std::string &output) {
+
+    output.clear();
+    writeVarint(output, size);
+
+#ifdef SPARQ_HAVE_ZLIB
+    if (which == codecZlib) {
+        uLongf length = compressBound((uLong) size);
+        size_t header = output.size();
+        output.resize(header + length);
+        compress2((Bytef *) &output[header], &length, (const Bytef *) data, (uLong) size, Z_BEST_SPEED);
+        output.resize(header + length);
+        output.shrink_to_fit();
+        return;
+    }
+#endif
+
+    compressLZ(data, size, output);
+    output.shrink_to_fit();
+} // end compressBlock function
+
+/**
+ * Summary: Decompresses a block made by compressBlock with the same codec.
+ *
+ * @param codec which
+ * @param const string &input
+ * @param string &output
+ */
+void decompressBlock(codec which, const std::string &input, std::string &output) {
+
+    size_t position = 0;
+    size_t size = readVarint(input, &position);
+
+#ifdef SPARQ_HAVE_ZLIB
+    if (which == codecZlib) {
+        output.resize(size);
+        uLongf length = (uLongf) size;
+        int result = uncompress((Bytef *) &output[0], &length,
+                                (const Bytef *) input.data() + position, (uLong) (input.size() - position));
+        if (result != Z_OK || length != size) {
+            throw CorruptBlockException();
+        }
+        return;
+    }
+#endif
+
+    decompressLZ(input, position, size, output);
+} // end decompressBlock function
@@ -0,0 +1,39 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Compress .h header file
+ *
+ * Block compression for cold lines: a small built-in LZ77 codec (LZ4 style), or zlib when it was found at build time.
+ */
+
+#ifndef SPARQ_COMPRESS_H
+#define SPARQ_COMPRESS_H
+
+#include <exception>
+#include <string>
+
+// Available block codecs
+enum codec {
+    codecLZ,
+    codecZlib
+};
+
+bool isCodecAvailable(codec);
+void compressBlock(codec, const char *data, size_t size, std::string &output);
+void decompressBlock(codec, const std::string &input, std::string &output);
+
+// Custom Exceptions
+struct CorruptBlockException : public std::exception {
+public:
+    const std::string what() {
+        return "Compressed block is corrupt.";
+    }
+};//end CorruptBlockException struct
+
+#endif //SPARQ_COMPRESS_H
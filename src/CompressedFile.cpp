@@ -0,0 +1,620 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * CompressedFile .cpp implementation file
+ */
+
+#include "CompressedFile.h"
+#include "Editor.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+// How far back deflate can refer, what each gzip block is primed with
+static const size_t DeflateWindow = 32768;
+
+/**
+ * Summary: Tells the format of a file from its first bytes.
+ *
+ * @param const string &filename
+ * @return format, formatPlain if the file can't be read
+ */
+fileFormat detectFormat(const std::string &filename) {
+
+    unsigned char magic[4] = {0, 0, 0, 0};
+    std::ifstream input(filename, std::ios::binary);
+    input.read((char*) magic, sizeof(magic));
+
+    if (input.gcount() >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return formatGzip;
+    }
+    if (input.gcount() == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return formatZstd;
+    }
+    return formatPlain;
+} // end detectFormat function
+
+/**
+ * Summary: Picks the format for a new file from its extension (.gz or .zst).
+ *
+ * @param const string &filename
+ * @return format
+ */
+fileFormat formatForName(const std::string &filename) {
+
+    auto endsWith = [&filename](const std::string &extension) {
+        return filename.size() > extension.size() &&
+               filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+    };
+
+    if (endsWith(".gz")) { return formatGzip; }
+    if (endsWith(".zst")) { return formatZstd; }
+    return formatPlain;
+} // end formatForName function
+
+const char* formatName(fileFormat format) {
+    switch (format) {
+        case formatGzip: return "gzip";
+        case formatZstd: return "zstd";
+        default: return "plain text";
+    }
+} // end formatName function
+
+/**
+ * Summary: Opens a file for reading lines, decompressing it if it's compressed.
+ *
+ * @param const string &filename
+ * @return line source
+ */
+std::unique_ptr<LineSource> LineSource::open(const std::string &filename) {
+
+    fileFormat format = detectFormat(filename);
+
+    switch (format) {
+        case formatGzip:
+#ifdef SPARQ_HAVE_ZLIB
+            return std::unique_ptr<LineSource>(new GzipReader(filename));
+#else
+            throw FormatUnavailableException(format);
+#endif
+        case formatZstd:
+#ifdef SPARQ_HAVE_ZSTD
+            return std::unique_ptr<LineSource>(new ZstdReader(filename));
+#else
+            throw FormatUnavailableException(format);
+#endif
+        default:
+            return std::unique_ptr<LineSource>(new LineReader(filename));
+    }
+} // end open method
+
+/**
+ * Summary: Opens a file for saving, compressing what's written in the given format. The file is only
+ * replaced when the sink is closed.
+ *
+ * @param const string &filename
+ * @param fileFormat format
+ * @return sink
+ */
+std::unique_ptr<FileSink> FileSink::create(const std::string &filename, fileFormat format) {
+
+    switch (format) {
+        case formatGzip:
+#ifdef SPARQ_HAVE_ZLIB
+            return std::unique_ptr<FileSink>(new GzipWriter(filename));
+#else
+            throw FormatUnavailableException(format);
+#endif
+        case formatZstd:
+#ifdef SPARQ_HAVE_ZSTD
+            return std::unique_ptr<FileSink>(new ZstdWriter(filename));
+#else
+            throw FormatUnavailableException(format);
+#endif
+        default:
+            return std::unique_ptr<FileSink>(new FileWriter(filename));
+    }
+} // end create method
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Constructor
+ *
+ * @param const string &filename
+ */
+DecompressingReader::DecompressingReader(const std::string &filename)
+        : buffer(IoChunkSize), position(0), filled(0), finished(false), input(filename, std::ios::binary),
+          compressed(IoChunkSize), fileSize(0) {
+
+    if (!input.is_open()) {
+        throw FileFailedToOpenException();
+    }
+
+    input.seekg(0, std::ios::end);
+    fileSize = (uint64_t) input.tellg();
+    input.seekg(0, std::ios::beg);
+} // end DecompressingReader constructor
+
+/**
+ * Summary: Reads the next line, decompressing more text whenever the buffer runs out. Same line
+ * rules as LineReader.
+ *
+ * @param string &line without its newline
+ * @return false once every line has been read
+ */
+bool DecompressingReader::next(std::string &line) {
+
+    if (finished) {
+        return false;
+    }
+
+    line.clear();
+
+    while (true) {
+        if (position == filled) {
+            TraceSpan span("decompress");
+            filled = decompress(buffer.data(), buffer.size());
+            position = 0;
+            if (filled == 0) {
+                finished = true;
+                return true;
+            }
+            continue;
+        }
+
+        const char* start = buffer.data() + position;
+        size_t available = filled - position;
+        const char* newline = (const char*) std::memchr(start, '\n', available);
+
+        if (newline == nullptr) {
+            // The line carries on in the next buffer
+            line.append(start, available);
+            position = filled;
+            continue;
+        }
+
+        line.append(start, (size_t) (newline - start));
+        position += (size_t) (newline - start) + 1;
+
+#ifdef _WIN32
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+#endif
+        return true;
+    }
+} // end next method
+
+// --------------------------------------------------------------------------------
+
+#ifdef SPARQ_HAVE_ZLIB
+
+/**
+ * Constructor
+ *
+ * @param const string &filename
+ */
+GzipReader::GzipReader(const std::string &filename) : DecompressingReader(filename), memberEnded(false) {
+
+    std::memset(&stream, 0, sizeof(stream));
+
+    // 16 + 15: gzip header and trailer around a deflate stream with the largest window
+    if (inflateInit2(&stream, 16 + 15) != Z_OK) {
+        throw FileFailedToOpenException();
+    }
+} // end GzipReader constructor
+
+/**
+ * Destructor
+ */
+GzipReader::~GzipReader() {
+    inflateEnd(&stream);
+}
+
+/**
+ * Summary: Decompresses into the buffer until it's full or the file ends. Files made of several gzip
+ * members one after another (like cat a.gz b.gz) are read as one.
+ *
+ * @param char *output
+ * @param size_t capacity
+ * @return bytes decompressed, 0 at the end of the file
+ */
+size_t GzipReader::decompress(char* output, size_t capacity) {
+
+    stream.next_out = (Bytef*) output;
+    stream.avail_out = (uInt) capacity;
+
+    while (stream.avail_out > 0) {
+        if (stream.avail_in == 0) {
+            input.read(compressed.data(), (std::streamsize) compressed.size());
+            size_t count = (size_t) input.gcount();
+            if (count == 0) {
+                // A member cut off part way is a truncated file
+                if (!memberEnded) {
+                    throw IoException();
+                }
+                break;
+            }
+            stream.next_in = (Bytef*) compressed.data();
+            stream.avail_in = (uInt) count;
+        }
+
+        memberEnded = false;
+        int result = inflate(&stream, Z_NO_FLUSH);
+
+        if (result == Z_STREAM_END) {
+            memberEnded = true;
+            inflateReset(&stream);
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            throw IoException();
+        }
+    }
+
+    return capacity - stream.avail_out;
+} // end decompress method
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Constructor
+ *
+ * Writes the gzip header. Blocks are compressed on the shared thread pool.
+ *
+ * @param const string &filename
+ */
+GzipWriter::GzipWriter(const std::string &filename)
+        : out(filename), crc(0), total(0), closed(false) {
+
+    // Magic, deflate, no flags, no time, no extra flags, unknown system
+    static const char header[10] = {0x1f, (char) 0x8b, 8, 0, 0, 0, 0, 0, 0, (char) 0xff};
+    out.write(header, sizeof(header));
+
+    crc = (uint32_t) crc32(0L, Z_NULL, 0);
+    current.reserve(CompressBlockSize);
+
+    maxQueued = ThreadPool::shared().size() * 2;
+} // end GzipWriter constructor
+
+/**
+ * Destructor
+ *
+ * A writer that wasn't closed leaves the file as it was, blocks still being compressed are waited for.
+ */
+GzipWriter::~GzipWriter() {
+    compressing.cancel();
+}
+
+/**
+ * Summary: Compresses one block to raw deflate data. Every block but the last ends on a byte
+ * boundary without ending the stream, so the blocks can simply be written one after another.
+ *
+ * @param Block &block
+ */
+void GzipWriter::compress(Block &block) {
+
+    TraceSpan span("compress");
+
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        block.failed = true;
+        return;
+    }
+
+    // Matches can reach back into the block before, as if the whole file were compressed in one go
+    if (!block.dictionary.empty()) {
+        deflateSetDictionary(&stream, (const Bytef*) block.dictionary.data(), (uInt) block.dictionary.size());
+    }
+
+    stream.next_in = (Bytef*) block.input.data();
+    stream.avail_in = (uInt) block.input.size();
+
+    // Room for the block plus the flush marker
+    block.output.resize(deflateBound(&stream, (uLong) block.input.size()) + 16);
+    size_t used = 0;
+    int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+    int result;
+
+    while (true) {
+        if (used == block.output.size()) {
+            block.output.resize(block.output.size() * 2);
+        }
+        stream.next_out = (Bytef*) &block.output[used];
+        stream.avail_out = (uInt) (block.output.size() - used);
+
+        result = deflate(&stream, flush);
+        used = block.output.size() - stream.avail_out;
+
+        if (result == Z_STREAM_ERROR) {
+            block.failed = true;
+            break;
+        }
+        if (block.last ? result == Z_STREAM_END : (stream.avail_in == 0 && stream.avail_out > 0)) {
+            break;
+        }
+    }
+
+    deflateEnd(&stream);
+    block.output.resize(used);
+
+    block.crc = (uint32_t) crc32(0L, Z_NULL, 0);
+    block.crc = (uint32_t) crc32(block.crc, (const Bytef*) block.input.data(), (uInt) block.input.size());
+} // end compress method
+
+/**
+ * Summary: Hands the block being filled to the thread pool.
+ *
+ * @param bool last
+ */
+void GzipWriter::queue(bool last) {
+
+    std::unique_ptr<Block> block(new Block());
+    block->input.swap(current);
+    block->dictionary = previousTail;
+    block->crc = 0;
+    block->last = last;
+    block->done = false;
+    block->failed = false;
+
+    // The next block is primed with the end of everything so far
+    if (block->input.size() >= DeflateWindow) {
+        previousTail.assign(block->input, block->input.size() - DeflateWindow, DeflateWindow);
+    } else {
+        previousTail += block->input;
+        if (previousTail.size() > DeflateWindow) {
+            previousTail.erase(0, previousTail.size() - DeflateWindow);
+        }
+    }
+
+    current.reserve(CompressBlockSize);
+
+    Block* queued = block.get();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        blocks.push_back(std::move(block));
+    }
+
+    compressing.run([this, queued]() {
+        compress(*queued);
+        std::lock_guard<std::mutex> guard(lock);
+        queued->done = true;
+        changed.notify_all();
+    });
+
+    writeFinished(false);
+} // end queue method
+
+/**
+ * Summary: Writes out compressed blocks from the front of the queue. Waits for the front block when
+ * too many are queued (so memory stays bounded) or when everything has to be written.
+ *
+ * @param bool all
+ */
+void GzipWriter::writeFinished(bool all) {
+
+    std::unique_lock<std::mutex> guard(lock);
+
+    while (!blocks.empty()) {
+        Block* front = blocks.front().get();
+
+        if (!front->done) {
+            if (!all && blocks.size() <= maxQueued) {
+                break;
+            }
+
+            // Help compress while waiting, with a pool of one thread nothing else would
+            guard.unlock();
+            bool helped = compressing.runPending();
+            guard.lock();
+            if (!helped) {
+                changed.wait(guard, [front]() { return front->done; });
+            }
+            continue;
+        }
+
+        std::unique_ptr<Block> finished = std::move(blocks.front());
+        blocks.pop_front();
+        guard.unlock();
+
+        if (finished->failed) {
+            throw IoException();
+        }
+
+        crc = (uint32_t) crc32_combine(crc, finished->crc, (z_off_t) finished->input.size());
+        total += finished->input.size();
+        out.write(finished->output);
+
+        guard.lock();
+    }
+} // end writeFinished method
+
+/**
+ * Summary: Adds text to the file, queuing each full block for compression.
+ *
+ * @param const char *data
+ * @param size_t length
+ */
+void GzipWriter::write(const char* data, size_t length) {
+
+    while (length > 0) {
+        size_t copied = std::min(length, CompressBlockSize - current.size());
+        current.append(data, copied);
+        data += copied;
+        length -= copied;
+
+        if (current.size() == CompressBlockSize) {
+            queue(false);
+        }
+    }
+} // end write method
+
+/**
+ * Summary: Compresses and writes what's left, then the gzip trailer. Throws IoException if anything failed.
+ */
+void GzipWriter::close() {
+
+    if (closed) {
+        return;
+    }
+    closed = true;
+
+    queue(true);
+    writeFinished(true);
+
+    // CRC and length of the text, little endian
+    char trailer[8];
+    for (int i = 0; i < 4; i++) {
+        trailer[i] = (char) (crc >> (8 * i));
+        trailer[4 + i] = (char) (total >> (8 * i));
+    }
+    out.write(trailer, sizeof(trailer));
+    out.close();
+} // end close method
+
+#endif
+
+// --------------------------------------------------------------------------------
+
+#ifdef SPARQ_HAVE_ZSTD
+
+/**
+ * Constructor
+ *
+ * @param const string &filename
+ */
+ZstdReader::ZstdReader(const std::string &filename) : DecompressingReader(filename), frameLeft(0) {
+
+    context = ZSTD_createDCtx();
+    if (context == nullptr) {
+        throw FileFailedToOpenException();
+    }
+    pending.src = compressed.data();
+    pending.size = 0;
+    pending.pos = 0;
+} // end ZstdReader constructor
+
+/**
+ * Destructor
+ */
+ZstdReader::~ZstdReader() {
+    ZSTD_freeDCtx(context);
+}
+
+/**
+ * Summary: Decompresses into the buffer until it's full or the file ends. Several frames one after
+ * another are read as one.
+ *
+ * @param char *output
+ * @param size_t capacity
+ * @return bytes decompressed, 0 at the end of the file
+ */
+size_t ZstdReader::decompress(char* output, size_t capacity) {
+
+    ZSTD_outBuffer target = {output, capacity, 0};
+
+    while (target.pos < target.size) {
+        if (pending.pos == pending.size) {
+            input.read(compressed.data(), (std::streamsize) compressed.size());
+            size_t count = (size_t) input.gcount();
+            if (count == 0) {
+                // A frame cut off part way is a truncated file
+                if (frameLeft != 0) {
+                    throw IoException();
+                }
+                break;
+            }
+            pending.src = compressed.data();
+            pending.size = count;
+            pending.pos = 0;
+        }
+
+        frameLeft = ZSTD_decompressStream(context, &target, &pending);
+        if (ZSTD_isError(frameLeft)) {
+            throw IoException();
+        }
+    }
+
+    return target.pos;
+} // end decompress method
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Constructor
+ *
+ * zstd runs its own compressing threads, as many as the shared pool has so --threads limits them too.
+ * It ignores that when it was built without threads.
+ *
+ * @param const string &filename
+ */
+ZstdWriter::ZstdWriter(const std::string &filename) : out(filename), buffer(ZSTD_CStreamOutSize()) {
+
+    context = ZSTD_createCCtx();
+    if (context == nullptr) {
+        throw FileFailedToOpenException();
+    }
+
+    unsigned threads = ThreadPool::shared().size();
+    ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+    ZSTD_CCtx_setParameter(context, ZSTD_c_nbWorkers, threads > 1 ? (int) threads : 0);
+
+    current.reserve(CompressBlockSize);
+} // end ZstdWriter constructor
+
+/**
+ * Destructor
+ */
+ZstdWriter::~ZstdWriter() {
+    ZSTD_freeCCtx(context);
+}
+
+/**
+ * Summary: Feeds the waiting text to zstd and writes whatever it has compressed so far.
+ *
+ * @param ZSTD_EndDirective mode ZSTD_e_continue, or ZSTD_e_end to finish the frame
+ */
+void ZstdWriter::compress(ZSTD_EndDirective mode) {
+
+    TraceSpan span("compress");
+
+    ZSTD_inBuffer source = {current.data(), current.size(), 0};
+
+    while (true) {
+        ZSTD_outBuffer target = {buffer.data(), buffer.size(), 0};
+        size_t left = ZSTD_compressStream2(context, &target, &source, mode);
+        if (ZSTD_isError(left)) {
+            throw IoException();
+        }
+        out.write(buffer.data(), target.pos);
+
+        if (mode == ZSTD_e_end ? left == 0 : source.pos == source.size) {
+            break;
+        }
+    }
+
+    current.clear();
+} // end compress method
+
+void ZstdWriter::write(const char* data, size_t length) {
+
+    current.append(data, length);
+    if (current.size() >= CompressBlockSize) {
+        compress(ZSTD_e_continue);
+    }
+} // end write method
+
+void ZstdWriter::close() {
+    compress(ZSTD_e_end);
+    out.close();
+} // end close method
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * CompressedFile .h header file
+ *
+ * Reading and writing gzip files (and zstd files when libzstd was found at build time) without a
+ * decompressed copy on disk. Readers decompress a buffer at a time and split it into lines as they go.
+ *
+ * The gzip writer cuts the text into 1 MB blocks and compresses them on the thread pool while the
+ * next block is filled. Each block is compressed on its own, primed with the last 32 KB of the block
+ * before it, and the compressed blocks are joined into a single gzip stream (the way pigz does it).
+ * The zstd writer uses zstd's own worker threads.
+ */
+
+#ifndef SPARQ_COMPRESSEDFILE_H
+#define SPARQ_COMPRESSEDFILE_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+
+#include "FileIo.h"
+#include "ThreadPool.h"
+
+#ifdef SPARQ_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef SPARQ_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+// Uncompressed text in each block the gzip writer compresses on its own
+const size_t CompressBlockSize = 1 << 20;
+
+// Splits decompressed text into lines, the decompression is up to each format
+class DecompressingReader : public LineSource {
+
+private:
+    std::vector<char> buffer; // decompressed text
+    size_t position;
+    size_t filled;
+    bool finished;
+
+protected:
+    std::ifstream input;
+    std::vector<char> compressed;
+    uint64_t fileSize;
+
+    virtual size_t decompress(char* output, size_t capacity) = 0; // 0 at the end, throws IoException if corrupt
+
+public:
+    explicit DecompressingReader(const std::string &filename); // throws FileFailedToOpenException
+    DecompressingReader(const DecompressingReader &) = delete;
+
+    bool next(std::string &line) override;
+    bool eof() const override { return finished; }
+    uint64_t size() const override { return fileSize; }
+};
+
+#ifdef SPARQ_HAVE_ZLIB
+class GzipReader : public DecompressingReader {
+
+private:
+    z_stream stream;
+    bool memberEnded; // the last gzip member read was complete, another may follow
+
+    size_t decompress(char* output, size_t capacity) override;
+
+public:
+    explicit GzipReader(const std::string &filename);
+    ~GzipReader() override;
+};
+
+class GzipWriter : public FileSink {
+
+private:
+    struct Block {
+        std::string input;
+        std::string dictionary; // end of the block before
+        std::string output; // raw deflate data
+        uint32_t crc;
+        bool last; // ends the deflate stream
+        bool done;
+        bool failed;
+    };
+
+    FileWriter out;
+    std::mutex lock;
+    std::condition_variable changed; // a block was queued or compressed
+    std::deque<std::unique_ptr<Block>> blocks; // in file order, written from the front once compressed
+    size_t maxQueued;
+
+    std::string current; // block being filled
+    std::string previousTail; // last 32 KB of text queued so far
+    uint32_t crc; // of everything written out
+    uint64_t total;
+    bool closed;
+    TaskGroup compressing; // last, so it waits for the blocks before they're freed
+
+    static void compress(Block &block);
+    void queue(bool last);
+    void writeFinished(bool all);
+
+public:
+    explicit GzipWriter(const std::string &filename); // throws FileFailedToOpenException
+    ~GzipWriter() override;
+    GzipWriter(const GzipWriter &) = delete;
+
+    using FileSink::write;
+    void write(const char* data, size_t length) override;
+    void close() override;
+};
+#endif
+
+#ifdef SPARQ_HAVE_ZSTD
+class ZstdReader : public DecompressingReader {
+
+private:
+    ZSTD_DCtx* context;
+    ZSTD_inBuffer pending;
+    size_t frameLeft; // what the last call said is left of the frame, 0 between frames
+
+    size_t decompress(char* output, size_t capacity) override;
+
+public:
+    explicit ZstdReader(const std::string &filename);
+    ~ZstdReader() override;
+};
+
+class ZstdWriter : public FileSink {
+
+private:
+    FileWriter out;
+    ZSTD_CCtx* context;
+    std::string current; // text waiting to be compressed
+    std::vector<char> buffer; // compressed output
+
+    void compress(ZSTD_EndDirective mode);
+
+public:
+    explicit ZstdWriter(const std::string &filename); // throws FileFailedToOpenException
+    ~ZstdWriter() override;
+    ZstdWriter(const ZstdWriter &) = delete;
+
+    using FileSink::write;
+    void write(const char* data, size_t length) override;
+    void close() override;
+};
+#endif
+
+// Custom Exceptions
+struct FormatUnavailableException : public std::exception {
+public:
+    fileFormat format;
+
+    explicit FormatUnavailableException(fileFormat format) : format(format) {}
+
+    const std::string what() {
+        return std::string(formatName(format)) + " support is not available in this build.";
+    }
+};//end FormatUnavailableException struct
+
+#endif //SPARQ_COMPRESSEDFILE_H
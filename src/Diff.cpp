@@ -0,0 +1,414 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Diff .cpp implementation file
+ *
+ * Based on: Eugene W. Myers, "An O(ND) Difference Algorithm and Its Variations" (1986),
+ * using the linear space middle snake refinement.
+ */
+
+#include "Diff.h"
+#include "LineHash.h"
+#include "LinkedList.h"
+
+#include <climits>
+#include <cmath>
+#include <unordered_set>
+
+/**
+ * Summary: Adds a line to the sequence and hashes it.
+ *
+ * @param const char *data
+ * @param size_t size
+ */
+void DiffLines::add(const char *data, size_t size) {
+    text.push_back(data);
+    length.push_back(size);
+    hashes.push_back(hashLine(data, size));
+} // end add method
+
+/**
+ * Summary: Adds a line held by a list node. Only the node is kept, its text is read again when printing
+ * (a compressed line might not stay in memory until then).
+ *
+ * @param const Node *node
+ */
+void DiffLines::add(const Node *node) {
+    nodes.push_back(node);
+    hashes.push_back(hashLine(node->line()));
+} // end add method
+
+/**
+ * Constructor
+ *
+ * Runs the diff of the two hash sequences and collects the changed runs.
+ *
+ * @param const vector<uint64_t> &oldHashes
+ * @param const vector<uint64_t> &newHashes
+ */
+LineDiff::LineDiff(const std::vector<uint64_t> &oldHashes, const std::vector<uint64_t> &newHashes)
+        : a(oldHashes.data()), b(newHashes.data()) {
+
+    int n = (int) oldHashes.size();
+    int m = (int) newHashes.size();
+    deleted.assign(n, 0);
+    inserted.assign(m, 0);
+
+    // Skip the common prefix and suffix before doing any real work
+    int prefix = 0;
+    while (prefix < n && prefix < m && oldHashes[prefix] == newHashes[prefix]) { prefix++; }
+    int suffix = 0;
+    while (suffix < n - prefix && suffix < m - prefix &&
+           oldHashes[n - 1 - suffix] == newHashes[m - 1 - suffix]) { suffix++; }
+
+    // Lines that appear only on one side are changes no matter what, so mark them right away
+    // and only run the search on lines that could match (GNU diff does the same)
+    std::unordered_set<uint64_t> oldSet(oldHashes.begin() + prefix, oldHashes.end() - suffix);
+    std::unordered_set<uint64_t> newSet(newHashes.begin() + prefix, newHashes.end() - suffix);
+    std::vector<uint64_t> oldKept;
+    std::vector<uint64_t> newKept;
+    std::vector<int> oldIndex;
+    std::vector<int> newIndex;
+
+    for (int x = prefix; x < n - suffix; ++x) {
+        if (newSet.count(oldHashes[x])) {
+            oldKept.push_back(oldHashes[x]);
+            oldIndex.push_back(x);
+        } else {
+            deleted[x] = 1;
+        }
+    }
+    for (int y = prefix; y < m - suffix; ++y) {
+        if (oldSet.count(newHashes[y])) {
+            newKept.push_back(newHashes[y]);
+            newIndex.push_back(y);
+        } else {
+            inserted[y] = 1;
+        }
+    }
+
+    int keptN = (int) oldKept.size();
+    int keptM = (int) newKept.size();
+    a = oldKept.data();
+    b = newKept.data();
+    std::vector<char> keptDeleted(keptN, 0);
+    std::vector<char> keptInserted(keptM, 0);
+    keptDeleted.swap(deleted);
+    keptInserted.swap(inserted);
+
+    // Diagonals range from -(keptM + 1) to (keptN + 1)
+    diagonalOffset = keptM + 1;
+    forward.assign(keptN + keptM + 3, 0);
+    backward.assign(keptN + keptM + 3, 0);
+
+    // Past this cost the search stops looking for a minimal diff, same idea as GNU diff
+    tooExpensive = 4096;
+    int root = (int) std::sqrt((double) (keptN + keptM));
+    if (root * 4 > tooExpensive) { tooExpensive = root * 4; }
+
+    compareSequences(0, keptN, 0, keptM);
+
+    // Map the marks on the kept lines back to the full sequences
+    keptDeleted.swap(deleted);
+    keptInserted.swap(inserted);
+    for (int x = 0; x < keptN; ++x) {
+        if (keptDeleted[x]) { deleted[oldIndex[x]] = 1; }
+    }
+    for (int y = 0; y < keptM; ++y) {
+        if (keptInserted[y]) { inserted[newIndex[y]] = 1; }
+    }
+    a = oldHashes.data();
+    b = newHashes.data();
+
+    // Collect runs of deleted and inserted lines into changes
+    int x = 0;
+    int y = 0;
+    while (x < n || y < m) {
+        if ((x < n && deleted[x]) || (y < m && inserted[y])) {
+            DiffChange change{x, x, y, y};
+            while (x < n && deleted[x]) { x++; }
+            while (y < m && inserted[y]) { y++; }
+            change.oldEnd = x;
+            change.newEnd = y;
+            changeList.push_back(change);
+        } else {
+            x++;
+            y++;
+        }
+    }
+
+    // The search arrays are only needed while diffing
+    std::vector<int>().swap(forward);
+    std::vector<int>().swap(backward);
+} // end LineDiff constructor
+
+/**
+ * Summary: Marks the lines that differ between a[xOffset, xLimit) and b[yOffset, yLimit).
+ * Splits the problem on the middle snake until each piece is only deletions or only insertions.
+ *
+ * @param int xOffset
+ * @param int xLimit
+ * @param int yOffset
+ * @param int yLimit
+ */
+void LineDiff::compareSequences(int xOffset, int xLimit, int yOffset, int yLimit) {
+
+    // Explicit stack of sub problems so deep splits can't overflow the call stack
+    std::vector<int> pending = {xOffset, xLimit, yOffset, yLimit};
+
+    while (!pending.empty()) {
+        yLimit = pending.back(); pending.pop_back();
+        yOffset = pending.back(); pending.pop_back();
+        xLimit = pending.back(); pending.pop_back();
+        xOffset = pending.back(); pending.pop_back();
+
+        // Skip the common prefix and suffix
+        while (xOffset < xLimit && yOffset < yLimit && a[xOffset] == b[yOffset]) {
+            xOffset++;
+            yOffset++;
+        }
+        while (xOffset < xLimit && yOffset < yLimit && a[xLimit - 1] == b[yLimit - 1]) {
+            xLimit--;
+            yLimit--;
+        }
+
+        if (xOffset == xLimit) {
+            // Only insertions are left
+            while (yOffset < yLimit) { inserted[yOffset++] = 1; }
+        } else if (yOffset == yLimit) {
+            // Only deletions are left
+            while (xOffset < xLimit) { deleted[xOffset++] = 1; }
+        } else {
+            int xMid = 0;
+            int yMid = 0;
+            middleSnake(xOffset, xLimit, yOffset, yLimit, &xMid, &yMid);
+
+            pending.insert(pending.end(), {xOffset, xMid, yOffset, yMid});
+            pending.insert(pending.end(), {xMid, xLimit, yMid, yLimit});
+        }
+    }
+} // end compareSequences method
+
+/**
+ * Summary: Finds the midpoint of the shortest edit script for a[xOffset, xLimit) and b[yOffset, yLimit)
+ * by searching forward from the start and backward from the end until the two searches overlap.
+ *
+ * @param int xOffset
+ * @param int xLimit
+ * @param int yOffset
+ * @param int yLimit
+ * @param int *xMid
+ * @param int *yMid
+ */
+void LineDiff::middleSnake(int xOffset, int xLimit, int yOffset, int yLimit, int *xMid, int *yMid) {
+
+    int *fd = forward.data() + diagonalOffset;
+    int *bd = backward.data() + diagonalOffset;
+
+    const int minDiagonal = xOffset - yLimit;
+    const int maxDiagonal = xLimit - yOffset;
+    const int forwardMid = xOffset - yOffset;
+    const int backwardMid = xLimit - yLimit;
+    int fMin = forwardMid, fMax = forwardMid;
+    int bMin = backwardMid, bMax = backwardMid;
+    const bool odd = ((forwardMid - backwardMid) & 1) != 0;
+
+    fd[forwardMid] = xOffset;
+    bd[backwardMid] = xLimit;
+
+    for (int cost = 1;; ++cost) {
+
+        // Extend the forward search by one edit
+        if (fMin > minDiagonal) { fd[--fMin - 1] = -1; } else { ++fMin; }
+        if (fMax < maxDiagonal) { fd[++fMax + 1] = -1; } else { --fMax; }
+
+        for (int d = fMax; d >= fMin; d -= 2) {
+            int low = fd[d - 1];
+            int high = fd[d + 1];
+            int x = low >= high ? low + 1 : high;
+            int y = x - d;
+
+            // Follow the snake of matching lines
+            while (x < xLimit && y < yLimit && a[x] == b[y]) {
+                x++;
+                y++;
+            }
+            fd[d] = x;
+
+            if (odd && bMin <= d && d <= bMax && bd[d] <= x) {
+                *xMid = x;
+                *yMid = y;
+                return;
+            }
+        }
+
+        // Extend the backward search by one edit
+        if (bMin > minDiagonal) { bd[--bMin - 1] = INT_MAX; } else { ++bMin; }
+        if (bMax < maxDiagonal) { bd[++bMax + 1] = INT_MAX; } else { --bMax; }
+
+        for (int d = bMax; d >= bMin; d -= 2) {
+            int low = bd[d - 1];
+            int high = bd[d + 1];
+            int x = low < high ? low : high - 1;
+            int y = x - d;
+
+            while (xOffset < x && yOffset < y && a[x - 1] == b[y - 1]) {
+                x--;
+                y--;
+            }
+            bd[d] = x;
+
+            if (!odd && fMin <= d && d <= fMax && x <= fd[d]) {
+                *xMid = x;
+                *yMid = y;
+                return;
+            }
+        }
+
+        // Give up on a minimal diff and split at whichever search has made the most progress
+        if (cost >= tooExpensive) {
+            int forwardBest = -1;
+            int forwardX = xOffset;
+            for (int d = fMax; d >= fMin; d -= 2) {
+                int x = fd[d] < xLimit ? fd[d] : xLimit;
+                int y = x - d;
+                if (yLimit < y) {
+                    x = yLimit + d;
+                    y = yLimit;
+                }
+                if (forwardBest < x + y) {
+                    forwardBest = x + y;
+                    forwardX = x;
+                }
+            }
+
+            int backwardBest = INT_MAX;
+            int backwardX = xLimit;
+            for (int d = bMax; d >= bMin; d -= 2) {
+                int x = bd[d] > xOffset ? bd[d] : xOffset;
+                int y = x - d;
+                if (y < yOffset) {
+                    x = yOffset + d;
+                    y = yOffset;
+                }
+                if (x + y < backwardBest) {
+                    backwardBest = x + y;
+                    backwardX = x;
+                }
+            }
+
+            if ((xLimit + yLimit) - backwardBest < forwardBest - (xOffset + yOffset)) {
+                *xMid = forwardX;
+                *yMid = forwardBest - forwardX;
+            } else {
+                *xMid = backwardX;
+                *yMid = backwardBest - backwardX;
+            }
+            return;
+        }
+    }
+} // end middleSnake method
+
+/**
+ * Summary: Formats a unified diff range as start,count (count left off when it is 1).
+ *
+ * @param string &output
+ * @param int start zero based first line
+ * @param int count
+ */
+static void appendRange(std::string &output, int start, int count) {
+
+    // An empty range names the line before it
+    output += std::to_string(count == 0 ? start : start + 1);
+
+    if (count != 1) {
+        output += ',';
+        output += std::to_string(count);
+    }
+} // end appendRange function
+
+/**
+ * Summary: Appends one prefixed line of text to the diff output.
+ *
+ * @param string &output
+ * @param char prefix
+ * @param const DiffLines &lines
+ * @param int index
+ */
+static void appendLine(std::string &output, char prefix, const DiffLines &lines, int index) {
+    output += prefix;
+    if (lines.nodes.empty()) {
+        output.append(lines.text[index], lines.length[index]);
+    } else {
+        output += lines.nodes[index]->line();
+    }
+    output += '\n';
+} // end appendLine function
+
+/**
+ * Summary: Writes the changes as a unified diff (diff -u style) into the output buffer.
+ *
+ * @param string &output
+ * @param const DiffLines &oldLines
+ * @param const DiffLines &newLines
+ * @param const string &oldLabel
+ * @param const string &newLabel
+ * @param int context lines of unchanged text around each change
+ */
+void LineDiff::writeUnified(std::string &output, const DiffLines &oldLines, const DiffLines &newLines,
+                            const std::string &oldLabel, const std::string &newLabel, int context) const {
+
+    if (changeList.empty()) { return; }
+
+    output += "--- " + oldLabel + "\n";
+    output += "+++ " + newLabel + "\n";
+
+    size_t first = 0;
+    while (first < changeList.size()) {
+
+        // Group changes that are close enough to share context into one hunk
+        size_t last = first;
+        while (last + 1 < changeList.size() &&
+               changeList[last + 1].oldStart - changeList[last].oldEnd <= 2 * context) {
+            last++;
+        }
+
+        int oldStart = changeList[first].oldStart - context;
+        if (oldStart < 0) { oldStart = 0; }
+        int oldEnd = changeList[last].oldEnd + context;
+        if (oldEnd > oldLines.size()) { oldEnd = oldLines.size(); }
+
+        // Both sides share the same leading and trailing context lines
+        int newStart = changeList[first].newStart - (changeList[first].oldStart - oldStart);
+        int newEnd = changeList[last].newEnd + (oldEnd - changeList[last].oldEnd);
+
+        output += "@@ -";
+        appendRange(output, oldStart, oldEnd - oldStart);
+        output += " +";
+        appendRange(output, newStart, newEnd - newStart);
+        output += " @@\n";
+
+        int x = oldStart;
+        for (size_t c = first; c <= last; ++c) {
+            const DiffChange &change = changeList[c];
+
+            // Unchanged lines before this change
+            for (; x < change.oldStart; ++x) { appendLine(output, ' ', oldLines, x); }
+
+            for (int i = change.oldStart; i < change.oldEnd; ++i) { appendLine(output, '-', oldLines, i); }
+            for (int i = change.newStart; i < change.newEnd; ++i) { appendLine(output, '+', newLines, i); }
+            x = change.oldEnd;
+        }
+
+        // Trailing context
+        for (; x < oldEnd; ++x) { appendLine(output, ' ', oldLines, x); }
+
+        first = last + 1;
+    }
+} // end writeUnified method
@@ -0,0 +1,69 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Diff .h header file
+ *
+ * Line level diff using Myers' O(ND) algorithm run on sequences of line hashes.
+ */
+
+#ifndef SPARQ_DIFF_H
+#define SPARQ_DIFF_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A run of changed lines, [oldStart, oldEnd) in the old sequence replaced by [newStart, newEnd) in the new one
+struct DiffChange {
+    int oldStart;
+    int oldEnd;
+    int newStart;
+    int newEnd;
+};
+
+class Node;
+
+// A sequence of lines for the diff, stored as pointers into text owned by the caller or as list nodes
+struct DiffLines {
+    std::vector<const char *> text; // start of each line
+    std::vector<size_t> length; // length of each line
+    std::vector<const Node *> nodes; // or the node holding each line
+    std::vector<uint64_t> hashes; // hash of each line
+
+    void add(const char *data, size_t size);
+    void add(const Node *node);
+    int size() const { return (int) hashes.size(); }
+};
+
+class LineDiff {
+
+private:
+    const uint64_t *a; // old sequence
+    const uint64_t *b; // new sequence
+    std::vector<int> forward; // furthest reaching x per diagonal, forward search
+    std::vector<int> backward; // furthest reaching x per diagonal, backward search
+    int diagonalOffset;
+    int tooExpensive; // edit cost after which the middle snake search settles for a good split
+    std::vector<char> deleted; // lines of a that are not in b
+    std::vector<char> inserted; // lines of b that are not in a
+    std::vector<DiffChange> changeList;
+
+    void compareSequences(int xOffset, int xLimit, int yOffset, int yLimit);
+    void middleSnake(int xOffset, int xLimit, int yOffset, int yLimit, int *xMid, int *yMid);
+
+public:
+    LineDiff(const std::vector<uint64_t> &oldHashes, const std::vector<uint64_t> &newHashes);
+
+    const std::vector<DiffChange> &changes() const { return changeList; }
+
+    void writeUnified(std::string &output, const DiffLines &oldLines, const DiffLines &newLines,
+                      const std::string &oldLabel, const std::string &newLabel, int context = 3) const;
+};
+
+#endif //SPARQ_DIFF_H
@@ -15,20 +15,43 @@
  */
 
 #include "Editor.h"
+#include "MappedFile.h"
+#include "ExternalSort.h"
+#include "LineHash.h"
+#include "CompressedFile.h"
+
+#include <cstring>
 
 /**
  * Constructor
  */
-Editor::Editor() : currentLineNumber(0) {}
+Editor::Editor() : currentLineNumber(0), stopLoading(false) {}
 
 /**
  * Destructor
  */
-Editor::~Editor() {}
+Editor::~Editor() {
+    stopBackground();
+}
+
+/**
+ * Summary: Stops the background loader and the follower if they're still running, and waits for an
+ * autosave that is being written.
+ */
+void Editor::stopBackground() {
+    stopLoading = true;
+    stopFollowing();
+    if (loader.joinable()) {
+        loader.join();
+    }
+    if (autosaving) {
+        autosaving->wait();
+    }
+} // end stopBackground method
 
 /**
  * Summary: Checks input string for a command as enum using regex.
- * For use in switch case statement that takes [E, L, L n, L n m, D, D n, D n m, I, I n] as commands.
+ * For use in switch case statement that takes [E, L, L n, L n m, D, D n, D n m, I, I n, DIFF, DIFF file, SORT, SORT n m, UNIQ, UNIQ n m, DEDUP, DEDUP n m, RELOAD, STATS, TRACE, TRACE file] as commands.
  *
  * Adapted from: https://stackoverflow.com/questions/650162/why-the-switch-statement-cannot-be-applied-on-strings
  * @param const string &input
@@ -39,17 +62,33 @@ command Editor::checkCommand(const std::string &input) {
     // If the command is E, return right away.
     if (input == "E") return cmdE;
 
-    // Else define regex expression for each command
-    std::regex listExpr("[L]"); // Just an L
-    std::regex listNumExpr("[L][\\s][0-9]+"); // L followed by whitespace followed by any number of digits
-    std::regex listNumMExpr("[L][\\s][0-9]+[\\s][0-9]+"); // L -> space -> any num of digits -> space -> any num of digits
+    // Else define regex expression for each command (compiled once, commands are checked for every line)
+    static const std::regex listExpr("[L]"); // Just an L
+    static const std::regex listNumExpr("[L][\\s][0-9]+"); // L followed by whitespace followed by any number of digits
+    static const std::regex listNumMExpr("[L][\\s][0-9]+[\\s][0-9]+"); // L -> space -> any num of digits -> space -> any num of digits
+
+    static const std::regex deleteExpr("[D]");
+    static const std::regex deleteNumExpr("[D][\\s][0-9]+");
+    static const std::regex deleteNumMExpr("[D][\\s][0-9]+[\\s][0-9]+");
 
-    std::regex deleteExpr("[D]");
-    std::regex deleteNumExpr("[D][\\s][0-9]+");
-    std::regex deleteNumMExpr("[D][\\s][0-9]+[\\s][0-9]+");
+    static const std::regex insertExpr("[I]");
+    static const std::regex insertNumExpr("[I][\\s][0-9]+");
 
-    std::regex insertExpr("[I]");
-    std::regex insertNumExpr("[I][\\s][0-9]+");
+    static const std::regex diffExpr("DIFF"); // DIFF against the file being edited
+    static const std::regex diffFileExpr("DIFF[\\s].+"); // DIFF -> space -> snapshot filename
+
+    static const std::regex sortExpr("SORT([\\s][NR]+)?"); // SORT -> optional flags N (numeric) and R (reverse)
+    static const std::regex sortNumMExpr("SORT[\\s][0-9]+[\\s][0-9]+([\\s][NR]+)?"); // SORT n m -> optional flags
+
+    static const std::regex uniqExpr("UNIQ");
+    static const std::regex uniqNumMExpr("UNIQ[\\s][0-9]+[\\s][0-9]+");
+    static const std::regex dedupExpr("DEDUP");
+    static const std::regex dedupNumMExpr("DEDUP[\\s][0-9]+[\\s][0-9]+");
+
+    static const std::regex reloadExpr("RELOAD"); // RELOAD changes another program made to the file
+    static const std::regex statsExpr("STATS"); // STATS prints how long commands have taken
+    static const std::regex traceExpr("TRACE"); // TRACE turns tracing on or off
+    static const std::regex traceFileExpr("TRACE[\\s].+"); // TRACE -> space -> file to write the trace to
 
     // Return corresponding enum for the expression
     if (regex_match(input, listExpr)) return cmdL;
@@ -60,15 +99,60 @@ command Editor::checkCommand(const std::string &input) {
     if (regex_match(input, insertNumExpr)) return cmdIn;
     if (regex_match(input, listNumMExpr)) return cmdLnm;
     if (regex_match(input, deleteNumMExpr)) return cmdDnm;
+    if (regex_match(input, diffExpr)) return cmdDIFF;
+    if (regex_match(input, diffFileExpr)) return cmdDIFFfile;
+    if (regex_match(input, sortExpr)) return cmdSORT;
+    if (regex_match(input, sortNumMExpr)) return cmdSORTnm;
+    if (regex_match(input, uniqExpr)) return cmdUNIQ;
+    if (regex_match(input, uniqNumMExpr)) return cmdUNIQnm;
+    if (regex_match(input, dedupExpr)) return cmdDEDUP;
+    if (regex_match(input, dedupNumMExpr)) return cmdDEDUPnm;
+    if (regex_match(input, reloadExpr)) return cmdRELOAD;
+    if (regex_match(input, statsExpr)) return cmdSTATS;
+    if (regex_match(input, traceExpr)) return cmdTRACE;
+    if (regex_match(input, traceFileExpr)) return cmdTRACEfile;
 
     return cmdNone;
 } // end checkCommand method
 
+/**
+ * Summary: Names a command the way it's typed, for the stats and the trace.
+ *
+ * @param command entered
+ * @return name, like L n m
+ */
+const char* Editor::commandName(command entered) {
+
+    static const char* const names[] = {"L", "L n", "L n m", "D", "D n", "D n m", "I", "I n", "E", "DIFF",
+                                        "DIFF file", "SORT", "SORT n m", "UNIQ", "UNIQ n m", "DEDUP",
+                                        "DEDUP n m", "RELOAD", "STATS", "TRACE", "TRACE file", "text"};
+    return names[entered];
+} // end commandName method
+
+/**
+ * Summary: The histogram a command's latency goes in, looked up once for each command.
+ *
+ * @param command entered
+ * @return histogram
+ */
+static LatencyHistogram &commandStats(command entered) {
+
+    static LatencyHistogram* histograms[cmdNone + 1] = {};
+    static std::once_flag lookedUp;
+    std::call_once(lookedUp, []() {
+        for (int i = 0; i <= cmdNone; ++i) {
+            histograms[i] = &Stats::shared().histogram(Editor::commandName((command) i));
+        }
+    });
+    return *histograms[entered];
+} // end commandStats function
+
 /**
  * Summary: Checks the input string for a command.
- * [L, L n, L n m, D, D n, D n m, I, I n] as commands.
+ * [L, L n, L n m, D, D n, D n m, I, I n, DIFF, DIFF file, SORT, SORT n m, UNIQ, UNIQ n m, DEDUP, DEDUP n m, RELOAD, STATS, TRACE, TRACE file] as commands.
  *
- * Parses the command then calls the corresponding function.
+ * Parses the command then calls the corresponding function. Each command is timed from here,
+ * including any wait for the file to load, for the stats and the trace.
  *
  * @param const string &input
  * @param int *currentLineNumber
@@ -82,59 +166,146 @@ bool Editor::textCommandEntered(const std::string &input, int *currentLineNumber
     // Adapted from: https://www.geeksforgeeks.org/split-a-sentence-into-words-in-cpp/
     std::istringstream ss(input);
     std::string cmd;
+    std::string flags;
     int n = 0;
     int m = 0;
 
-    // Check if the input is a command, parse the command, call the corresponding function.
-    switch (checkCommand(input)) {
-        case cmdL:
-
-            // Call the List command
-            cmdList(list);
-
-            return true;
-
-        case cmdLn:
-
-            // Retrieve the command and the number(s) from the string stream
-            ss >> cmd;
-            ss >> n;
-
-            // Call the corresponding function
-            cmdList(n, list);
+    // Parsing counts too, the histogram and the span are named once it's known what the command is
+    StatsTimer timer;
+    TraceSpan span("command");
+    command entered;
+    {
+        TraceSpan parse("parse command");
+        entered = checkCommand(input);
+    }
+    if (entered != cmdNone) {
+        timer.recordTo(&commandStats(entered));
+        span.rename(commandName(entered));
+    } else {
+        span.rename(nullptr); // text, addDataToList has a span of its own
+    }
 
-            return true;
+    // Commands run with the list locked. L n and L n m only wait for the lines they list, STATS and
+    // TRACE don't look at the list, everything else needs the whole file loaded.
+    std::unique_lock<std::mutex> guard(listLock);
+    if (entered != cmdLn && entered != cmdLnm && entered != cmdSTATS && entered != cmdTRACE && entered != cmdTRACEfile) {
+        waitForLines(guard, INT_MAX);
+    }
 
-        case cmdLnm:
-            ss >> cmd;
-            ss >> n;
-            ss >> m;
-            cmdList(n, m, list);
-            return true;
-        case cmdD:
-            cmdDelete(currentLineNumber, list);
-            return true;
-        case cmdDn:
-            ss >> cmd;
-            ss >> n;
-            cmdDelete(n, currentLineNumber, list);
-            return true;
-        case cmdDnm:
-            ss >> cmd;
-            ss >> n;
-            ss >> m;
-            cmdDelete(n, m, currentLineNumber, list);
-            return true;
-        case cmdI:
-            cmdInsert(currentLineNumber, list, isInsert);
-            return true;
-        case cmdIn:
-            ss >> cmd;
-            ss >> n;
-            cmdInsert(n, currentLineNumber, list, isInsert);
-            return true;
-        default:
-            return false; // Input is not a valid command
+    // Lines read back from the block store can fail (swap file gone, block corrupted), the command
+    // is abandoned but the session and its edits are kept
+    try {
+        // Check if the input is a command, parse the command, call the corresponding function.
+        switch (entered) {
+            case cmdL:
+
+                // Call the List command
+                cmdList(list);
+
+                return true;
+
+            case cmdLn:
+
+                // Retrieve the command and the number(s) from the string stream
+                ss >> cmd;
+                ss >> n;
+                waitForLines(guard, n);
+
+                // Call the corresponding function
+                cmdList(n, list);
+
+                return true;
+
+            case cmdLnm:
+                ss >> cmd;
+                ss >> n;
+                ss >> m;
+                waitForLines(guard, m);
+                cmdList(n, m, list);
+                return true;
+            case cmdD:
+                cmdDelete(currentLineNumber, list);
+                return true;
+            case cmdDn:
+                ss >> cmd;
+                ss >> n;
+                cmdDelete(n, currentLineNumber, list);
+                return true;
+            case cmdDnm:
+                ss >> cmd;
+                ss >> n;
+                ss >> m;
+                cmdDelete(n, m, currentLineNumber, list);
+                return true;
+            case cmdI:
+                cmdInsert(currentLineNumber, list, isInsert);
+                return true;
+            case cmdIn:
+                ss >> cmd;
+                ss >> n;
+                cmdInsert(n, currentLineNumber, list, isInsert);
+                return true;
+            case cmdDIFF:
+                cmdDiff(myFileName, list);
+                return true;
+            case cmdDIFFfile:
+                // Everything after the command and the space is the snapshot filename
+                cmdDiff(input.substr(5), list);
+                return true;
+            case cmdSORT:
+                ss >> cmd;
+                ss >> flags;
+                cmdSort(1, list->getLineCount(), flags, list);
+                return true;
+            case cmdSORTnm:
+                ss >> cmd;
+                ss >> n;
+                ss >> m;
+                ss >> flags;
+                cmdSort(n, m, flags, list);
+                return true;
+            case cmdUNIQ:
+                cmdUnique(1, list->getLineCount(), true, currentLineNumber, list);
+                return true;
+            case cmdUNIQnm:
+                ss >> cmd;
+                ss >> n;
+                ss >> m;
+                cmdUnique(n, m, true, currentLineNumber, list);
+                return true;
+            case cmdDEDUP:
+                cmdUnique(1, list->getLineCount(), false, currentLineNumber, list);
+                return true;
+            case cmdDEDUPnm:
+                ss >> cmd;
+                ss >> n;
+                ss >> m;
+                cmdUnique(n, m, false, currentLineNumber, list);
+                return true;
+            case cmdRELOAD:
+                cmdReload(currentLineNumber, list);
+                return true;
+            case cmdSTATS:
+                Stats::shared().report(*out);
+                return true;
+            case cmdTRACE:
+                cmdTrace("");
+                return true;
+            case cmdTRACEfile:
+                // Everything after the command and the space is the filename
+                cmdTrace(input.substr(6));
+                return true;
+            default:
+                return false; // Input is not a valid command
+        }
+    }
+    catch (SwapFileException &e) {
+        *out << e.what() << " The command was not completed." << std::endl;
+        return true;
+    }
+    catch (CorruptBlockException &e) {
+        *out << e.what() << " The command was not completed." << std::endl;
+        return true;
     }
 } // end textCommandEntered method
 
@@ -154,6 +325,17 @@ bool Editor::exitCommandEntered(const std::string &input, const std::string &fil
     // If the command entered matched the E enum
     if (checkCommand(input) == cmdE) {
 
+        // Timed with the wait for loading and the save
+        StatsTimer timer(&commandStats(cmdE));
+        TraceSpan span("E");
+
+        // Nothing more is appended once the save starts
+        stopFollowing();
+
+        // Everything has to be loaded before it's saved
+        std::unique_lock<std::mutex> guard(listLock);
+        waitForLines(guard, INT_MAX);
+
         // Run the save and exit function
         cmdExit(filename, list);
 
@@ -166,7 +348,8 @@ bool Editor::exitCommandEntered(const std::string &input, const std::string &fil
  * Summary: This function implements the save & exit command.
  * Result of switch case statement for [E] command.
  *
- * Prompts user to provide a valid filename if no filename exists.
+ * Prompts user to provide a valid filename if no filename exists, or if only part of the file
+ * was loaded and saving over it would lose the rest. Nothing is saved if the input ends first.
  *
  * Calls the saveWriteFile() function.
  *
@@ -174,13 +357,26 @@ bool Editor::exitCommandEntered(const std::string &input, const std::string &fil
  * @param LinkedList *list
  */
 void Editor::cmdExit(std::string filename, LinkedList *list) {
+    TraceSpan span("cmdExit");
+
+    // Saving part of the file over the whole of it would lose the rest
+    bool keepOriginal = loadIncomplete && !myFileName.empty();
+    if (keepOriginal && filename == myFileName) {
+        *out << myFileName << " wasn't loaded in full, it won't be saved over." << std::endl;
+        filename = "";
+    }
 
     // If the filename is currently empty
     if (filename.empty()) {
         // Validate user input to accept valid windows filenames
         do {
-            std::cout << "Enter filename: ";
-            getline(std::cin, filename);
+            *out << "Enter filename: ";
+            if (!getline(*in, filename)) {
+                // Nobody to answer, nothing is saved
+                *out << std::endl << "Not saved." << std::endl;
+                saved = false;
+                return;
+            }
 
             // Check if there is no '.' in the filename
             if ((count(filename.begin(), filename.end(), '.') == 0)) {
@@ -189,18 +385,28 @@ void Editor::cmdExit(std::string filename, LinkedList *list) {
                 filename += DefaultFileExt;
             }
 
+            if (keepOriginal && filename == myFileName) {
+                *out << myFileName << " wasn't loaded in full, choose another filename." << std::endl;
+                filename = "";
+                continue;
+            }
+
             // If filename exists, ask to overwrite
             if (isFileExists(filename)) {
 
                 // Declare variable to hold user input
                 std::string overwriteFlag;
 
-                std::cout << "\nFile: " << filename << " already exists." << std::endl;
+                *out << "\nFile: " << filename << " already exists." << std::endl;
 
                 // Get user input, end when Y or N is entered.
                 do {
-                    std::cout << "Would you like to overwrite it? (Y/N) ";
-                    getline(std::cin, overwriteFlag);
+                    *out << "Would you like to overwrite it? (Y/N) ";
+                    if (!getline(*in, overwriteFlag)) {
+                        *out << std::endl << "Not saved." << std::endl;
+                        saved = false;
+                        return;
+                    }
                 } while (overwriteFlag.find('Y') == std::string::npos && overwriteFlag.find('N') == std::string::npos);
 
                 // Reset the filename to blank if the user does not choose Y to overwrite
@@ -222,15 +428,21 @@ void Editor::cmdExit(std::string filename, LinkedList *list) {
  * @param LinkedList *list
  */
 void Editor::cmdList(LinkedList *list) {
+    TraceSpan span("cmdList");
     //cout << "Reached cmdList(list)" << endl; // TEST
 
+    uint64_t bytes = 0;
+
     // Loop through the entire list
     for (LinkedList::iterator i = list->begin(); i != list->end(); ++i) {
 
         // Print out each node of the list
-        std::cout << i.node->index << "> "; // Line number
-        std::cout << *i << std::endl; // String data in the node
+        *out << i.node->index << "> "; // Line number
+        *out << *i << std::endl; // String data in the node
+        bytes += (*i).size();
     }
+
+    Stats::touched((uint64_t) list->getLineCount(), bytes);
 } // end cmdList method
 
 /**
@@ -241,6 +453,7 @@ void Editor::cmdList(LinkedList *list) {
  * @param LinkedList *list
  */
 void Editor::cmdList(int n, LinkedList *list) {
+    TraceSpan span("cmdList");
     //cout << "Reached cmdList(n, list)" << endl; // TEST
     //cout << "n = " << n << endl; // TEST
 
@@ -255,8 +468,9 @@ void Editor::cmdList(int n, LinkedList *list) {
 
             // Print the line if the index matches the line number
             if (n == i.node->index) {
-                std::cout << i.node->index << "> "; // Line number
-                std::cout << *i << std::endl; // String data in the node
+                *out << i.node->index << "> "; // Line number
+                *out << *i << std::endl; // String data in the node
+                Stats::touched(1, (*i).size());
             }
         }
     }
@@ -271,6 +485,7 @@ void Editor::cmdList(int n, LinkedList *list) {
  * @param LinkedList *list
  */
 void Editor::cmdList(int n, int m, LinkedList *list) {
+    TraceSpan span("cmdList");
     //cout << "Reached cmdList(n, m, list)" << endl; // TEST
     //cout << "n = " << n << " m = " << m << endl; // TEST
 
@@ -289,15 +504,20 @@ void Editor::cmdList(int n, int m, LinkedList *list) {
             // Set the m value to the end of the list if it's currently out of bounds
             if (m > lineCount) { m = lineCount; }
 
+            uint64_t bytes = 0;
+
             // Loop through the list
             for (LinkedList::iterator i = list->begin(); i != list->end(); ++i) {
 
                 // Print the line if the index is between the specified line numbers
                 if (i.node->index >= n && i.node->index <= m) {
-                    std::cout << i.node->index << "> ";
-                    std::cout << *i << std::endl;
+                    *out << i.node->index << "> ";
+                    *out << *i << std::endl;
+                    bytes += (*i).size();
                 }
             }
+
+            Stats::touched((uint64_t) (m - n + 1), bytes);
         }
     }
 } // end cmdList method
@@ -310,6 +530,7 @@ void Editor::cmdList(int n, int m, LinkedList *list) {
  * @param LinkedList *list
  */
 void Editor::cmdDelete(int *currentLineNumber, LinkedList *list) {
+    TraceSpan span("cmdDelete");
     //cout << "Reached cmdDelete(list)" << endl; // TEST
 
     // Don't allow delete at line 1 (no nodes present)
@@ -322,6 +543,7 @@ void Editor::cmdDelete(int *currentLineNumber, LinkedList *list) {
 
         // Delete the final node in the chain
         list->Delete(lineToDelete);
+        Stats::touched(1, 0);
 
         // Set the current line to what was the end of the chain
         *currentLineNumber = lineToDelete;
@@ -337,6 +559,7 @@ void Editor::cmdDelete(int *currentLineNumber, LinkedList *list) {
  * @param LinkedList *list
  */
 void Editor::cmdDelete(int n, int *currentLineNumber, LinkedList *list) {
+    TraceSpan span("cmdDelete");
     //cout << "Reached cmdDelete(n, list)" << endl; // TEST
     //cout << "n = " << n << endl; // TEST
     //cout << "Line to delete: " << n << endl; // TEST
@@ -349,6 +572,7 @@ void Editor::cmdDelete(int n, int *currentLineNumber, LinkedList *list) {
 
         // Delete the node that matches the command index
         list->Delete(n);
+        Stats::touched(1, 0);
 
         // Reorder the indexes
         list->reorderIndexes();
@@ -371,6 +595,7 @@ void Editor::cmdDelete(int n, int *currentLineNumber, LinkedList *list) {
  * @param LinkedList *list
  */
 void Editor::cmdDelete(int n, int m, int *currentLineNumber, LinkedList *list) {
+    TraceSpan span("cmdDelete");
     //cout << "Reached cmdDelete(n, m, list)" << endl; // TEST
     //cout << "n = " << n << " m = " << m << endl; // TEST
     //cout << "Lines to delete: " << n << " to "<< m << endl; // TEST
@@ -404,6 +629,7 @@ void Editor::cmdDelete(int n, int m, int *currentLineNumber, LinkedList *list) {
 
             // Reorder the indexes
             list->reorderIndexes();
+            Stats::touched((uint64_t) (m - n + 1), 0);
 
             // Reset the current line number
             *currentLineNumber = lineCount + 1;
@@ -420,6 +646,7 @@ void Editor::cmdDelete(int n, int m, int *currentLineNumber, LinkedList *list) {
  * @param bool *isInsert
  */
 void Editor::cmdInsert(int *currentLineNumber, LinkedList *list, bool *isInsert) {
+    TraceSpan span("cmdInsert");
     //cout << "Reached cmdInsert(list)" << endl; // TEST
 
     // Get the line count before the loop runs
@@ -458,6 +685,7 @@ void Editor::cmdInsert(int *currentLineNumber, LinkedList *list, bool *isInsert)
  * @param bool *isInsert
  */
 void Editor::cmdInsert(int n, int *currentLineNumber, LinkedList *list, bool *isInsert) {
+    TraceSpan span("cmdInsert");
     //cout << "Reached cmdInsert(n, list)" << endl; // TEST
     //cout << "n = " << n << endl; // TEST
 
@@ -490,6 +718,15 @@ void Editor::cmdInsert(int n, int *currentLineNumber, LinkedList *list, bool *is
  */
 void Editor::addDataToList(const std::string &userInputString, int *currentLineNumber, LinkedList *list, bool *isInsert) {
 
+    static LatencyHistogram &textStats = commandStats(cmdNone);
+    StatsTimer timer(&textStats);
+    TraceSpan span("addDataToList");
+    Stats::touched(1, userInputString.size());
+
+    // New lines go after the end of the file, so it has to be fully loaded
+    std::unique_lock<std::mutex> guard(listLock);
+    waitForLines(guard, INT_MAX);
+
     // If the function was called without insert flag
     if (!(*isInsert)) {
 
@@ -518,9 +755,386 @@ void Editor::addDataToList(const std::string &userInputString, int *currentLineN
     }
 } // end addDataToList method
 
+/**
+ * Summary: This function implements the diff command.
+ * Result of switch case statement for [DIFF] and [DIFF file] commands.
+ *
+ * Compares the file on disk (old) with the lines in the list (new) and prints a unified diff.
+ * Each line is hashed first so the diff itself only compares 64 bit numbers.
+ *
+ * @param const string &filename
+ * @param LinkedList *list
+ */
+void Editor::cmdDiff(const std::string &filename, LinkedList *list) {
+    TraceSpan span("cmdDiff");
+
+    std::deque<std::string> fileLines; // whole file, the diff points into it
+    DiffLines oldLines;
+    DiffLines newLines;
+
+    // A file that doesn't exist yet diffs as empty
+    if (!filename.empty() && isFileExists(filename)) {
+        // Read the same way populateListFromFile does, so a compressed file is compared by its text
+        try {
+            std::unique_ptr<LineSource> reader = LineSource::open(filename);
+            fileLines.emplace_back();
+            while (reader->next(fileLines.back())) {
+                oldLines.add(fileLines.back().data(), fileLines.back().size());
+                fileLines.emplace_back();
+            }
+        }
+        catch (FileFailedToOpenException &e) {
+            *out << e.what() << std::endl;
+            return;
+        }
+        catch (FormatUnavailableException &e) {
+            *out << e.what() << std::endl;
+            return;
+        }
+        catch (IoException &e) {
+            *out << e.what() << std::endl;
+            return;
+        }
+    }
+
+    // Hash the lines of the list
+    for (LinkedList::iterator i = list->begin(); i != list->end(); ++i) {
+        newLines.add(i.node);
+    }
+
+    LineDiff diff(oldLines.hashes, newLines.hashes);
+    Stats::touched(oldLines.hashes.size() + newLines.hashes.size(), 0);
+
+    if (diff.changes().empty()) {
+        *out << "No differences." << std::endl;
+        return;
+    }
+
+    // Build the whole diff in one buffer and write it out at once
+    std::string output;
+    std::string label = filename.empty() ? "(new file)" : filename;
+    diff.writeUnified(output, oldLines, newLines, label, label + " (buffer)");
+
+    out->write(output.data(), (std::streamsize) output.size());
+    out->flush();
+    Stats::touched(0, output.size());
+} // end cmdDiff method
+
+/**
+ * Summary: Checks a size against the memory limit of the list's block store.
+ *
+ * @param LinkedList *list
+ * @param uint64_t bytes
+ * @return true if there is a limit and bytes is more than it
+ */
+static bool isOverBudget(LinkedList *list, uint64_t bytes) {
+    BlockStore* store = list->getStore();
+    return store != nullptr && store->memoryBudget() > 0 && bytes > store->memoryBudget();
+} // end isOverBudget function
+
+/**
+ * Summary: This function implements the reload command.
+ * Result of switch case statement for [RELOAD] command.
+ *
+ * Brings in the changes another program made to the file since it was loaded. The snapshot taken at
+ * load time finds the changed region of the file, only those lines are split and diffed against
+ * what was loaded. Lines edited here since then are found by diffing the list with the snapshot.
+ * A change in the file is patched into the list unless it touches lines edited here, then the lines
+ * here are kept and the conflict reported.
+ *
+ * @param int *currentLineNumber
+ * @param LinkedList *list
+ */
+void Editor::cmdReload(int *currentLineNumber, LinkedList *list) {
+    TraceSpan span("cmdReload");
+
+    if (myFileName.empty() || list != &this->list) {
+        *out << "There is no file to reload." << std::endl;
+        return;
+    }
+
+    if (follower.joinable()) {
+        *out << "Follow mode already keeps up with the file." << std::endl;
+        return;
+    }
+
+    if (!isFileExists(myFileName)) {
+        *out << "File " << myFileName << " no longer exists." << std::endl;
+        return;
+    }
+
+    if (snapshot == nullptr) {
+        if (isOverBudget(list, loadedBytes)) {
+            *out << "The file is bigger than the memory limit, it can't be compared in memory." << std::endl;
+            return;
+        }
+        *out << "The file wasn't loaded from disk in full, there is nothing to compare it with." << std::endl;
+        return;
+    }
+
+    try {
+        MappedFile file(myFileName);
+
+        if (snapshot->isSameFile(file)) {
+            *out << "File has not changed." << std::endl;
+            return;
+        }
+
+        // The file's version of the changed lines, split the same way populateListFromFile does
+        ChangedRegion region = snapshot->changedRegion(file);
+        DiffLines fileLines;
+        const char* text = file.data();
+        uint64_t lineStart = region.start;
+        const char* newline;
+        while ((newline = (const char*) std::memchr(text + lineStart, '\n', region.end - lineStart)) != nullptr) {
+            size_t length = (size_t) (newline - text - lineStart);
+#ifdef _WIN32
+            if (length > 0 && text[lineStart + length - 1] == '\r') { length--; }
+#endif
+            fileLines.add(text + lineStart, length);
+            lineStart = (uint64_t) (newline - text) + 1;
+        }
+        fileLines.add(text + lineStart, (size_t) (region.end - lineStart));
+
+        const std::vector<uint64_t> &loaded = snapshot->lineHashes;
+        std::vector<uint64_t> loadedRegion(loaded.begin() + region.firstLine, loaded.end() - region.unchangedTail);
+        LineDiff theirs(loadedRegion, fileLines.hashes);
+
+        // What was edited here since the file was loaded
+        std::vector<uint64_t> listHashes;
+        for (LinkedList::iterator i = list->begin(); i != list->end(); ++i) {
+            listHashes.push_back(hashLine(*i));
+        }
+        LineDiff ours(loaded, listHashes);
+
+        bool atEnd = *currentLineNumber == (int) listHashes.size() + 1;
+
+        std::vector<LinePatch> patches;
+        const std::vector<DiffChange> &edits = ours.changes();
+        size_t edit = 0;
+        int shift = 0; // where a loaded line is in the list now, minus where it was
+        int changedLines = 0;
+
+        for (const DiffChange &change : theirs.changes()) {
+            int oldStart = change.oldStart + region.firstLine;
+            int oldEnd = change.oldEnd + region.firstLine;
+
+            // Edits here that end before this change only move it
+            while (edit < edits.size() && edits[edit].oldEnd < oldStart) {
+                shift += (edits[edit].newEnd - edits[edit].newStart) - (edits[edit].oldEnd - edits[edit].oldStart);
+                edit++;
+            }
+
+            // One that overlaps or touches it is a conflict, the lines here win
+            if (edit < edits.size() && edits[edit].oldStart <= oldEnd) {
+                int first = edits[edit].newStart + 1;
+                int last = std::max(first, edits[edit].newEnd);
+                if (first == last) {
+                    *out << "Line " << first << " was changed here and in the file, kept the line here." << std::endl;
+                } else {
+                    *out << "Lines " << first << " to " << last
+                         << " were changed here and in the file, kept the lines here." << std::endl;
+                }
+                continue;
+            }
+
+            LinePatch patch;
+            patch.first = oldStart + shift + 1;
+            patch.count = oldEnd - oldStart;
+            for (int i = change.newStart; i < change.newEnd; i++) {
+                patch.lines.emplace_back(fileLines.text[i], fileLines.length[i]);
+            }
+            changedLines += std::max(patch.count, (int) patch.lines.size());
+            patches.push_back(std::move(patch));
+        }
+
+        list->applyPatches(patches);
+        Stats::touched((uint64_t) changedLines, region.end - region.start);
+
+        // The file as it is now is what later reloads compare with
+        snapshot.reset(new FileSnapshot(FileSnapshot::takeSnapshot(file)));
+
+        int lineCount = list->last() != nullptr ? list->last()->index : 0;
+        if (atEnd || *currentLineNumber > lineCount + 1) {
+            *currentLineNumber = lineCount + 1;
+        }
+
+        *out << "Reloaded " << myFileName << ", " << changedLines
+             << (changedLines == 1 ? " line" : " lines") << " changed." << std::endl;
+    }
+    catch (FileFailedToOpenException &e) {
+        *out << e.what() << std::endl;
+    }
+} // end cmdReload method
+
+/**
+ * Summary: This function implements the sort command.
+ * Result of switch case statement for [SORT] and [SORT n m] commands, each with optional flags
+ * N (numeric) and R (reverse). The sort is stable.
+ *
+ * The nodes are sorted as pointers and relinked in their new order, line data is never copied.
+ *
+ * @param int n
+ * @param int m
+ * @param const string &flags
+ * @param LinkedList *list
+ */
+void Editor::cmdSort(int n, int m, const std::string &flags, LinkedList *list) {
+    TraceSpan span("cmdSort");
+
+    // Only attempt the command if n is less than m
+    if (n < m) {
+
+        // Get the line count before the sort runs
+        int lineCount = list->getLineCount();
+
+        // If n is less than 1, set to 1
+        if (n < 1) { n = 1; }
+
+        // If n is within the bounds of the list
+        if (n >= 1 && n <= lineCount) {
+
+            // Set the m value to the end of the list if it's currently out of bounds
+            if (m > lineCount) { m = lineCount; }
+
+            SortOptions options = SortOptions::fromFlags(flags);
+            BlockStore* store = list->getStore();
+            Stats::touched((uint64_t) (m - n + 1), 0);
+
+            // Roughly how much text is being sorted, from the average line length
+            size_t rangeBytes = store != nullptr ? store->uncompressedSize() / lineCount * (m - n + 1) : 0;
+
+            if (store != nullptr && store->memoryBudget() > 0 && rangeBytes > store->memoryBudget() / 2) {
+
+                // Too big to sort in memory: sort through temporary files and store the sorted lines as new nodes
+                try {
+                    ExternalSort sorter(options, store->memoryBudget() / 2);
+                    std::vector<Node*> nodes;
+                    list->collectRange(n, m, nodes);
+                    for (Node* node : nodes) {
+                        sorter.add(std::string(node->line()));
+                    }
+                    nodes.clear();
+                    sorter.finish();
+
+                    list->replaceRange(n, m, [&sorter](std::string &line) { return sorter.next(line); });
+                    list->reorderIndexes();
+
+                    *out << "Sorted " << (m - n + 1) << " lines in " << sorter.runCount() << " runs." << std::endl;
+                }
+                catch (SortFileException &e) {
+                    *out << e.what() << std::endl;
+                }
+            } else {
+                std::vector<Node*> nodes;
+                list->collectRange(n, m, nodes);
+
+                sortLines(nodes, options);
+
+                // Put the nodes back in sorted order and renumber them
+                list->relinkRange(n, m, nodes);
+                list->reorderIndexes();
+            }
+        }
+    }
+} // end cmdSort method
+
+/**
+ * Summary: This function implements the unique and dedup commands.
+ * Result of switch case statement for [UNIQ], [UNIQ n m], [DEDUP] and [DEDUP n m] commands.
+ *
+ * UNIQ removes a line when it equals the line kept before it (adjacent duplicates).
+ * DEDUP removes every line already seen in the range, keeping the first one.
+ * Duplicates are unlinked in a single pass over the list and the indexes reordered once.
+ *
+ * @param int n
+ * @param int m
+ * @param bool adjacentOnly
+ * @param int *currentLineNumber
+ * @param LinkedList *list
+ */
+void Editor::cmdUnique(int n, int m, bool adjacentOnly, int *currentLineNumber, LinkedList *list) {
+    TraceSpan span("cmdUnique");
+
+    // Only attempt the command if n is less than m
+    if (n < m) {
+
+        // Get the line count before the command runs
+        int lineCount = list->getLineCount();
+
+        // If n is less than 1, set to 1
+        if (n < 1) { n = 1; }
+
+        // If n is within the bounds of the list
+        if (n >= 1 && n <= lineCount) {
+
+            // Set the m value to the end of the list if it's currently out of bounds
+            if (m > lineCount) { m = lineCount; }
+
+            int removed = 0;
+            Stats::touched((uint64_t) (m - n + 1), 0);
+
+            if (adjacentOnly) {
+                // Compare each line with the last line that was kept
+                Node *previous = nullptr;
+                removed = list->DeleteWhere(n, m, [&previous](Node *node) {
+                    if (previous != nullptr && previous->line() == node->line()) {
+                        return true;
+                    }
+                    previous = node;
+                    return false;
+                });
+            } else {
+                // Lines already seen are in the set, the set points at the kept nodes
+                LineHashSet seen((size_t) (m - n + 1));
+                removed = list->DeleteWhere(n, m, [&seen](Node *node) {
+                    return !seen.insert(node);
+                });
+            }
+
+            // Renumber the lines once and reset the current line to the end
+            list->reorderIndexes();
+            *currentLineNumber = lineCount - removed + 1;
+
+            *out << "Removed " << removed << " duplicate line(s)." << std::endl;
+        }
+    }
+} // end cmdUnique method
+
+/**
+ * Summary: This function implements the trace command.
+ * Result of switch case statement for [TRACE] and [TRACE file] commands.
+ *
+ * TRACE turns tracing on or off. TRACE file writes what has been traced so far to the file as
+ * Chrome trace JSON, tracing carries on.
+ *
+ * @param const string &filename empty for TRACE
+ */
+void Editor::cmdTrace(const std::string &filename) {
+
+    if (filename.empty()) {
+        if (Trace::isEnabled()) {
+            Trace::stop();
+            *out << "Tracing stopped, TRACE file writes what was traced." << std::endl;
+        } else {
+            Trace::start();
+            *out << "Tracing started." << std::endl;
+        }
+        return;
+    }
+
+    size_t events = 0;
+    if (!Trace::write(filename, events)) {
+        *out << "Unable to write the trace to " << filename << "." << std::endl;
+        return;
+    }
+    *out << "Wrote " << events << (events == 1 ? " event" : " events") << " to " << filename << "." << std::endl;
+} // end cmdTrace method
+
 /**
  * Summary: Takes in a filename as a string. Validates to see if the filename meets Windows file naming standards.
- * Will accept filenames with either none, or no more than one '.' indicating a file extension.
+ * Will accept filenames with either none, or no more than one '.' indicating a file extension,
+ * and a compressed file's .gz or .zst after that (app.log.gz).
  * Cited from: https://docs.microsoft.com/en-us/windows/win32/fileio/naming-a-file
  *
  * Possible Improvement: This function could instead use regex.
@@ -543,13 +1157,13 @@ bool Editor::isValidFileName(const std::string &filename) {
                (filename.find('\\') != std::string::npos) || (filename.find('|') != std::string::npos) ||
                (filename.find('?') != std::string::npos) || (filename.find('*') != std::string::npos) ||
                (filename.find('*') != std::string::npos) || (filename.find('"') != std::string::npos)) {
-        std::cout << "Filename cannot contain Windows reserved characters (<>:\"/\\|?*)" << std::endl;
+        *out << "Filename cannot contain Windows reserved characters (<>:\"/\\|?*)" << std::endl;
         return false;
 
-        // Check if the filename contains more than one '.'
-    } else if ((count(filename.begin(), filename.end(), '.') > 1)) {
+        // Check if the filename contains more than one '.', not counting a .gz or .zst on top of the extension
+    } else if ((count(filename.begin(), filename.end(), '.') > (formatForName(filename) != formatPlain ? 2 : 1))) {
 
-        std::cout << "Filename cannot contain more than one '.'" << std::endl;
+        *out << "Filename cannot contain more than one '.' (besides a .gz or .zst ending)" << std::endl;
         return false;
     }
 
@@ -582,80 +1196,135 @@ bool Editor::isFileExists(const std::string &filename) {
  * */
 void Editor::populateListFromFile(const std::string &filename, LinkedList *list) {
 
-    std::string thisLine; // used to store each line of the in file as it is looped through
+    std::vector<std::string> batch; // lines split from the file, added to the list a batch at a time
     int lineNumber = 0; // keep track of the line number
 
-    // Declare stream object
-    std::ifstream myFileIn;
+    // Reads ahead in large chunks while the lines are split, or decompresses a compressed file
+    std::unique_ptr<LineSource> reader;
+
+    // Timed once the file opens, a background load is recorded by the loader when it's done
+    static LatencyHistogram &loadStats = Stats::shared().histogram("load");
+    StatsTimer timer;
+    TraceSpan span("load");
+    loadStarted = std::chrono::steady_clock::now();
 
     // Check if the file exists
     if (isFileExists(filename)) {
 
         // Attempt to open files
         try {
-            // Connect file to stream object
-            myFileIn.open(filename);
+            // Connect file to the reader, print message if file fails to open
+            try {
+                TraceSpan open("open");
+                reader = LineSource::open(filename);
+                loadedBytes = reader->size();
+                loadedFormat = detectFormat(filename);
+                timer.recordTo(&loadStats);
+            }
+            catch (FileFailedToOpenException &e) {
+                *out << "File failed to open" << std::endl;
+                throw;
+            }
+            catch (FormatUnavailableException &e) {
+                // Nothing of the file is in the list, saving over it would empty it
+                *out << e.what() << std::endl;
+                markIncomplete(filename, list);
+                return;
+            }
 
-            // Print message if file fails / successfully opens
-            if (myFileIn.fail()) {
-                std::cout << "File failed to open" << std::endl;
-                throw FileFailedToOpenException();
-            } else {
-                //cout << "File '" << filename <<"' Open" << endl; // TEST
+            //cout << "File '" << filename <<"' Open" << endl; // TEST
 
-                // attempt to read file to the linked list
-                try {
-                    // Get in file contents line by line
-                    // If the file is not empty, add each line to a linked list
-                    while (!myFileIn.eof()) {
+            // attempt to read file to the linked list
+            try {
+                // Hand the rest of a big file to the background loader so the prompt shows right away
+                // (only into the editor's own list, that's the one commands lock)
+                bool stopEarly = loadInBackground && list == &this->list;
+
+                // Get in file contents a batch of lines at a time, split the batch then add it
+                // If the file is not empty, add each line to a linked list
+                while (!reader->eof() && !(stopEarly && lineNumber == InitialLines)) {
+
+                    size_t batchLines = stopEarly ? (size_t) std::min(LoaderBatch, InitialLines - lineNumber) : LoaderBatch;
+                    batch.clear();
+                    {
+                        TraceSpan split("split lines");
+                        while (batch.size() < batchLines && !reader->eof()) {
+                            batch.emplace_back();
+                            reader->next(batch.back());
+                        }
+                    }
 
+                    // Populate the Linked List line by line
+                    TraceSpan build("build list");
+                    for (std::string &line : batch) {
                         lineNumber++; // increment the line number before populating the linked list
-                        getline(myFileIn, thisLine);
-
-                        // Populate the Linked List line by line
-                        list->Add(lineNumber, thisLine);
+                        list->Add(lineNumber, std::move(line));
                     }
+                }
 
-                    //cout << "Linked List has been populated." << endl; // TEST
+                loadedLines = lineNumber;
 
-                }
-                catch (std::bad_exception &e) {
-                    std::cout << "An unexpected error occurred populating the list." << std::endl;
-                    std::cout << e.what() << std::endl;
-                }
-                catch (std::exception &e) {
-                    std::cout << "An error occurred populating the list." << std::endl;
-                    std::cout << e.what() << std::endl;
-                }
+                if (!reader->eof()) {
+                    *out << "Loaded the first " << lineNumber << " lines, loading the rest in the background."
+                         << std::endl;
 
-                try {
-                    // close file resources
-                    myFileIn.close();
+                    loading = true;
+                    loadPending = true;
+                    timer.recordTo(nullptr);
 
-                    if (myFileIn.is_open()) {
-                        throw FileFailedToCloseException();
+                    // The loader thread takes over the reader
+                    LineSource* remaining = reader.release();
+                    loader = std::thread([this, filename, list, lineNumber, remaining]() {
+                        Trace::nameThread("loader");
+                        std::unique_ptr<LineSource> owned(remaining);
+                        loadRemainingLines(*owned, lineNumber, filename, list);
+                    });
+                } else {
+                    //cout << "Linked List has been populated." << endl; // TEST
+                    Stats::touched((uint64_t) lineNumber, loadedBytes);
+
+                    // Report what interning or compression saved
+                    if (list->getStore() != nullptr) {
+                        list->getStore()->flush();
+                        reportStoreUsage(list->getStore());
+                    } else if (list->getPool() != nullptr) {
+                        reportPoolUsage(list->getPool());
                     }
 
-                    //cout << "File '" << filename <<"' Closed" << endl; // TEST
-
-                }
-                catch (FileFailedToCloseException &e) {
-                    std::cout << e.what() << std::endl;
-                }
-                catch (std::exception &e) {
-                    std::cout << "An error occurred closing the file." << std::endl;
-                    std::cout << e.what() << std::endl;
+                    // Remember what was loaded for RELOAD
+                    if (list == &this->list) {
+                        snapshot = takeSnapshot(filename);
+                    }
                 }
+
+            }
+            catch (IoException &e) {
+                *out << "An error occurred reading the file." << std::endl;
+                *out << e.what() << std::endl;
+                markIncomplete(filename, list);
+            }
+            catch (std::bad_exception &e) {
+                *out << "An unexpected error occurred populating the list." << std::endl;
+                *out << e.what() << std::endl;
+                markIncomplete(filename, list);
+            }
+            catch (std::exception &e) {
+                *out << "An error occurred populating the list." << std::endl;
+                *out << e.what() << std::endl;
+                markIncomplete(filename, list);
             }
         }
         catch (FileFailedToOpenException &e) {
-            std::cout << e.what() << std::endl;
+            *out << e.what() << std::endl;
+            markIncomplete(filename, list);
         }
         catch (std::system_error &e) {
-            std::cout << e.what() << std::endl;
+            *out << e.what() << std::endl;
+            markIncomplete(filename, list);
         }
         catch (std::exception &e) {
-            std::cout << e.what() << std::endl;
+            *out << e.what() << std::endl;
+            markIncomplete(filename, list);
         }
     } else {
         // cout << "File " << filename << " does not yet exist." << endl; // TEST
@@ -664,97 +1333,768 @@ void Editor::populateListFromFile(const std::string &filename, LinkedList *list)
 } // end populateListFromFile method
 
 /**
- * Summary: Writes the contents of the linked list to file.
+ * Summary: Runs on the loader thread. Reads the rest of the file in batches and appends each batch
+ * to the list under the list lock, waking up any command waiting for those lines.
  *
- * Outfile is overwritten and not appended.
+ * @param LineSource &reader positioned after the lines that are already loaded
+ * @param int lineNumber lines already loaded
+ * @param const string &filename
+ * @param LinkedList *list
+ */
+void Editor::loadRemainingLines(LineSource &reader, int lineNumber, const std::string &filename, LinkedList *list) {
+
+    std::vector<std::string> batch;
+    TraceSpan span("load");
+
+    while (!reader.eof() && !stopLoading) {
+
+        // Read a batch without holding the lock, so commands on loaded lines aren't held up by the disk
+        batch.clear();
+        try {
+            TraceSpan split("split lines");
+            while (batch.size() < (size_t) LoaderBatch && !reader.eof()) {
+                batch.emplace_back();
+                reader.next(batch.back());
+            }
+        }
+        catch (IoException &e) {
+            // Keep what was read, the rest of the file is lost
+            *out << "An error occurred reading the file." << std::endl;
+            stopLoading = true;
+            std::lock_guard<std::mutex> guard(listLock);
+            markIncomplete(filename, list);
+        }
+
+        std::lock_guard<std::mutex> guard(listLock);
+        TraceSpan build("build list");
+        for (std::string &line : batch) {
+            lineNumber++;
+            list->Add(lineNumber, std::move(line));
+        }
+        loadedLines = lineNumber;
+        linesLoaded.notify_all();
+    }
+
+    // Remember what was loaded for RELOAD, before any command can run it
+    std::unique_ptr<FileSnapshot> loadedSnapshot;
+    if (!stopLoading) {
+        loadedSnapshot = takeSnapshot(filename);
+
+        // The whole load, from when populateListFromFile opened the file
+        static LatencyHistogram &loadStats = Stats::shared().histogram("load");
+        auto elapsed = std::chrono::steady_clock::now() - loadStarted;
+        loadStats.record((uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                         (uint64_t) lineNumber, loadedBytes);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(listLock);
+        if (list->getStore() != nullptr) {
+            list->getStore()->flush();
+        }
+        snapshot = std::move(loadedSnapshot);
+        loading = false;
+        linesLoaded.notify_all();
+
+        if (onBackgroundUpdate) {
+            onBackgroundUpdate();
+        }
+    }
+} // end loadRemainingLines method
+
+/**
+ * Summary: Called when a load stops partway or can't start. The editor's list is left with part of
+ * the file or none of it, so E has to save it under another name.
  *
  * @param const string &filename
  * @param LinkedList *list
- * */
-void Editor::saveWriteFile(const std::string &filename, LinkedList *list) {
+ */
+void Editor::markIncomplete(const std::string &filename, LinkedList *list) {
+
+    if (list != &this->list) {
+        return;
+    }
+    loadIncomplete = true;
+    *out << filename << " wasn't loaded in full, E will ask for another filename to save to." << std::endl;
+} // end markIncomplete method
 
-    std::string thisLine; // used to store each line of the in file as it is looped through
+/**
+ * Summary: Waits until the background loader has loaded the first lines of the file, or all of it.
+ * The lock is released while waiting so the loader can keep appending.
+ *
+ * @param unique_lock<mutex> &guard holding listLock
+ * @param int lines line count needed, INT_MAX for the whole file
+ */
+void Editor::waitForLines(std::unique_lock<std::mutex> &guard, int lines) {
+    linesLoaded.wait(guard, [this, lines]() { return !loading || loadedLines >= lines; });
+    if (!loading && loadPending) {
+        finishLoading();
+    }
+} // end waitForLines method
 
-    // Declare stream object
-    std::ofstream myFileOut;
+/**
+ * Summary: Catches up with a background load that finished since the last command, without waiting for it.
+ */
+void Editor::pollLoading() {
+    std::unique_lock<std::mutex> guard(listLock);
+    waitForLines(guard, 0);
+} // end pollLoading method
+
+/**
+ * Summary: Called once a background load is done. Moves the current line to the end of the file
+ * and reports what interning or compression saved.
+ */
+void Editor::finishLoading() {
+
+    // Only L n and L n m run during a background load and neither moves the current line,
+    // so it's still the end of what was loaded at startup
+    loadPending = false;
+    currentLineNumber = loadedLines + 1;
+    autosavedVersion = list.getVersion(); // nothing to autosave until it's edited
+
+    // Report what interning or compression saved
+    if (list.getStore() != nullptr) {
+        list.getStore()->flush();
+        reportStoreUsage(list.getStore());
+    } else if (list.getPool() != nullptr) {
+        reportPoolUsage(list.getPool());
+    }
+} // end finishLoading method
+
+/**
+ * Summary: Starts follow mode. Once the file is loaded, a follower thread appends whatever is written
+ * to the end of the file, like tail -f.
+ *
+ * @param const string &filename
+ * @return false if the file can't be watched
+ */
+bool Editor::followFile(const std::string &filename) {
+
+    if (loadedFormat != formatPlain) {
+        *out << "Follow mode needs an uncompressed file." << std::endl;
+        return false;
+    }
 
-    // Attempt to open file
     try {
-        // Connect files to stream objects
-        // Will create a new file if the file doesn't currently exist
-        myFileOut.open(filename); // outfile
+        watcher.reset(new FileWatcher(filename));
+    }
+    catch (FileWatchException &e) {
+        *out << e.what() << std::endl;
+        return false;
+    }
 
-        // Print message if file fails / successfully opens
-        if (myFileOut.fail()) {
-            std::cout << "Output File failed to open" << std::endl;
-            throw FileFailedToOpenException();
-        } else {
-            //cout << "File '" << filename <<"' Open" << endl; // TEST
-            std::cout << "Writing... ";
+    // The file may have grown since it was opened for loading, reading picks up from there
+    uint64_t offset = loadedBytes;
+    follower = std::thread([this, filename, offset]() {
+        Trace::nameThread("follower");
+        followChanges(filename, offset);
+    });
+    return true;
+} // end followFile method
 
-            // Attempt to read/write to file
-            try {
-                // Variable to keep track of when the iterator has reached it's final iteration
-                int loopCount = 0;
-                int lineCount = list->getLineCount();
+/**
+ * Summary: Runs on the follower thread. Each time the file changes only the bytes past what was
+ * already read are read and appended. A file that got shorter was truncated, and a new file under the
+ * name (log rotation) replaces the old one. Either way the buffer is emptied and the file is read again
+ * from the start, so the buffer never holds lines of two different files and E saves the file as it is.
+ * A buffer with edits that aren't saved is never emptied, following stops instead.
+ *
+ * @param const string &filename
+ * @param uint64_t offset bytes already in the list
+ */
+void Editor::followChanges(const std::string &filename, uint64_t offset) {
+
+    // Appending starts after the background loader is done with the end of the list
+    {
+        std::unique_lock<std::mutex> guard(listLock);
+        linesLoaded.wait(guard, [this]() { return !loading; });
+        followedLast = list.last();
+        followedVersion = list.getVersion();
+    }
 
-                //For each node in the linked list using iterator, send to file out stream
-                for (LinkedList::iterator i = list->begin(); i != list->end(); ++i) {
+    std::vector<char> buffer(IoChunkSize);
+    std::ifstream input(filename, std::ios::binary);
+    bool continueLast = true; // the last line of the file may still be being written
+
+    // Starts the buffer over for a truncated or replaced file, false if it has edits to keep
+    auto restart = [&](const std::string &what) {
+        std::lock_guard<std::mutex> guard(listLock);
+        if (!clearFollowedLines()) {
+            followNotice = filename + " was " + what + ". The buffer has changes that aren't saved, it was kept and "
+                           + filename + " is no longer followed.";
+            return false;
+        }
+        followNotice = filename + " was " + what + ", loading it from the start.";
+        offset = 0;
+        continueLast = false;
+        return true;
+    };
 
-                    // Increment the loop counter
-                    loopCount++;
+    // False once following has to stop
+    auto readAppended = [&]() {
+        if (!input.is_open()) {
+            return true;
+        }
 
-                    // If the loop has not yet reached the end
-                    if (loopCount != lineCount) {
-                        myFileOut << *i << std::endl; // add a carriage return
-                    } else {
-                        myFileOut << *i; // on final line, don't add the carriage return
-                    }
-                }
+        input.clear();
+        input.seekg(0, std::ios::end);
+        std::streamoff size = input.tellg();
+        if (size < 0) {
+            return true;
+        }
 
-                std::cout << "Complete!" << std::endl;
+        if ((uint64_t) size < offset && !restart("truncated")) {
+            return false;
+        }
 
+        input.seekg((std::streamoff) offset);
+        while (offset < (uint64_t) size && !watcher->stopped()) {
+            input.read(buffer.data(), (std::streamsize) std::min<uint64_t>(buffer.size(), (uint64_t) size - offset));
+            size_t count = (size_t) input.gcount();
+            if (count == 0) {
+                break;
             }
-            catch (std::bad_exception &e) {
-                std::cout << "An unexpected error occurred writing to file." << std::endl;
-                std::cout << e.what() << std::endl;
-            }
-            catch (std::exception &e) {
-                std::cout << "An error occurred writing to file." << std::endl;
-                std::cout << e.what() << std::endl;
+            offset += count;
+            appendFollowedText(buffer.data(), count, continueLast);
+        }
+        return true;
+    };
+
+    // Lets an idle prompt report the new lines
+    auto report = [this]() {
+        std::lock_guard<std::mutex> guard(listLock);
+        if (onBackgroundUpdate) {
+            onBackgroundUpdate();
+        }
+    };
+
+    try {
+        while (true) {
+            bool following = readAppended();
+            report();
+            if (!following) {
+                break;
             }
 
-            try {
-                // Close file resources
-                myFileOut.close();
+            fileChange change = watcher->wait();
+            if (change == changeStopped) {
+                break;
+            }
 
-                if (myFileOut.is_open()) {
-                    throw FileFailedToCloseException();
+            if (change == changeReplaced) {
+                // The old file is gone from under the name, the buffer becomes the new file
+                if (!restart("replaced")) {
+                    report();
+                    break;
                 }
+                input.close();
+                input.clear();
+                input.open(filename, std::ios::binary);
+            }
+        }
+    }
+    catch (FileWatchException &e) {
+        {
+            std::lock_guard<std::mutex> guard(listLock);
+            followNotice = e.what() + " Stopped following " + filename + ".";
+        }
+        report();
+    }
+} // end followChanges method
+
+/**
+ * Summary: Empties the buffer when the followed file is truncated or replaced, the file is then read
+ * into it from the start. A buffer the user has changed since the follower last did is left alone.
+ * Called on the follower thread holding listLock.
+ *
+ * @return false if the buffer has edits of the user's and was kept
+ */
+bool Editor::clearFollowedLines() {
+
+    if (list.getVersion() != followedVersion) {
+        return false;
+    }
+
+    int lineCount = list.getLineCount();
+    if (lineCount > 0) {
+        list.DeleteWhere(1, lineCount, [](Node*) { return true; });
+    }
+    followedLast = nullptr;
+    followedLines = 0;
+    followedNodes = 0;
+    followedVersion = list.getVersion();
+    followRestarted = true;
+    return true;
+} // end clearFollowedLines method
+
+/**
+ * Summary: Appends text read from the end of the file. Everything before its first newline finishes
+ * the list's last line, every newline after that starts a new one, so the list ends up the same as
+ * loading the whole file would have made it.
+ *
+ * @param const char *text
+ * @param size_t length
+ * @param bool &continueLast false to start a new line first, after truncation or rotation
+ */
+void Editor::appendFollowedText(const char *text, size_t length, bool &continueLast) {
+
+    // Split before taking the lock
+    std::vector<std::string> pieces(1);
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '\n') {
+            pieces.emplace_back();
+        } else {
+            pieces.back().push_back(text[i]);
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(listLock);
+
+    uint64_t versionBefore = list.getVersion();
+    Node* last = list.last();
+
+    // Text only finishes the file's own last line, not a line typed after it
+    if (last != followedLast) {
+        continueLast = false;
+    }
+
+    // An empty last line is only the end of the old text after its final newline, the new text takes it over
+    if (!continueLast && last != nullptr && last == followedLast && last->line().empty()) {
+        continueLast = true;
+    }
+
+#ifdef _WIN32
+    // Lines finished by a newline lose the carriage return, like they do when the file is loaded
+    for (size_t i = 0; i + 1 < pieces.size(); i++) {
+        if (!pieces[i].empty() && pieces[i].back() == '\r') {
+            pieces[i].pop_back();
+        }
+    }
+#endif
+
+    size_t next = 0;
+    if (continueLast && last != nullptr) {
+        std::string line = last->line() + pieces[0];
+#ifdef _WIN32
+        if (pieces.size() > 1 && !line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+#endif
+        // Through the list, which copies the node if other threads may be reading it
+        list.setLine(last, std::move(line));
+        last = list.last();
+        next = 1;
+    }
+
+    int index = last != nullptr ? last->index : 0;
+    for (size_t i = next; i < pieces.size(); i++) {
+        list.Add(++index, std::move(pieces[i]));
+        followedNodes++;
+    }
+
+    followedLines += (int) pieces.size() - 1;
+    followedLast = list.last();
+    continueLast = true;
+
+    // Appending doesn't count as an edit of the user's, unless there were some before it
+    if (versionBefore == followedVersion) {
+        followedVersion = list.getVersion();
+    }
+} // end appendFollowedText method
+
+/**
+ * Summary: Reports what the follower appended since the last prompt. If the current line was the end
+ * of the file it moves to the new end, so typed lines still go after everything.
+ */
+void Editor::pollFollowing() {
+
+    std::lock_guard<std::mutex> guard(listLock);
+
+    if (!followNotice.empty()) {
+        *out << followNotice << std::endl;
+        followNotice.clear();
+    }
+
+    // The lines the current line was among are gone, it's the end of the new text
+    if (followRestarted) {
+        followRestarted = false;
+        isInsert = false;
+        currentLineNumber = (list.last() != nullptr ? list.last()->index : 0) + 1;
+        followedLines = 0;
+        followedNodes = 0;
+        return;
+    }
+
+    if (followedLines == 0 && followedNodes == 0) {
+        return;
+    }
+
+    if (followedLines > 0) {
+        *out << followedLines << (followedLines == 1 ? " new line" : " new lines") << " in "
+             << myFileName << "." << std::endl;
+    }
+
+    int lineCount = list.last() != nullptr ? list.last()->index : 0;
+    if (!isInsert && currentLineNumber == lineCount - followedNodes + 1) {
+        currentLineNumber = lineCount + 1;
+    }
 
-                //cout << "File '" << filename <<"' Closed" << endl; // TEST
+    followedLines = 0;
+    followedNodes = 0;
+} // end pollFollowing method
 
+/**
+ * Summary: Stops the follower thread, if follow mode is on.
+ */
+void Editor::stopFollowing() {
+
+    if (watcher) {
+        watcher->stop();
+    }
+    if (follower.joinable()) {
+        follower.join();
+    }
+} // end stopFollowing method
+
+/**
+ * Summary: Prints how much memory interning saved over one copy of each line per node.
+ *
+ * @param LinePool *pool
+ */
+void Editor::reportPoolUsage(LinePool *pool) {
+
+    size_t pooledBytes = 0;
+    size_t unpooledBytes = 0;
+    pool->memoryUsage(&pooledBytes, &unpooledBytes);
+
+    *out << "Interned " << pool->sharedLines() << " lines as " << pool->uniqueLines() << " unique lines: ";
+
+    if (unpooledBytes > pooledBytes) {
+        *out << "saved about " << (unpooledBytes - pooledBytes) / 1024 << " KB of "
+             << unpooledBytes / 1024 << " KB." << std::endl;
+    } else {
+        *out << "no memory saved." << std::endl;
+    }
+} // end reportPoolUsage method
+
+/**
+ * Summary: Prints how well the lines compressed.
+ *
+ * @param BlockStore *store
+ */
+void Editor::reportStoreUsage(BlockStore *store) {
+
+    *out << "Compressed " << store->uncompressedSize() / 1024 << " KB of lines into "
+         << store->compressedSize() / 1024 << " KB (" << store->blocks() << " blocks)";
+
+    // Only shows up with a memory limit
+    if (store->swapUsage() > 0) {
+        *out << ", " << store->swapUsage() / 1024 << " KB spilled to swap, "
+             << store->memoryUsage() / 1024 << " KB in memory";
+    }
+    *out << "." << std::endl;
+
+    // The limit can't be kept, say so rather than quietly going over it
+    if (store->overBudget()) {
+        *out << "The nodes holding the lines alone take " << store->nodeUsage() / 1024
+             << " KB, more than the " << store->memoryBudget() / 1024 << " KB of the memory limit this file has." << std::endl;
+    }
+    if (store->swapFailed()) {
+        *out << SwapFileException().what() << " The lines are kept in memory over the limit." << std::endl;
+    }
+} // end reportStoreUsage method
+
+/**
+ * Summary: Writes the line index made while a big file was saved as its sidecar, with the signature of
+ * the file as it was just written, so view mode opens it without scanning it.
+ *
+ * @param const string &filename
+ * @param const LineIndex &index
+ */
+void Editor::saveLineIndex(const std::string &filename, const LineIndex &index) {
+
+    try {
+        MappedFile file(filename);
+        index.save(LineIndex::sidecarPath(filename), FileSignature::takeSignature(file));
+    }
+    catch (FileFailedToOpenException &e) {
+        // Not being able to index the file is never an error
+    }
+} // end saveLineIndex method
+
+/**
+ * Summary: Takes a snapshot of the file that was just loaded.
+ *
+ * @param const string &filename
+ * @return snapshot, nullptr if the file changed while it was loading
+ */
+std::unique_ptr<FileSnapshot> Editor::takeSnapshot(const std::string &filename) {
+
+    // RELOAD compares file bytes with lines, that only works for a plain file
+    if (loadedFormat != formatPlain) {
+        return nullptr;
+    }
+
+    // The whole file is mapped to hash it, more than a memory limit smaller than the file allows
+    if (isOverBudget(&list, loadedBytes)) {
+        return nullptr;
+    }
+
+    try {
+        MappedFile file(filename);
+
+        // Grown or shrunk since the loader opened it, the list doesn't match it
+        if (file.size() != loadedBytes) {
+            return nullptr;
+        }
+        return std::unique_ptr<FileSnapshot>(new FileSnapshot(FileSnapshot::takeSnapshot(file)));
+    }
+    catch (FileFailedToOpenException &e) {
+        return nullptr;
+    }
+} // end takeSnapshot method
+
+/**
+ * Summary: Writes the contents of the linked list to file.
+ *
+ * Outfile is overwritten and not appended. The text is written to filename.tmp and renamed over the
+ * file once all of it is on the disk, so a save that fails partway leaves the file as it was. A big
+ * plain file gets a new sidecar line index for view mode, made from the lines as they're written.
+ *
+ * @param const string &filename
+ * @param LinkedList *list
+ * */
+void Editor::saveWriteFile(const std::string &filename, LinkedList *list) {
+
+#ifdef _WIN32
+    const std::string newline = "\r\n"; // what the text mode stream used to write
+#else
+    const std::string newline = "\n";
+#endif
+
+    // Queues full buffers for writing while the next one is filled, compressing them first if the
+    // file is compressed (or named .gz or .zst when it doesn't exist yet)
+    std::unique_ptr<FileSink> writer;
+    fileFormat format = isFileExists(filename) ? detectFormat(filename) : formatForName(filename);
+    saved = false;
+
+    static LatencyHistogram &saveStats = Stats::shared().histogram("save");
+    StatsTimer timer(&saveStats);
+    TraceSpan span("save");
+
+    // Attempt to open file
+    try {
+        // Connect the file to the writer
+        // Will create a new file if the file doesn't currently exist
+        try {
+            TraceSpan open("open");
+            writer = FileSink::create(filename, format); // outfile
+        }
+        catch (FileFailedToOpenException &e) {
+            *out << "Output File failed to open" << std::endl;
+            throw;
+        }
+        catch (FormatUnavailableException &e) {
+            // A compressed file this build can't write wasn't loaded either, it's never replaced.
+            // A new file is better uncompressed than losing the edits.
+            if (isFileExists(filename)) {
+                *out << e.what() << " " << filename << " was not saved." << std::endl;
+                return;
+            }
+            *out << e.what() << " Saving uncompressed." << std::endl;
+            format = formatPlain;
+            writer = FileSink::create(filename, format);
+        }
+
+        //cout << "File '" << filename <<"' Open" << endl; // TEST
+        *out << "Writing... ";
+
+        // Attempt to write to file
+        try {
+            bool firstLine = true;
+            uint64_t lines = 0;
+            uint64_t bytes = 0;
+            LineIndex index; // where lines start in a plain file, for view mode
+            {
+                TraceSpan write("write");
+
+                //For each node in the linked list using iterator, send to the writer
+                for (LinkedList::iterator i = list->begin(); i != list->end(); ++i) {
+
+                    // Every line but the first starts with a line break, so the final line doesn't end with one
+                    if (!firstLine) {
+                        writer->write(newline);
+                        bytes += newline.size();
+                    }
+                    if (format == formatPlain && lines > 0 && lines % index.interval() == 0) {
+                        index.addCheckpoint(bytes);
+                    }
+                    writer->write(*i);
+                    bytes += (*i).size();
+                    lines++;
+                    firstLine = false;
+                }
             }
-            catch (FileFailedToCloseException &e) {
-                std::cout << e.what() << std::endl;
+
+            // Write what's left and close file resources
+            {
+                TraceSpan close("close");
+                writer->close();
             }
-            catch (std::exception &e) {
-                std::cout << "An error occurred closing the file." << std::endl;
-                std::cout << e.what() << std::endl;
+            saved = true;
+            Stats::touched(lines, bytes);
+
+            // The index is as new as the file, any sidecar from before the save is stale
+            if (format == formatPlain && bytes >= LineIndex::MinSidecarSize) {
+                index.finish(lines);
+                saveLineIndex(filename, index);
             }
+
+            *out << "Complete!" << std::endl;
+
+        }
+        catch (IoException &e) {
+            *out << "An error occurred writing to file." << std::endl;
+            *out << e.what() << " " << filename << " was not changed." << std::endl;
+        }
+        catch (SwapFileException &e) {
+            *out << e.what() << " " << filename << " was not changed." << std::endl;
+        }
+        catch (CorruptBlockException &e) {
+            *out << e.what() << " " << filename << " was not changed." << std::endl;
+        }
+        catch (std::bad_exception &e) {
+            *out << "An unexpected error occurred writing to file." << std::endl;
+            *out << e.what() << std::endl;
+        }
+        catch (std::exception &e) {
+            *out << "An error occurred writing to file." << std::endl;
+            *out << e.what() << std::endl;
         }
     }
     catch (FileFailedToOpenException &e) {
-        std::cout << e.what() << std::endl;
+        *out << e.what() << std::endl;
     }
     catch (std::system_error &e) {
-        std::cout << e.what() << std::endl;
+        *out << e.what() << std::endl;
     }
     catch (std::exception &e) {
-        std::cout << e.what() << std::endl;
+        *out << e.what() << std::endl;
     }
 
 }
 
 
-// end saveWriteFile method
\ No newline at end of file
+// end saveWriteFile method
+
+/**
+ * Summary: Writes the text to the autosave file, on a pool thread. The lines are copied AutosaveBatch
+ * at a time under the list lock and written with it released, so a command only ever waits for one
+ * batch. An edit between batches starts the copy over, and after AutosaveAttempts of them the next
+ * autosave tries again instead. Written to a temporary name first and renamed into place, so a crash
+ * while it's written never leaves half a copy in place of the last one.
+ *
+ * @param const string &filename
+ * @return false if the file couldn't be written
+ */
+bool Editor::writeAutosave(const std::string &filename) {
+
+    TraceSpan span("autosave");
+    std::string temporary = filename + ".tmp";
+    std::string batch;
+
+    for (int attempt = 0; attempt < AutosaveAttempts; attempt++) {
+
+        std::ofstream copy(temporary, std::ios::trunc);
+        uint64_t version;
+        Node* next;
+        bool firstLine = true;
+        bool edited = false;
+        {
+            std::lock_guard<std::mutex> guard(listLock);
+            version = list.getVersion();
+            next = list.begin().node;
+        }
+
+        while (next != nullptr && !copy.fail()) {
+            batch.clear();
+            {
+                // Nodes are only freed by edits, an unchanged version means next is still in the list
+                std::lock_guard<std::mutex> guard(listLock);
+                if (list.getVersion() != version) {
+                    edited = true;
+                    break;
+                }
+                for (int count = 0; count < AutosaveBatch && next != nullptr; count++, next = next->next) {
+                    if (!firstLine) {
+                        batch += '\n';
+                    }
+                    batch += next->line();
+                    firstLine = false;
+                }
+            }
+            copy.write(batch.data(), (std::streamsize) batch.size());
+        }
+        copy.close();
+
+        if (copy.fail()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+        if (edited) {
+            continue;
+        }
+
+#ifdef _WIN32
+        // rename won't replace an existing file on Windows
+        std::remove(filename.c_str());
+#endif
+        if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+
+        std::lock_guard<std::mutex> guard(listLock);
+        autosavedVersion = version;
+        return true;
+    }
+
+    // Edited all along, nothing went wrong
+    std::remove(temporary.c_str());
+    return true;
+} // end writeAutosave method
+
+/**
+ * Summary: Starts writing a copy of the text to the file's autosave file (filename.autosave), if it
+ * changed since the last autosave. The copy is written on the thread pool by writeAutosave(), which
+ * holds the list lock one batch of lines at a time.
+ *
+ * @param const function<void(bool)> &done called with whether it was written, on a pool thread
+ * @return false if there was nothing to write or the file is still loading
+ */
+bool Editor::startAutosave(const std::function<void(bool)> &done) {
+
+    {
+        std::lock_guard<std::mutex> guard(listLock);
+        if (myFileName.empty() || loading || loadPending || list.getVersion() == autosavedVersion) {
+            return false;
+        }
+    }
+
+    std::string filename = myFileName + AutosaveExt;
+    auto write = [this, filename, done]() {
+        done(writeAutosave(filename));
+    };
+
+    // Without worker threads it's written right away
+    if (ThreadPool::shared().size() == 1) {
+        write();
+        return true;
+    }
+
+    if (!autosaving) {
+        autosaving.reset(new TaskGroup());
+    }
+    autosaving->run(write);
+    return true;
+} // end startAutosave method
@@ -18,13 +18,31 @@
 
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <exception>
+#include <functional>
+#include <memory>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include "LinkedList.h"
+#include "Diff.h"
+#include "Sort.h"
+#include "LineHashSet.h"
+#include "LineIndex.h"
+#include "FileIo.h"
+#include "FileWatcher.h"
+#include "FileSnapshot.h"
+#include "ThreadPool.h"
+#include "Stats.h"
+#include "Trace.h"
 
 // Enum Commands
 enum command {
@@ -37,11 +55,28 @@ enum command {
     cmdI,
     cmdIn,
     cmdE,
+    cmdDIFF,
+    cmdDIFFfile,
+    cmdSORT,
+    cmdSORTnm,
+    cmdUNIQ,
+    cmdUNIQnm,
+    cmdDEDUP,
+    cmdDEDUPnm,
+    cmdRELOAD,
+    cmdSTATS,
+    cmdTRACE,
+    cmdTRACEfile,
     cmdNone
 };
 
 // Constants
 std::string const DefaultFileExt = ".txt";
+std::string const AutosaveExt = ".autosave"; // added to the filename for the autosave copy
+int const InitialLines = 4096; // lines loaded before the first prompt, the rest load in the background
+int const LoaderBatch = 4096; // lines the background loader reads between taking the list lock
+int const AutosaveBatch = 4096; // lines an autosave copies each time it takes the list lock
+int const AutosaveAttempts = 3; // copies an autosave starts over after edits, before leaving it to the next one
 //regex const InvalidWindowsFileExpr("[\\<\\>\\:\\\"\\/\\\\\\|\\?\\*]");
 //regex const InvalidWindowsFileExpr(R"([\<\>\:\"\/\\\|\?\*])");
 
@@ -57,6 +92,45 @@ public:
     int *ptrCurrentLineNumber = &currentLineNumber; // pointer to expose currentLineNumber to functions
     bool isInsert = false; // used to differentiate user input as an Add() or an Insert()
     bool *ptrIsInsert = &isInsert; // pointer to expose isInsert to functions
+    std::ostream *out = &std::cout; // where commands write, the server points it at the client's reply
+    std::istream *in = &std::cin; // where commands read answers to their questions
+
+    // Background loading of big files
+    bool loadInBackground = false; // set for the interactive editor, everything else loads synchronously
+    std::mutex listLock; // held by the loader while it appends, and by the main thread while a command runs
+    std::condition_variable linesLoaded; // signalled after each batch the loader appends
+    int loadedLines = 0;
+    bool loading = false; // loader thread is still appending
+    bool loadPending = false; // loader finished but the main thread hasn't caught up yet
+    std::atomic<bool> stopLoading;
+    std::thread loader;
+    uint64_t loadedBytes = 0; // size of the file when it was opened, where follow mode starts reading
+    fileFormat loadedFormat = formatPlain; // compressed files are decompressed as they load
+    bool loadIncomplete = false; // the list is only part of the file, E won't save over it
+    std::chrono::steady_clock::time_point loadStarted; // for the load's stats once the loader finishes
+
+    // Follow mode, lines appended to the file are appended to the list
+    std::unique_ptr<FileWatcher> watcher;
+    std::thread follower;
+    int followedLines = 0; // new lines since the main thread last caught up
+    int followedNodes = 0; // nodes added for them, a line finishing the last one doesn't add a node
+    std::string followNotice; // truncation or rotation to report at the next prompt
+    Node* followedLast = nullptr; // last line as the file has it, lines typed after it aren't continued
+    bool followRestarted = false; // the buffer was emptied and the file reloaded, the current line moves to the end
+    uint64_t followedVersion = 0; // list version after the follower's last change, a newer one means edits of the user's
+
+    // The file as it was loaded, what RELOAD compares it with to find changes made by other programs
+    std::unique_ptr<FileSnapshot> snapshot;
+
+    // Called on the loader or follower thread (holding listLock) when there is something to report at
+    // the prompt, so an idle prompt can report it without waiting for the next command
+    std::function<void()> onBackgroundUpdate;
+
+    bool saved = false; // the last save wrote the whole file
+
+    // Autosave, a copy of the text written next to the file on the thread pool
+    uint64_t autosavedVersion = 0; // list version the autosave file has, or the file had when loaded (listLock)
+    std::unique_ptr<TaskGroup> autosaving; // created by the first autosave, last so it's waited for first
 
     // Constructors
     Editor();
@@ -66,8 +140,27 @@ public:
     bool isFileExists(const std::string &);
     bool isValidFileName(const std::string &);
     void populateListFromFile(const std::string &, LinkedList *);
+    void loadRemainingLines(LineSource &, int, const std::string &, LinkedList *);
+    void markIncomplete(const std::string &, LinkedList *);
+    void waitForLines(std::unique_lock<std::mutex> &, int);
+    void pollLoading();
+    void finishLoading();
+    bool followFile(const std::string &);
+    void followChanges(const std::string &, uint64_t);
+    bool clearFollowedLines();
+    void appendFollowedText(const char *, size_t, bool &);
+    void pollFollowing();
+    void stopFollowing();
+    void stopBackground();
+    void reportPoolUsage(LinePool *);
+    void reportStoreUsage(BlockStore *);
+    void saveLineIndex(const std::string &, const LineIndex &);
+    std::unique_ptr<FileSnapshot> takeSnapshot(const std::string &);
     void saveWriteFile(const std::string &, LinkedList *);
+    bool writeAutosave(const std::string &);
+    bool startAutosave(const std::function<void(bool)> &);
     command checkCommand(const std::string &);
+    static const char* commandName(command);
     bool textCommandEntered(const std::string &, int *, LinkedList *, bool *);
     bool exitCommandEntered(const std::string &, const std::string &, LinkedList *);
     void cmdExit(std::string, LinkedList *);
@@ -80,6 +173,11 @@ public:
     void cmdInsert(int *, LinkedList *, bool *);
     void cmdInsert(int, int *, LinkedList *, bool *);
     void addDataToList(const std::string &, int *, LinkedList *, bool *);
+    void cmdDiff(const std::string &, LinkedList *);
+    void cmdSort(int, int, const std::string &, LinkedList *);
+    void cmdUnique(int, int, bool, int *, LinkedList *);
+    void cmdReload(int *, LinkedList *);
+    void cmdTrace(const std::string &);
 };
 
 // Custom Exceptions
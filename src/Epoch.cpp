@@ -0,0 +1,179 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Epoch .cpp implementation file
+ */
+
+#include "Epoch.h"
+
+#include <new>
+#include <thread>
+
+/**
+ * Constructor
+ *
+ * @param size_t maxReaders readers that can be inside a guard at the same time, more wait for a slot
+ */
+EpochManager::EpochManager(size_t maxReaders)
+        : globalEpoch(1), slotMemory(new char[sizeof(Slot) * maxReaders + alignof(Slot)]), slots(nullptr),
+          slotCount(maxReaders) {
+
+    // Line the slots up on a cache line, the extra alignof(Slot) bytes leave room to move up to one
+    void* first = slotMemory.get();
+    size_t space = sizeof(Slot) * maxReaders + alignof(Slot);
+    slots = (Slot*) std::align(alignof(Slot), sizeof(Slot) * maxReaders, first, space);
+
+    for (size_t i = 0; i < slotCount; i++) {
+        new (&slots[i]) Slot();
+        slots[i].taken.store(false, std::memory_order_relaxed);
+        slots[i].epoch.store(0, std::memory_order_relaxed);
+    }
+} // end EpochManager constructor
+
+/**
+ * Destructor
+ *
+ * Every reader must be gone by now.
+ */
+EpochManager::~EpochManager() {
+    drain();
+}
+
+/**
+ * Summary: Starts a read. Takes a free slot and announces the current epoch in it, checking the epoch
+ * didn't move meanwhile so the writer can't have missed the announcement.
+ *
+ * @return slot
+ */
+EpochManager::Slot* EpochManager::enter() {
+
+    Slot* slot = nullptr;
+
+    while (slot == nullptr) {
+        for (size_t i = 0; i < slotCount; i++) {
+            bool expected = false;
+            if (!slots[i].taken.load(std::memory_order_relaxed) &&
+                slots[i].taken.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                slot = &slots[i];
+                break;
+            }
+        }
+        if (slot == nullptr) {
+            // More readers than slots, wait for one to leave
+            std::this_thread::yield();
+        }
+    }
+
+    uint64_t epoch;
+    do {
+        epoch = globalEpoch.load(std::memory_order_seq_cst);
+        slot->epoch.store(epoch, std::memory_order_seq_cst);
+    } while (globalEpoch.load(std::memory_order_seq_cst) != epoch);
+
+    return slot;
+} // end enter method
+
+/**
+ * Summary: Ends a read, the reader holds no pointers into the structure any more.
+ *
+ * @param Slot *slot
+ */
+void EpochManager::leave(Slot* slot) {
+    slot->epoch.store(0, std::memory_order_release);
+    slot->taken.store(false, std::memory_order_release);
+} // end leave method
+
+/**
+ * Summary: Moves the global epoch on if every active reader has entered in the current one.
+ *
+ * @return true if it moved
+ */
+bool EpochManager::tryAdvance() {
+
+    uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+
+    for (size_t i = 0; i < slotCount; i++) {
+        uint64_t reading = slots[i].epoch.load(std::memory_order_seq_cst);
+        if (reading != 0 && reading != epoch) {
+            return false;
+        }
+    }
+
+    globalEpoch.store(epoch + 1, std::memory_order_seq_cst);
+    return true;
+} // end tryAdvance method
+
+/**
+ * Summary: Hands over an object that has been unlinked, it's destroyed once no reader can reach it.
+ *
+ * @param void *object
+ * @param void (*destroy)(void *)
+ */
+void EpochManager::retire(void* object, void (*destroy)(void*)) {
+
+    bool full;
+    {
+        std::lock_guard<std::mutex> guard(retireLock);
+        retired.push_back({globalEpoch.load(std::memory_order_seq_cst), object, destroy});
+        full = retired.size() >= CollectThreshold;
+    }
+
+    if (full) {
+        collect();
+    }
+} // end retire method
+
+/**
+ * Summary: Frees retired objects from two or more epochs ago, moving the epoch on first if it can.
+ */
+void EpochManager::collect() {
+
+    std::vector<Retired> freeable;
+
+    {
+        std::lock_guard<std::mutex> guard(retireLock);
+        tryAdvance();
+        uint64_t epoch = globalEpoch.load(std::memory_order_seq_cst);
+
+        size_t kept = 0;
+        for (Retired &item : retired) {
+            if (item.epoch + 2 <= epoch) {
+                freeable.push_back(item);
+            } else {
+                retired[kept++] = item;
+            }
+        }
+        retired.resize(kept);
+    }
+
+    for (Retired &item : freeable) {
+        item.destroy(item.object);
+    }
+} // end collect method
+
+/**
+ * Summary: Frees every retired object. Only safe once no reader is inside a guard.
+ */
+void EpochManager::drain() {
+
+    std::vector<Retired> freeable;
+    {
+        std::lock_guard<std::mutex> guard(retireLock);
+        freeable.swap(retired);
+    }
+
+    for (Retired &item : freeable) {
+        item.destroy(item.object);
+    }
+} // end drain method
+
+size_t EpochManager::pending() {
+    std::lock_guard<std::mutex> guard(retireLock);
+    return retired.size();
+} // end pending method
@@ -0,0 +1,82 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Epoch .h header file
+ *
+ * Epoch based reclamation, so threads can read a linked structure without locks while one writer
+ * changes it. A reader announces the global epoch it started in, the writer unlinks nodes and hands
+ * them to retire() instead of deleting them. A node retired in epoch e can't be reached by a reader
+ * that started in epoch e + 1 or later, so once every active reader has moved two epochs past it the
+ * node is freed.
+ *
+ * Retiring and collecting happen on the writer's thread only, readers just enter and leave.
+ */
+
+#ifndef SPARQ_EPOCH_H
+#define SPARQ_EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class EpochManager {
+
+private:
+    // One per concurrent reader, on its own cache line so readers don't slow each other down
+    struct alignas(64) Slot {
+        std::atomic<bool> taken;
+        std::atomic<uint64_t> epoch; // epoch the reader entered in, 0 while idle
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        void* object;
+        void (*destroy)(void*);
+    };
+
+    std::atomic<uint64_t> globalEpoch;
+    std::unique_ptr<char[]> slotMemory; // new Slot[] isn't aligned to 64 before C++17, the slots are placed in here
+    Slot* slots; // the first cache line boundary in slotMemory
+    size_t slotCount;
+    std::mutex retireLock;
+    std::vector<Retired> retired;
+
+    Slot* enter();
+    void leave(Slot* slot);
+    bool tryAdvance();
+
+public:
+    static const size_t DefaultReaders = 64;
+    static const size_t CollectThreshold = 256; // retired objects collected at once
+
+    explicit EpochManager(size_t maxReaders = DefaultReaders);
+    virtual ~EpochManager();
+    EpochManager(const EpochManager &) = delete;
+
+    // Held by a reader for as long as it follows pointers into the structure
+    class Guard {
+    private:
+        EpochManager &manager;
+        Slot* slot;
+    public:
+        explicit Guard(EpochManager &manager) : manager(manager), slot(manager.enter()) {}
+        ~Guard() { manager.leave(slot); }
+        Guard(const Guard &) = delete;
+    };
+
+    void retire(void* object, void (*destroy)(void*)); // writer only
+    void collect(); // frees what no reader can still see, writer only
+    void drain(); // frees everything, only when there are no readers left
+    size_t pending(); // retired but not freed yet
+};
+
+#endif //SPARQ_EPOCH_H
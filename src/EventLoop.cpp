@@ -0,0 +1,280 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * EventLoop .cpp implementation file
+ */
+
+#include "EventLoop.h"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// epoll id of the eventfd, watches are numbered after it
+static const uint64_t WakeupId = 0;
+
+/**
+ * Constructor
+ */
+EventLoop::EventLoop() : epoll(-1), wakeup(-1), stopping(false), nextId(WakeupId + 1) {
+
+    epoll = epoll_create1(EPOLL_CLOEXEC);
+    wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll < 0 || wakeup < 0) {
+        if (epoll >= 0) { close(epoll); }
+        if (wakeup >= 0) { close(wakeup); }
+        throw EventLoopException();
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = WakeupId;
+    epoll_ctl(epoll, EPOLL_CTL_ADD, wakeup, &event);
+} // end EventLoop constructor
+
+/**
+ * Destructor
+ *
+ * Closes the timers, watched descriptors belong to whoever watched them.
+ */
+EventLoop::~EventLoop() {
+
+    for (auto &entry : watches) {
+        if (entry.second->timer) {
+            close(entry.second->fd);
+        }
+    }
+    close(wakeup);
+    close(epoll);
+}
+
+/**
+ * Summary: Translates the loop's event flags to epoll's.
+ *
+ * @param uint32_t events
+ * @return epoll events
+ */
+static uint32_t epollEvents(uint32_t events) {
+    return ((events & EventReadable) ? (uint32_t) EPOLLIN : 0u) | ((events & EventWritable) ? (uint32_t) EPOLLOUT : 0u);
+} // end epollEvents function
+
+uint64_t EventLoop::add(int fd, uint32_t events, bool timer, bool repeat, ReadyCallback callback) {
+
+    uint64_t id = nextId++;
+
+    epoll_event event;
+    event.events = epollEvents(events);
+    event.data.u64 = id;
+    if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+        return 0;
+    }
+
+    std::shared_ptr<Watch> watch(new Watch());
+    watch->fd = fd;
+    watch->timer = timer;
+    watch->repeat = repeat;
+    watch->callback = std::move(callback);
+    watches[id] = watch;
+    watchedFds[fd] = id;
+
+    return id;
+} // end add method
+
+/**
+ * Summary: Calls back whenever the descriptor is ready for what it's watched for.
+ *
+ * @param int fd
+ * @param uint32_t events EventReadable and/or EventWritable
+ * @param ReadyCallback callback
+ * @return false if epoll can't watch it, like a regular file (which is always ready)
+ */
+bool EventLoop::watch(int fd, uint32_t events, ReadyCallback callback) {
+    return add(fd, events, false, false, std::move(callback)) != 0;
+} // end watch method
+
+/**
+ * Summary: Changes what a watched descriptor is watched for.
+ *
+ * @param int fd
+ * @param uint32_t events
+ */
+void EventLoop::modify(int fd, uint32_t events) {
+
+    auto found = watchedFds.find(fd);
+    if (found == watchedFds.end()) {
+        return;
+    }
+
+    epoll_event event;
+    event.events = epollEvents(events);
+    event.data.u64 = found->second;
+    epoll_ctl(epoll, EPOLL_CTL_MOD, fd, &event);
+} // end modify method
+
+/**
+ * Summary: Stops watching a descriptor. Safe from inside its own callback.
+ *
+ * @param int fd
+ */
+void EventLoop::unwatch(int fd) {
+
+    auto found = watchedFds.find(fd);
+    if (found == watchedFds.end()) {
+        return;
+    }
+
+    epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+    watches.erase(found->second);
+    watchedFds.erase(found);
+} // end unwatch method
+
+/**
+ * Summary: Calls back after a delay, and again after every delay if it repeats.
+ *
+ * @param uint64_t milliseconds
+ * @param bool repeat
+ * @param Callback callback
+ * @return timer, for cancelTimer()
+ */
+uint64_t EventLoop::addTimer(uint64_t milliseconds, bool repeat, Callback callback) {
+
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        throw EventLoopException();
+    }
+
+    itimerspec delay = {};
+    delay.it_value.tv_sec = (time_t) (milliseconds / 1000);
+    delay.it_value.tv_nsec = (long) (milliseconds % 1000) * 1000000;
+    if (delay.it_value.tv_sec == 0 && delay.it_value.tv_nsec == 0) {
+        delay.it_value.tv_nsec = 1; // zero would disarm it
+    }
+    if (repeat) {
+        delay.it_interval = delay.it_value;
+    }
+    timerfd_settime(fd, 0, &delay, nullptr);
+
+    uint64_t timer = add(fd, EventReadable, true, repeat, [callback](uint32_t) { callback(); });
+    if (timer == 0) {
+        close(fd);
+        throw EventLoopException();
+    }
+    return timer;
+} // end addTimer method
+
+/**
+ * Summary: Stops a timer. Safe from inside its own callback.
+ *
+ * @param uint64_t timer
+ */
+void EventLoop::cancelTimer(uint64_t timer) {
+
+    auto found = watches.find(timer);
+    if (found == watches.end() || !found->second->timer) {
+        return;
+    }
+
+    int fd = found->second->fd;
+    epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    watchedFds.erase(fd);
+    watches.erase(found);
+} // end cancelTimer method
+
+/**
+ * Summary: Runs the callback on the loop's thread. Can be called from any thread.
+ *
+ * @param Callback callback
+ */
+void EventLoop::post(Callback callback) {
+
+    {
+        std::lock_guard<std::mutex> guard(postLock);
+        posted.push_back(std::move(callback));
+    }
+
+    uint64_t one = 1;
+    if (write(wakeup, &one, sizeof(one)) < 0) {
+        // Only fails when the counter is full, the loop is woken already
+    }
+} // end post method
+
+void EventLoop::runPosted() {
+
+    uint64_t count;
+    while (read(wakeup, &count, sizeof(count)) > 0) {}
+
+    std::vector<Callback> ready;
+    {
+        std::lock_guard<std::mutex> guard(postLock);
+        ready.swap(posted);
+    }
+
+    for (Callback &callback : ready) {
+        callback();
+    }
+} // end runPosted method
+
+/**
+ * Summary: Waits for events and calls back for each, until stop() is called.
+ */
+void EventLoop::run() {
+
+    epoll_event events[64];
+    stopping = false;
+
+    while (!stopping) {
+        int count = epoll_wait(epoll, events, 64, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw EventLoopException();
+        }
+
+        for (int i = 0; i < count && !stopping; i++) {
+            uint64_t id = events[i].data.u64;
+
+            if (id == WakeupId) {
+                runPosted();
+                continue;
+            }
+
+            // Gone if an earlier callback in this batch removed it
+            auto found = watches.find(id);
+            if (found == watches.end()) {
+                continue;
+            }
+            std::shared_ptr<Watch> watch = found->second;
+
+            uint32_t happened = 0;
+            if (watch->timer) {
+                uint64_t expirations;
+                if (read(watch->fd, &expirations, sizeof(expirations)) < 0) {
+                    continue;
+                }
+                if (!watch->repeat) {
+                    cancelTimer(id);
+                }
+            } else {
+                if (events[i].events & EPOLLIN) { happened |= EventReadable; }
+                if (events[i].events & EPOLLOUT) { happened |= EventWritable; }
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) { happened |= EventClosed; }
+            }
+
+            watch->callback(happened);
+        }
+    }
+} // end run method
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * EventLoop .h header file
+ *
+ * Runs callbacks on one thread when descriptors are ready, when timers go off, or when another thread
+ * posts them. Background work hands its result back with post(), so whatever the callback touches is
+ * only ever touched by the loop's thread and needs no lock of its own.
+ *
+ * epoll with a timerfd per timer and an eventfd for posted callbacks, Linux only.
+ */
+
+#ifndef SPARQ_EVENTLOOP_H
+#define SPARQ_EVENTLOOP_H
+
+#include <exception>
+#include <string>
+
+#ifdef __linux__
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// What a descriptor is watched for and what happened to it
+const uint32_t EventReadable = 1;
+const uint32_t EventWritable = 2;
+const uint32_t EventClosed = 4; // hung up or failed, reported whatever was asked for
+
+class EventLoop {
+
+public:
+    typedef std::function<void()> Callback;
+    typedef std::function<void(uint32_t)> ReadyCallback; // gets the events that happened
+
+private:
+    struct Watch {
+        int fd;
+        bool timer; // the loop owns the fd, a timerfd
+        bool repeat;
+        ReadyCallback callback;
+    };
+
+    int epoll;
+    int wakeup; // eventfd, written by post()
+    bool stopping;
+    uint64_t nextId;
+    std::map<uint64_t, std::shared_ptr<Watch>> watches;
+    std::map<int, uint64_t> watchedFds;
+
+    std::mutex postLock;
+    std::vector<Callback> posted;
+
+    uint64_t add(int fd, uint32_t events, bool timer, bool repeat, ReadyCallback callback);
+    void runPosted();
+
+public:
+    EventLoop(); // throws EventLoopException
+    virtual ~EventLoop();
+    EventLoop(const EventLoop &) = delete;
+
+    bool watch(int fd, uint32_t events, ReadyCallback callback); // false if the fd can't be watched (a regular file)
+    void modify(int fd, uint32_t events);
+    void unwatch(int fd);
+
+    uint64_t addTimer(uint64_t milliseconds, bool repeat, Callback callback);
+    void cancelTimer(uint64_t timer);
+
+    void post(Callback callback); // any thread, runs on the loop's thread
+    void run(); // until stop()
+    void stop() { stopping = true; } // loop thread only, other threads post it
+};
+
+#endif
+
+// Custom Exceptions
+struct EventLoopException : public std::exception {
+public:
+    const std::string what() {
+        return "Unable to start the event loop.";
+    }
+};//end EventLoopException struct
+
+#endif //SPARQ_EVENTLOOP_H
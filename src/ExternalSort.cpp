@@ -0,0 +1,360 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * ExternalSort .cpp implementation file
+ */
+
+#include "ExternalSort.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Memory a buffered line costs on top of its text (the string and the sort's bookkeeping)
+static const size_t LineOverhead = 80;
+
+// Run files are written in pieces this big
+static const size_t ChunkSize = 1 << 20;
+
+// stdio buffer of each run file, they are all read at once while merging
+static const size_t RunFileBuffer = 1 << 18;
+
+/**
+ * Summary: Creates an empty temporary file for a run.
+ *
+ * @return the file, deleted automatically when closed
+ */
+static std::FILE* createRunFile() {
+
+    std::FILE* file = std::tmpfile();
+    if (file == nullptr) {
+        throw SortFileException();
+    }
+    std::setvbuf(file, nullptr, _IOFBF, RunFileBuffer);
+    return file;
+} // end createRunFile function
+
+/**
+ * Summary: Adds a line to a chunk of a run file, as its length followed by its text.
+ *
+ * @param string &chunk
+ * @param const string &line
+ */
+static void appendRecord(std::string &chunk, const std::string &line) {
+    uint32_t length = (uint32_t) line.size();
+    chunk.append((const char*) &length, sizeof(length));
+    chunk += line;
+} // end appendRecord function
+
+/**
+ * Summary: Writes a chunk to a run file and empties it.
+ *
+ * @param FILE *file
+ * @param string &chunk
+ */
+static void writeChunk(std::FILE* file, std::string &chunk) {
+    if (!chunk.empty() && std::fwrite(chunk.data(), 1, chunk.size(), file) != chunk.size()) {
+        throw SortFileException();
+    }
+    chunk.clear();
+} // end writeChunk function
+
+/**
+ * Summary: Reads the next line of the run.
+ *
+ * @param const SortOptions &options to work out the numeric key
+ * @return false once the run is used up
+ */
+bool ExternalSort::RunReader::next(const SortOptions &options) {
+
+    uint32_t length = 0;
+    if (std::fread(&length, sizeof(length), 1, file) != 1) {
+        done = true;
+        return false;
+    }
+
+    line.resize(length);
+    if (length > 0 && std::fread(&line[0], 1, length, file) != length) {
+        throw SortFileException();
+    }
+    key = options.numeric ? numericSortKey(line) : 0;
+    return true;
+} // end next method
+
+/**
+ * Constructor
+ *
+ * @param const SortOptions &options
+ * @param size_t memoryBudget bytes the lines being sorted may use, two runs are in memory at a time
+ */
+ExternalSort::ExternalSort(const SortOptions &options, size_t memoryBudget)
+        : options(options), runBudget(std::max<size_t>(memoryBudget / 2, 1 << 20)), bufferBytes(0),
+          merging(false), inMemory(false), nextBuffered(0) {}
+
+/**
+ * Destructor
+ *
+ * Closing the run files deletes them.
+ */
+ExternalSort::~ExternalSort() {
+    writer.cancel();
+    try {
+        writer.wait();
+    }
+    catch (...) {
+    }
+    for (std::FILE* run : runs) {
+        if (run != nullptr) {
+            std::fclose(run);
+        }
+    }
+}
+
+/**
+ * Summary: Adds a line to be sorted. Spills the lines collected so far to a run file when they reach the budget.
+ *
+ * @param string &&line
+ */
+void ExternalSort::add(std::string &&line) {
+
+    bufferBytes += line.size() + LineOverhead;
+    buffer.push_back(std::move(line));
+
+    if (bufferBytes >= runBudget) {
+        spill();
+    }
+} // end add method
+
+/**
+ * Summary: Hands the collected lines to a writer task, which sorts them and writes them out as a run
+ * while the next run is being collected. Waits for the previous run first, so two runs are in memory at most.
+ */
+void ExternalSort::spill() {
+
+    waitForWriter();
+
+    std::FILE* file = createRunFile();
+    runs.push_back(file);
+
+    writing.swap(buffer);
+    buffer.clear();
+    bufferBytes = 0;
+
+    writer.run([this, file]() {
+        sortStrings(writing, options);
+        writeRun(file);
+    });
+} // end spill method
+
+/**
+ * Summary: Waits for the writer task and passes on anything it threw.
+ */
+void ExternalSort::waitForWriter() {
+    writer.wait();
+} // end waitForWriter method
+
+/**
+ * Summary: Writes the sorted lines the writer owns to a run file.
+ *
+ * @param FILE *file
+ */
+void ExternalSort::writeRun(std::FILE* file) {
+
+    std::string chunk;
+    for (const std::string &line : writing) {
+        appendRecord(chunk, line);
+        if (chunk.size() >= ChunkSize) {
+            writeChunk(file, chunk);
+        }
+    }
+    writeChunk(file, chunk);
+
+    if (std::fflush(file) != 0) {
+        throw SortFileException();
+    }
+    writing.clear();
+} // end writeRun method
+
+/**
+ * Summary: No more lines are coming. Sorts in memory if everything fit in one run, otherwise writes the
+ * last run and gets the merge ready (merging groups of runs first when there are too many to merge at once).
+ */
+void ExternalSort::finish() {
+
+    if (runs.empty()) {
+        sortStrings(buffer, options);
+        inMemory = true;
+        merging = true;
+        return;
+    }
+
+    if (!buffer.empty()) {
+        spill();
+    }
+    waitForWriter();
+
+    // Give the run buffers' memory back before merging
+    std::vector<std::string>().swap(buffer);
+    std::vector<std::string>().swap(writing);
+
+    while (runs.size() > MaxFanIn) {
+        mergeGroups(MaxFanIn);
+    }
+
+    startMerge(0, runs.size());
+} // end finish method
+
+/**
+ * Summary: Merges every group of fanIn neighbouring runs into one run. Groups are kept in input order,
+ * so equal lines still come out in the order they went in.
+ *
+ * @param size_t fanIn
+ */
+void ExternalSort::mergeGroups(size_t fanIn) {
+
+    std::vector<std::FILE*> merged;
+    std::string chunk;
+    std::string line;
+
+    for (size_t first = 0; first < runs.size(); first += fanIn) {
+        size_t last = std::min(first + fanIn, runs.size());
+
+        if (last - first == 1) {
+            merged.push_back(runs[first]);
+            continue;
+        }
+
+        std::FILE* file = createRunFile();
+        merged.push_back(file);
+
+        startMerge(first, last);
+        while (next(line)) {
+            appendRecord(chunk, line);
+            if (chunk.size() >= ChunkSize) {
+                writeChunk(file, chunk);
+            }
+        }
+        writeChunk(file, chunk);
+
+        if (std::fflush(file) != 0) {
+            throw SortFileException();
+        }
+
+        // The group's runs have been merged, closing deletes them
+        for (size_t run = first; run < last; ++run) {
+            std::fclose(runs[run]);
+            runs[run] = nullptr;
+        }
+    }
+
+    readers.clear();
+    runs.swap(merged);
+} // end mergeGroups method
+
+/**
+ * Summary: Starts merging runs first to last (exclusive). Rewinds each run, reads its first line and
+ * builds the loser tree.
+ *
+ * @param size_t first
+ * @param size_t last
+ */
+void ExternalSort::startMerge(size_t first, size_t last) {
+
+    readers.clear();
+    for (size_t run = first; run < last; ++run) {
+        std::rewind(runs[run]);
+        readers.push_back({runs[run], std::string(), 0, false});
+        readers.back().next(options);
+    }
+
+    // Every node starts out holding the sentinel (readers.size()), which beats everything.
+    // Playing each reader in from the leaves leaves the real losers in the tree and the winner at the top.
+    tree.assign(readers.size(), readers.size());
+    for (size_t reader = readers.size(); reader > 0; --reader) {
+        replay(reader - 1);
+    }
+
+    merging = true;
+} // end startMerge method
+
+/**
+ * Summary: Does reader a's current line come out before reader b's?
+ * Used up readers lose to everything, ties go to the earlier run to keep the sort stable.
+ *
+ * @param size_t a
+ * @param size_t b
+ * @return true if a wins
+ */
+bool ExternalSort::beats(size_t a, size_t b) const {
+
+    if (a == readers.size()) { return true; }
+    if (b == readers.size()) { return false; }
+    if (readers[a].done) { return false; }
+    if (readers[b].done) { return true; }
+
+    const RunReader &first = options.reverse ? readers[b] : readers[a];
+    const RunReader &second = options.reverse ? readers[a] : readers[b];
+
+    if (options.numeric) {
+        if (first.key != second.key) { return first.key < second.key; }
+    } else {
+        int order = first.line.compare(second.line);
+        if (order != 0) { return order < 0; }
+    }
+
+    return a < b;
+} // end beats method
+
+/**
+ * Summary: Replays the matches on the path from a reader's leaf to the top of the loser tree,
+ * after the reader moved on to its next line.
+ *
+ * @param size_t reader
+ */
+void ExternalSort::replay(size_t reader) {
+
+    size_t winner = reader;
+    for (size_t node = (reader + readers.size()) / 2; node > 0; node /= 2) {
+        if (beats(tree[node], winner)) {
+            std::swap(tree[node], winner);
+        }
+    }
+    tree[0] = winner;
+} // end replay method
+
+/**
+ * Summary: Gets the next line in sorted order. Only valid after finish().
+ *
+ * @param string &line
+ * @return false once every line has come out
+ */
+bool ExternalSort::next(std::string &line) {
+
+    if (!merging) {
+        return false;
+    }
+
+    if (inMemory) {
+        if (nextBuffered >= buffer.size()) {
+            return false;
+        }
+        line.swap(buffer[nextBuffered++]);
+        return true;
+    }
+
+    size_t winner = tree[0];
+    if (readers.empty() || readers[winner].done) {
+        return false;
+    }
+
+    line.swap(readers[winner].line);
+    readers[winner].next(options);
+    replay(winner);
+    return true;
+} // end next method
@@ -0,0 +1,86 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * ExternalSort .h header file
+ *
+ * Sorts more lines than fit in memory. Lines are collected into runs that fit the memory budget,
+ * each run is sorted and written to a temporary file (on the thread pool, while the next run is being
+ * collected), and the runs are merged back together with a loser tree.
+ */
+
+#ifndef SPARQ_EXTERNALSORT_H
+#define SPARQ_EXTERNALSORT_H
+
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "Sort.h"
+#include "ThreadPool.h"
+
+class ExternalSort {
+
+private:
+    // Reads the lines of one sorted run back from its temporary file
+    struct RunReader {
+        std::FILE* file;
+        std::string line;
+        double key;
+        bool done;
+
+        bool next(const SortOptions &options);
+    };
+
+    SortOptions options;
+    size_t runBudget; // bytes of lines collected before a run is spilled
+    std::vector<std::string> buffer; // run being collected
+    size_t bufferBytes;
+    std::vector<std::FILE*> runs; // sorted runs in input order
+    std::vector<std::string> writing; // the run the writer owns
+    TaskGroup writer; // sorts and writes the previous run
+
+    // Merging
+    bool merging;
+    bool inMemory; // everything fit in one run, the sorted buffer is read back directly
+    size_t nextBuffered;
+    std::vector<RunReader> readers;
+    std::vector<size_t> tree; // loser tree over the readers, tree[0] is the winner
+
+    void spill();
+    void waitForWriter();
+    void writeRun(std::FILE* file);
+    void mergeGroups(size_t fanIn);
+    void startMerge(size_t first, size_t last);
+    bool beats(size_t a, size_t b) const;
+    void replay(size_t reader);
+
+public:
+    static const size_t MaxFanIn = 64; // more runs than this are merged in several passes
+
+    ExternalSort(const SortOptions &options, size_t memoryBudget);
+    virtual ~ExternalSort();
+    ExternalSort(const ExternalSort &) = delete;
+
+    void add(std::string &&line);
+    void finish(); // no more lines, start merging
+    bool next(std::string &line); // sorted lines one at a time after finish()
+
+    size_t runCount() const { return runs.size(); }
+};
+
+// Custom Exceptions
+struct SortFileException : public std::exception {
+public:
+    const std::string what() {
+        return "Unable to use the sort temporary files.";
+    }
+};//end SortFileException struct
+
+#endif //SPARQ_EXTERNALSORT_H
@@ -0,0 +1,417 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * FileIo .cpp implementation file
+ */
+
+#include "FileIo.h"
+#include "Editor.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/**
+ * Summary: Opens a file descriptor in binary mode.
+ *
+ * @param const string &filename
+ * @param int flags
+ * @return descriptor, negative if it couldn't be opened
+ */
+static int openFile(const std::string &filename, int flags) {
+#ifdef _WIN32
+    return _open(filename.c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return open(filename.c_str(), flags, 0644);
+#endif
+} // end openFile function
+
+/**
+ * Summary: Size of an open file.
+ *
+ * @param int fd
+ * @param uint64_t *size
+ * @return false if it couldn't be found
+ */
+static bool fileSizeOf(int fd, uint64_t* size) {
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_fstat64(fd, &info) != 0) { return false; }
+#else
+    struct stat info;
+    if (fstat(fd, &info) != 0) { return false; }
+#endif
+    *size = (uint64_t) info.st_size;
+    return true;
+} // end fileSizeOf function
+
+/**
+ * Summary: Flushes an open file to the disk, so a rename after it can't be kept without the data.
+ *
+ * @param int fd
+ * @return 0 if it was flushed
+ */
+static int syncFile(int fd) {
+#ifdef _WIN32
+    return _commit(fd);
+#else
+    return fsync(fd);
+#endif
+} // end syncFile function
+
+static int closeFile(int fd) {
+#ifdef _WIN32
+    return _close(fd);
+#else
+    return ::close(fd);
+#endif
+} // end closeFile function
+
+/**
+ * Constructor
+ *
+ * Opens the file and starts reading the first chunks.
+ *
+ * @param const string &filename
+ */
+LineReader::LineReader(const std::string &filename)
+        : io(IoBackend::create(IoDepth)), fd(-1), fileSize(0), nextOffset(0), chunks(IoDepth), current(0), position(0),
+          haveChunk(false), finished(false) {
+
+    fd = openFile(filename, O_RDONLY);
+    if (fd < 0) {
+        throw FileFailedToOpenException();
+    }
+
+    if (!fileSizeOf(fd, &fileSize)) {
+        closeFile(fd);
+        throw FileFailedToOpenException();
+    }
+
+    // Keep every chunk busy from the start
+    for (Chunk &chunk : chunks) {
+        chunk.buffer.resize(IoChunkSize);
+        chunk.pending = false;
+        chunk.length = 0;
+        chunk.filled = 0;
+        if (nextOffset < fileSize) {
+            request(chunk);
+        }
+    }
+} // end LineReader constructor
+
+/**
+ * Destructor
+ *
+ * Reads still in flight write into the chunk buffers, so they're waited for before the buffers go.
+ */
+LineReader::~LineReader() {
+
+    try {
+        for (Chunk &chunk : chunks) {
+            while (chunk.pending) {
+                IoBackend::Completion completion = io->wait();
+                chunks[completion.tag].pending = false;
+            }
+        }
+    }
+    catch (IoException &e) {
+        // Nothing more can be done for a read that failed
+    }
+    closeFile(fd);
+}
+
+/**
+ * Summary: Starts reading the next part of the file into a chunk.
+ *
+ * @param Chunk &chunk
+ */
+void LineReader::request(Chunk &chunk) {
+
+    chunk.offset = nextOffset;
+    chunk.length = (size_t) std::min<uint64_t>(IoChunkSize, fileSize - nextOffset);
+    chunk.filled = 0;
+    chunk.pending = true;
+    nextOffset += chunk.length;
+
+    io->submitRead(fd, chunk.buffer.data(), chunk.length, chunk.offset, (uint64_t) (&chunk - chunks.data()));
+} // end request method
+
+/**
+ * Summary: Moves on to the next chunk in the file, handing the finished one back for a new read.
+ * Waits for the next chunk's read to finish, other reads that finish meanwhile are collected too.
+ *
+ * @return false when there are no more chunks
+ */
+bool LineReader::advance() {
+
+    if (haveChunk) {
+        Chunk &done = chunks[current];
+        done.length = 0;
+        if (nextOffset < fileSize) {
+            request(done);
+        }
+        current = (current + 1) % chunks.size();
+    }
+
+    Chunk &chunk = chunks[current];
+    if (chunk.length == 0) {
+        haveChunk = false;
+        return false;
+    }
+
+    // Splitting has caught up with the reads
+    TraceSpan span(chunk.pending ? "read" : nullptr);
+    while (chunk.pending) {
+        IoBackend::Completion completion = io->wait();
+        Chunk &finishedChunk = chunks[completion.tag];
+
+        if (completion.result < 0) {
+            finishedChunk.pending = false;
+            throw IoException();
+        }
+
+        finishedChunk.filled += (size_t) completion.result;
+
+        // A short read is continued, unless the file got shorter since it was opened
+        if (completion.result > 0 && finishedChunk.filled < finishedChunk.length) {
+            io->submitRead(fd, finishedChunk.buffer.data() + finishedChunk.filled,
+                           finishedChunk.length - finishedChunk.filled,
+                           finishedChunk.offset + finishedChunk.filled, completion.tag);
+        } else {
+            finishedChunk.pending = false;
+        }
+    }
+
+    position = 0;
+    haveChunk = true;
+    return true;
+} // end advance method
+
+/**
+ * Summary: Reads the next line, like getline in a loop until eof. The text after the last newline is
+ * always a line too, even when it's empty.
+ *
+ * @param string &line without its newline
+ * @return false once every line has been read
+ */
+bool LineReader::next(std::string &line) {
+
+    if (finished) {
+        return false;
+    }
+
+    line.clear();
+
+    while (true) {
+        if (!haveChunk || position == chunks[current].filled) {
+            if (!advance()) {
+                finished = true;
+                return true;
+            }
+            continue;
+        }
+
+        const Chunk &chunk = chunks[current];
+        const char* start = chunk.buffer.data() + position;
+        size_t available = chunk.filled - position;
+        const char* newline = (const char*) std::memchr(start, '\n', available);
+
+        if (newline == nullptr) {
+            // The line carries on in the next chunk
+            line.append(start, available);
+            position = chunk.filled;
+            continue;
+        }
+
+        line.append(start, (size_t) (newline - start));
+        position += (size_t) (newline - start) + 1;
+
+#ifdef _WIN32
+        // The file is read in binary, drop the carriage return a text mode stream would have removed
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+#endif
+        return true;
+    }
+} // end next method
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Constructor
+ *
+ * Creates the temporary file next to the file being saved, with the same permissions when it exists.
+ *
+ * @param const string &filename
+ */
+FileWriter::FileWriter(const std::string &filename)
+        : io(IoBackend::create(IoDepth)), fd(-1), target(filename), temporary(filename + ".tmp"), nextOffset(0),
+          buffers(IoDepth), current(0), inFlight(0), failed(false) {
+
+    fd = openFile(temporary, O_WRONLY | O_CREAT | O_TRUNC);
+    if (fd < 0) {
+        throw FileFailedToOpenException();
+    }
+
+#ifndef _WIN32
+    struct stat info;
+    if (stat(target.c_str(), &info) == 0) {
+        fchmod(fd, info.st_mode & 07777);
+    }
+#endif
+
+    for (Buffer &buffer : buffers) {
+        buffer.data.resize(IoChunkSize);
+        buffer.used = 0;
+        buffer.written = 0;
+        buffer.offset = 0;
+        buffer.pending = false;
+    }
+} // end FileWriter constructor
+
+/**
+ * Destructor
+ *
+ * Waits for queued writes, their buffers can't go away under them. A writer that wasn't closed
+ * removes its temporary file, the file being saved is left as it was.
+ */
+FileWriter::~FileWriter() {
+    try {
+        while (inFlight > 0) {
+            complete();
+        }
+    }
+    catch (IoException &e) {
+        // Only reached when close() wasn't called, the write is already lost
+    }
+    if (fd >= 0) {
+        closeFile(fd);
+        std::remove(temporary.c_str());
+    }
+}
+
+/**
+ * Summary: Adds bytes to the file. Full buffers are queued for writing and the next free buffer is filled.
+ *
+ * @param const char *data
+ * @param size_t length
+ */
+void FileWriter::write(const char* data, size_t length) {
+
+    while (length > 0) {
+        if (failed) {
+            throw IoException();
+        }
+
+        Buffer &buffer = buffers[current];
+        size_t space = buffer.data.size() - buffer.used;
+        size_t copied = std::min(space, length);
+
+        std::memcpy(buffer.data.data() + buffer.used, data, copied);
+        buffer.used += copied;
+        data += copied;
+        length -= copied;
+
+        if (buffer.used == buffer.data.size()) {
+            queue(buffer);
+
+            // Wait for the next buffer to be written before filling it again
+            current = (current + 1) % buffers.size();
+            while (buffers[current].pending) {
+                complete();
+            }
+        }
+    }
+} // end write method
+
+/**
+ * Summary: Queues a buffer to be written at the end of what's been queued so far.
+ *
+ * @param Buffer &buffer
+ */
+void FileWriter::queue(Buffer &buffer) {
+
+    buffer.offset = nextOffset;
+    buffer.written = 0;
+    buffer.pending = true;
+    nextOffset += buffer.used;
+    inFlight++;
+
+    io->submitWrite(fd, buffer.data.data(), buffer.used, buffer.offset, (uint64_t) (&buffer - buffers.data()));
+} // end queue method
+
+/**
+ * Summary: Waits for one write to finish. Short writes are continued, failures are remembered for close().
+ */
+void FileWriter::complete() {
+
+    TraceSpan span("wait for write");
+
+    IoBackend::Completion completion = io->wait();
+    Buffer &buffer = buffers[completion.tag];
+
+    if (completion.result <= 0) {
+        failed = true;
+    } else {
+        buffer.written += (size_t) completion.result;
+        if (buffer.written < buffer.used) {
+            io->submitWrite(fd, buffer.data.data() + buffer.written, buffer.used - buffer.written,
+                            buffer.offset + buffer.written, completion.tag);
+            return;
+        }
+    }
+
+    buffer.pending = false;
+    buffer.used = 0;
+    inFlight--;
+} // end complete method
+
+/**
+ * Summary: Writes what's left, flushes it to the disk and renames it over the file being saved.
+ * Throws IoException if any of it failed, the temporary file is removed and the file left as it was.
+ */
+void FileWriter::close() {
+
+    if (buffers[current].used > 0) {
+        queue(buffers[current]);
+    }
+    while (inFlight > 0) {
+        complete();
+    }
+
+    int result = failed ? -1 : syncFile(fd);
+    if (closeFile(fd) != 0) {
+        result = -1;
+    }
+    fd = -1;
+
+    if (result == 0) {
+#ifdef _WIN32
+        // rename won't replace an existing file on Windows
+        std::remove(target.c_str());
+#endif
+        result = std::rename(temporary.c_str(), target.c_str());
+    }
+
+    if (result != 0) {
+        std::remove(temporary.c_str());
+        throw IoException();
+    }
+} // end close method
@@ -0,0 +1,141 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * FileIo .h header file
+ *
+ * Line reading and buffered writing on top of IoBackend. The reader keeps several large reads in
+ * flight ahead of the line splitting, the writer queues full buffers and keeps filling the next one
+ * while they're being written.
+ *
+ * LineSource and FileSink pick a plain or a compressed file (CompressedFile.h) by the file's magic bytes,
+ * so the editor loads and saves compressed files the same way as plain ones.
+ */
+
+#ifndef SPARQ_FILEIO_H
+#define SPARQ_FILEIO_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IoBackend.h"
+
+// Size and number of the buffers each reader or writer cycles through
+const size_t IoChunkSize = 1 << 20;
+const unsigned IoDepth = 4;
+
+// How a file's contents are stored
+enum fileFormat {
+    formatPlain,
+    formatGzip,
+    formatZstd
+};
+
+fileFormat detectFormat(const std::string &filename); // by magic bytes, plain if it doesn't exist
+fileFormat formatForName(const std::string &filename); // by extension, for a file that doesn't exist yet
+const char* formatName(fileFormat format);
+
+// Lines read from a file, getline style: the text after the last newline is a line too
+class LineSource {
+
+public:
+    virtual ~LineSource() {}
+
+    virtual bool next(std::string &line) = 0; // false once every line has been read
+    virtual bool eof() const = 0;
+    virtual uint64_t size() const = 0; // bytes in the file as it was opened
+
+    static std::unique_ptr<LineSource> open(const std::string &filename); // throws FileFailedToOpenException
+};
+
+// Bytes written to a file
+class FileSink {
+
+public:
+    virtual ~FileSink() {}
+
+    virtual void write(const char* data, size_t length) = 0;
+    void write(const std::string &text) { write(text.data(), text.size()); }
+    virtual void close() = 0; // writes what's left and replaces the file, throws IoException if anything failed
+
+    // Throws FileFailedToOpenException. The text goes to filename.tmp and is renamed over the file by
+    // close(), so a save that fails partway leaves the file as it was.
+    static std::unique_ptr<FileSink> create(const std::string &filename, fileFormat format);
+};
+
+class LineReader : public LineSource {
+
+private:
+    struct Chunk {
+        std::vector<char> buffer;
+        uint64_t offset; // where in the file the chunk starts
+        size_t length; // bytes requested
+        size_t filled; // bytes read so far
+        bool pending;
+    };
+
+    std::unique_ptr<IoBackend> io;
+    int fd;
+    uint64_t fileSize;
+    uint64_t nextOffset; // next offset to request
+    std::vector<Chunk> chunks; // ring of IoDepth chunks in file order
+    size_t current; // chunk being split
+    size_t position; // in the current chunk
+    bool haveChunk;
+    bool finished;
+
+    void request(Chunk &chunk);
+    bool advance();
+
+public:
+    explicit LineReader(const std::string &filename); // throws FileFailedToOpenException
+    virtual ~LineReader();
+    LineReader(const LineReader &) = delete;
+
+    bool next(std::string &line) override;
+    bool eof() const override { return finished; }
+    uint64_t size() const override { return fileSize; }
+    const char* backendName() const { return io->name(); }
+};
+
+class FileWriter : public FileSink {
+
+private:
+    struct Buffer {
+        std::vector<char> data;
+        size_t used;
+        size_t written;
+        uint64_t offset;
+        bool pending;
+    };
+
+    std::unique_ptr<IoBackend> io;
+    int fd;
+    std::string target; // the file being saved, only replaced once the whole of it is written
+    std::string temporary; // written first, target + ".tmp"
+    uint64_t nextOffset;
+    std::vector<Buffer> buffers;
+    size_t current;
+    unsigned inFlight;
+    bool failed; // a write failed, reported by close()
+
+    void queue(Buffer &buffer);
+    void complete();
+
+public:
+    explicit FileWriter(const std::string &filename); // throws FileFailedToOpenException, the file is left alone until close()
+    virtual ~FileWriter();
+    FileWriter(const FileWriter &) = delete;
+
+    using FileSink::write;
+    void write(const char* data, size_t length) override;
+    void close() override;
+};
+
+#endif //SPARQ_FILEIO_H
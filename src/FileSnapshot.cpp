@@ -0,0 +1,174 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * FileSnapshot .cpp implementation file
+ */
+
+#include "FileSnapshot.h"
+#include "MappedFile.h"
+#include "LineHash.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Text each task of the line hashing gets at least
+static const uint64_t MinBytesPerTask = 1 << 20;
+
+/**
+ * Summary: Hashes the lines ending in [first, last), first has to be the start of a line.
+ *
+ * @param const char *data
+ * @param uint64_t first
+ * @param uint64_t last
+ * @param vector<uint64_t> &hashes added to
+ */
+static void hashLines(const char* data, uint64_t first, uint64_t last, std::vector<uint64_t> &hashes) {
+
+    uint64_t lineStart = first;
+    const char* newline;
+    while ((newline = (const char*) std::memchr(data + lineStart, '\n', last - lineStart)) != nullptr) {
+        size_t length = (size_t) (newline - data - lineStart);
+#ifdef _WIN32
+        // Lines are loaded without the carriage return
+        if (length > 0 && data[lineStart + length - 1] == '\r') { length--; }
+#endif
+        hashes.push_back(hashLine(data + lineStart, length));
+        lineStart = (uint64_t) (newline - data) + 1;
+    }
+} // end hashLines function
+
+/**
+ * Summary: Takes a snapshot of a file's contents. The blocks and lines are hashed in parallel.
+ *
+ * @param const MappedFile &file
+ * @return snapshot
+ */
+FileSnapshot FileSnapshot::takeSnapshot(const MappedFile &file) {
+
+    FileSnapshot snapshot;
+    const char* data = file.data();
+    uint64_t size = file.size();
+    uint64_t blocks = size / BlockSize;
+
+    snapshot.size = size;
+    snapshot.modified = file.modifiedTime();
+
+    // Whole blocks from the start and from the end, with the newlines in each
+    std::vector<uint64_t> frontCounts(blocks);
+    std::vector<uint64_t> backCounts(blocks);
+    snapshot.frontHashes.resize(blocks);
+    snapshot.backHashes.resize(blocks);
+
+    parallelFor(0, blocks, MinBytesPerTask / BlockSize, [&](size_t first, size_t last) {
+        for (size_t k = first; k < last; k++) {
+            const char* front = data + k * BlockSize;
+            const char* back = data + size - (k + 1) * BlockSize;
+            snapshot.frontHashes[k] = hashLine(front, BlockSize);
+            frontCounts[k] = (uint64_t) std::count(front, front + BlockSize, '\n');
+            snapshot.backHashes[k] = hashLine(back, BlockSize);
+            backCounts[k] = (uint64_t) std::count(back, back + BlockSize, '\n');
+        }
+    });
+
+    snapshot.frontLines.push_back(0);
+    snapshot.backLines.push_back(0);
+    for (uint64_t k = 0; k < blocks; k++) {
+        snapshot.frontLines.push_back(snapshot.frontLines.back() + frontCounts[k]);
+        snapshot.backLines.push_back(snapshot.backLines.back() + backCounts[k]);
+    }
+
+    // Split the text into pieces that start at the beginning of a line, each piece is hashed on its own
+    size_t pieces = (size_t) std::max<uint64_t>(1, std::min<uint64_t>(size / MinBytesPerTask,
+                                                                       ThreadPool::shared().size() * 4));
+    std::vector<uint64_t> starts(pieces + 1, size);
+    starts[0] = 0;
+    for (size_t i = 1; i < pieces; i++) {
+        uint64_t from = std::max(size * i / pieces, starts[i - 1] + 1) - 1;
+        const char* newline = from < size ? (const char*) std::memchr(data + from, '\n', size - from) : nullptr;
+        starts[i] = newline != nullptr ? (uint64_t) (newline - data) + 1 : size;
+    }
+
+    std::vector<std::vector<uint64_t>> pieceHashes(pieces);
+    parallelFor(0, pieces, 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            hashLines(data, starts[i], starts[i + 1], pieceHashes[i]);
+        }
+    });
+
+    for (std::vector<uint64_t> &hashes : pieceHashes) {
+        snapshot.lineHashes.insert(snapshot.lineHashes.end(), hashes.begin(), hashes.end());
+    }
+
+    // The text after the last newline is a line too
+    uint64_t lineStart = size;
+    while (lineStart > 0 && data[lineStart - 1] != '\n') { lineStart--; }
+    snapshot.lineHashes.push_back(hashLine(data + lineStart, (size_t) (size - lineStart)));
+
+    return snapshot;
+} // end takeSnapshot method
+
+/**
+ * Summary: Quick check for a file that hasn't been written since the snapshot.
+ *
+ * @param const MappedFile &file
+ * @return true if the size and modification time are the same
+ */
+bool FileSnapshot::isSameFile(const MappedFile &file) const {
+    return file.size() == size && file.modifiedTime() == modified;
+} // end isSameFile method
+
+/**
+ * Summary: Finds the lines of a changed file that differ from the snapshot. Whole blocks are compared
+ * from the start until one differs, then from the end, and the region between them is widened to
+ * whole lines. The unchanged blocks are hashed but never split into lines.
+ *
+ * @param const MappedFile &file the file as it is now
+ * @return changed region, possibly all of the file
+ */
+ChangedRegion FileSnapshot::changedRegion(const MappedFile &file) const {
+
+    const char* data = file.data();
+    uint64_t length = file.size();
+
+    // Unchanged blocks at the start
+    size_t front = 0;
+    while (front < frontHashes.size() && (front + 1) * BlockSize <= length &&
+           hashLine(data + front * BlockSize, BlockSize) == frontHashes[front]) {
+        front++;
+    }
+
+    // Unchanged blocks at the end, not overlapping the ones at the start in either version
+    uint64_t room = std::min(size, length) - front * BlockSize;
+    size_t back = 0;
+    while (back < backHashes.size() && (back + 1) * BlockSize <= room &&
+           hashLine(data + length - (back + 1) * BlockSize, BlockSize) == backHashes[back]) {
+        back++;
+    }
+
+    ChangedRegion region;
+
+    // The line the first changed block starts in is the first changed line
+    region.firstLine = (int) frontLines[front];
+    region.start = front * BlockSize;
+    while (region.start > 0 && data[region.start - 1] != '\n') {
+        region.start--;
+    }
+
+    // Lines that start after a newline in the unchanged end blocks are unchanged
+    region.unchangedTail = (int) backLines[back];
+    if (region.unchangedTail > 0) {
+        const char* tailStart = data + length - back * BlockSize;
+        region.end = (uint64_t) ((const char*) std::memchr(tailStart, '\n', back * BlockSize) - data);
+    } else {
+        region.end = length;
+    }
+
+    return region;
+} // end changedRegion method
@@ -0,0 +1,55 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * FileSnapshot .h header file
+ *
+ * What a file looked like when it was loaded, kept so RELOAD can tell what another program changed.
+ * Holds the size and modification time, a hash of each 64 KB block counted from the start and from
+ * the end of the file, and a hash of every line.
+ *
+ * Comparing block hashes finds the unchanged start and end of the file without splitting them into
+ * lines, only the region between them is read again.
+ */
+
+#ifndef SPARQ_FILESNAPSHOT_H
+#define SPARQ_FILESNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+
+class MappedFile;
+
+// The part of a changed file that differs from its snapshot
+struct ChangedRegion {
+    int firstLine; // lines before this (0 based) are unchanged
+    int unchangedTail; // this many lines at the end are unchanged
+    uint64_t start; // bytes of the changed lines in the new file, [start, end)
+    uint64_t end; // newline that ends the last changed line, or the end of the file
+};
+
+class FileSnapshot {
+
+public:
+    static const uint64_t BlockSize = 1 << 16;
+
+    uint64_t size;
+    int64_t modified;
+    std::vector<uint64_t> frontHashes; // block k covers [k * BlockSize, (k + 1) * BlockSize)
+    std::vector<uint64_t> frontLines; // newlines before the start of front block k
+    std::vector<uint64_t> backHashes; // block k covers [size - (k + 1) * BlockSize, size - k * BlockSize)
+    std::vector<uint64_t> backLines; // newlines in the last k * BlockSize bytes
+    std::vector<uint64_t> lineHashes; // hash of every line, split the way the editor loads it
+
+    static FileSnapshot takeSnapshot(const MappedFile &file);
+
+    bool isSameFile(const MappedFile &file) const; // size and modification time match
+    ChangedRegion changedRegion(const MappedFile &file) const;
+};
+
+#endif //SPARQ_FILESNAPSHOT_H
@@ -0,0 +1,208 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * FileWatcher .cpp implementation file
+ */
+
+#include "FileWatcher.h"
+
+#include <cerrno>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+/**
+ * Constructor
+ *
+ * Starts watching the file, and the folder it's in for a new file with the same name. The file
+ * doesn't have to exist yet.
+ *
+ * @param const string &filename
+ */
+FileWatcher::FileWatcher(const std::string &filename) : path(filename), stopping(false) {
+
+    size_t slash = filename.find_last_of("/\\");
+    if (slash == std::string::npos) {
+        folder = ".";
+        name = filename;
+    } else {
+        folder = slash == 0 ? "/" : filename.substr(0, slash);
+        name = filename.substr(slash + 1);
+    }
+
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        throw FileWatchException();
+    }
+
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        close(inotifyFd);
+        throw FileWatchException();
+    }
+
+    folderWatch = inotify_add_watch(inotifyFd, folder.c_str(), IN_CREATE | IN_MOVED_TO);
+    if (folderWatch < 0) {
+        close(wakeFd);
+        close(inotifyFd);
+        throw FileWatchException();
+    }
+
+    fileWatch = -1;
+    watchFile();
+#else
+    struct stat info;
+    identity = stat(path.c_str(), &info) == 0 ? (uint64_t) info.st_ino : 0;
+#endif
+} // end FileWatcher constructor
+
+/**
+ * Destructor
+ */
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    close(wakeFd);
+    close(inotifyFd);
+#endif
+}
+
+#ifdef __linux__
+
+/**
+ * Summary: Watches whatever file has the name now, dropping the watch on the one it had before.
+ */
+void FileWatcher::watchFile() {
+
+    int watch = inotify_add_watch(inotifyFd, path.c_str(), IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF);
+
+    if (fileWatch >= 0 && watch != fileWatch) {
+        inotify_rm_watch(inotifyFd, fileWatch);
+    }
+    fileWatch = watch;
+} // end watchFile method
+
+/**
+ * Summary: Sleeps until the file is written to, a new file takes its name, or stop() is called.
+ *
+ * @return what happened
+ */
+fileChange FileWatcher::wait() {
+
+    // inotify_event has to be aligned, and a name can follow each one
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true) {
+        if (stopping) {
+            return changeStopped;
+        }
+
+        struct pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) { continue; }
+            throw FileWatchException();
+        }
+
+        if (fds[1].revents != 0) {
+            return changeStopped;
+        }
+
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length < 0) {
+            if (errno == EINTR || errno == EAGAIN) { continue; }
+            throw FileWatchException();
+        }
+
+        bool modified = false;
+        bool replaced = false;
+
+        for (char* at = buffer; at < buffer + length;) {
+            const struct inotify_event* event = (const struct inotify_event*) at;
+            at += sizeof(struct inotify_event) + event->len;
+
+            if (event->wd == fileWatch) {
+                if (event->mask & IN_MODIFY) {
+                    modified = true;
+                }
+                if (event->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) {
+                    // Moved away or deleted, whatever is written to it now isn't under the name anymore
+                    if (!(event->mask & IN_IGNORED)) {
+                        inotify_rm_watch(inotifyFd, fileWatch);
+                    }
+                    fileWatch = -1;
+                }
+            } else if (event->wd == folderWatch && event->len > 0 && name == event->name) {
+                replaced = true;
+            }
+        }
+
+        if (replaced) {
+            watchFile();
+            return changeReplaced;
+        }
+        if (modified) {
+            return changeModified;
+        }
+    }
+} // end wait method
+
+/**
+ * Summary: Wakes wait() up so the watching thread can finish.
+ */
+void FileWatcher::stop() {
+
+    stopping = true;
+
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0) {
+        // The counter can't overflow from this, and wait() checks stopping anyway
+    }
+} // end stop method
+
+#else
+
+/**
+ * Summary: Sleeps half a second, then reports the file as modified (or replaced if it's a different
+ * file now). The caller checks the size, so nothing is read when nothing changed.
+ *
+ * @return what happened
+ */
+fileChange FileWatcher::wait() {
+
+    for (int slept = 0; slept < 10; slept++) {
+        if (stopping) {
+            return changeStopped;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    struct stat info;
+    uint64_t now = stat(path.c_str(), &info) == 0 ? (uint64_t) info.st_ino : 0;
+    if (now != identity) {
+        identity = now;
+        if (now != 0) {
+            return changeReplaced;
+        }
+    }
+    return changeModified;
+} // end wait method
+
+void FileWatcher::stop() {
+    stopping = true;
+} // end stop method
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * FileWatcher .h header file
+ *
+ * Waits for a file to change, for follow mode (SparQ -f file). Uses inotify on Linux, watching the
+ * file itself for writes and its folder for a new file taking its name (log rotation).
+ * Elsewhere the file is checked twice a second.
+ */
+
+#ifndef SPARQ_FILEWATCHER_H
+#define SPARQ_FILEWATCHER_H
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <string>
+
+// What happened to the watched file
+enum fileChange {
+    changeModified, // written to or truncated, or maybe nothing (the caller checks the size)
+    changeReplaced, // a different file has the name now
+    changeStopped // stop() was called
+};
+
+class FileWatcher {
+
+private:
+    std::string path;
+    std::string folder;
+    std::string name;
+    std::atomic<bool> stopping;
+#ifdef __linux__
+    int inotifyFd;
+    int wakeFd; // eventfd that stop() writes to
+    int fileWatch; // -1 while the file doesn't exist
+    int folderWatch;
+
+    void watchFile();
+#else
+    uint64_t identity; // inode of the file when last checked, 0 if it didn't exist
+#endif
+
+public:
+    explicit FileWatcher(const std::string &filename); // throws FileWatchException
+    virtual ~FileWatcher();
+    FileWatcher(const FileWatcher &) = delete;
+
+    fileChange wait();
+    void stop(); // can be called from any thread
+    bool stopped() const { return stopping; }
+};
+
+// Custom Exceptions
+struct FileWatchException : public std::exception {
+public:
+    const std::string what() {
+        return "Unable to watch the file for changes.";
+    }
+};//end FileWatchException struct
+
+#endif //SPARQ_FILEWATCHER_H
@@ -0,0 +1,274 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * IoBackend .cpp implementation file
+ */
+
+#include "IoBackend.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+/**
+ * Summary: Creates the fastest backend available, io_uring if the kernel allows it
+ * (and SPARQ_NO_URING isn't set).
+ *
+ * @param unsigned depth most requests that will be in flight at once
+ * @return backend
+ */
+std::unique_ptr<IoBackend> IoBackend::create(unsigned depth) {
+
+#ifdef __linux__
+    // SPARQ_NO_URING=1 forces the fallback, for kernels where io_uring misbehaves
+    const char* disabled = std::getenv("SPARQ_NO_URING");
+    if (disabled != nullptr && disabled[0] != '\0' && disabled[0] != '0') {
+        return std::unique_ptr<IoBackend>(new SyncIo());
+    }
+
+    try {
+        return std::unique_ptr<IoBackend>(new UringIo(depth));
+    }
+    catch (IoException &e) {
+        // Old kernel, or io_uring blocked by a sandbox, fall through to pread/pwrite
+    }
+#endif
+
+    return std::unique_ptr<IoBackend>(new SyncIo());
+} // end create method
+
+// --------------------------------------------------------------------------------
+
+void SyncIo::submitRead(int fd, char* buffer, size_t length, uint64_t offset, uint64_t tag) {
+
+#ifdef _WIN32
+    int64_t result = _lseeki64(fd, (int64_t) offset, SEEK_SET) < 0 ? -1 : _read(fd, buffer, (unsigned) length);
+#else
+    int64_t result = pread(fd, buffer, length, (off_t) offset);
+#endif
+
+    finished.push_back({tag, result < 0 ? -(int64_t) errno : result});
+} // end submitRead method
+
+void SyncIo::submitWrite(int fd, const char* buffer, size_t length, uint64_t offset, uint64_t tag) {
+
+#ifdef _WIN32
+    int64_t result = _lseeki64(fd, (int64_t) offset, SEEK_SET) < 0 ? -1 : _write(fd, buffer, (unsigned) length);
+#else
+    int64_t result = pwrite(fd, buffer, length, (off_t) offset);
+#endif
+
+    finished.push_back({tag, result < 0 ? -(int64_t) errno : result});
+} // end submitWrite method
+
+IoBackend::Completion SyncIo::wait() {
+
+    if (finished.empty()) {
+        throw IoException();
+    }
+
+    Completion completion = finished.front();
+    finished.pop_front();
+    return completion;
+} // end wait method
+
+// --------------------------------------------------------------------------------
+
+#ifdef __linux__
+
+/**
+ * Constructor
+ *
+ * Sets up a ring with room for the given number of requests and maps its queues.
+ *
+ * @param unsigned entries
+ */
+UringIo::UringIo(unsigned entries) : ringFd(-1), sqRing(MAP_FAILED), cqRing(MAP_FAILED), sqes(nullptr) {
+
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    ringFd = (int) syscall(__NR_io_uring_setup, entries, &params);
+    if (ringFd < 0) {
+        throw IoException();
+    }
+
+    // Kernels before 5.6 have io_uring but fail every IORING_OP_READ and IORING_OP_WRITE with EINVAL
+    if (!supportsReadWrite()) {
+        close(ringFd);
+        throw IoException();
+    }
+
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    // Newer kernels map both queues with one mapping
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (cqRingSize > sqRingSize) { sqRingSize = cqRingSize; }
+        cqRingSize = sqRingSize;
+    }
+
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        close(ringFd);
+        throw IoException();
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        cqRing = sqRing;
+    } else {
+        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            munmap(sqRing, sqRingSize);
+            close(ringFd);
+            throw IoException();
+        }
+    }
+
+    sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqesMapping = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqesMapping == MAP_FAILED) {
+        if (cqRing != sqRing) { munmap(cqRing, cqRingSize); }
+        munmap(sqRing, sqRingSize);
+        close(ringFd);
+        throw IoException();
+    }
+    sqes = (struct io_uring_sqe*) sqesMapping;
+
+    char* sq = (char*) sqRing;
+    sqHead = (unsigned*) (sq + params.sq_off.head);
+    sqTail = (unsigned*) (sq + params.sq_off.tail);
+    sqMask = (unsigned*) (sq + params.sq_off.ring_mask);
+    sqArray = (unsigned*) (sq + params.sq_off.array);
+
+    char* cq = (char*) cqRing;
+    cqHead = (unsigned*) (cq + params.cq_off.head);
+    cqTail = (unsigned*) (cq + params.cq_off.tail);
+    cqMask = (unsigned*) (cq + params.cq_off.ring_mask);
+    cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+} // end UringIo constructor
+
+/**
+ * Summary: Asks the kernel whether the ring can do plain reads and writes. The probe came in the same
+ * kernel as the opcodes, a kernel that doesn't know it doesn't have them either.
+ *
+ * @return true if IORING_OP_READ and IORING_OP_WRITE are supported
+ */
+bool UringIo::supportsReadWrite() {
+
+#ifdef IO_URING_OP_SUPPORTED // a macro, unlike the opcodes, and from the same kernel as the probe
+    const unsigned opcodes = 256;
+    std::vector<char> memory(sizeof(struct io_uring_probe) + opcodes * sizeof(struct io_uring_probe_op), 0);
+    struct io_uring_probe* probe = (struct io_uring_probe*) memory.data();
+
+    if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, opcodes) < 0) {
+        return false;
+    }
+
+    auto supported = [probe](unsigned opcode) {
+        return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+    };
+    return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+#else
+    return false;
+#endif
+} // end supportsReadWrite method
+
+/**
+ * Destructor
+ */
+UringIo::~UringIo() {
+    munmap(sqes, sqesSize);
+    if (cqRing != sqRing) { munmap(cqRing, cqRingSize); }
+    munmap(sqRing, sqRingSize);
+    close(ringFd);
+}
+
+/**
+ * Summary: Puts a request on the submission queue and hands it to the kernel.
+ *
+ * @param int opcode IORING_OP_READ or IORING_OP_WRITE
+ * @param int fd
+ * @param const char *buffer
+ * @param size_t length
+ * @param uint64_t offset
+ * @param uint64_t tag
+ */
+void UringIo::submit(int opcode, int fd, const char* buffer, size_t length, uint64_t offset, uint64_t tag) {
+
+    // Only this thread writes the tail, the kernel moves the head
+    unsigned tail = *sqTail;
+    unsigned index = tail & *sqMask;
+
+    // Callers keep no more requests in flight than the ring was made for, so this is a bug if it happens
+    if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) > *sqMask) {
+        throw IoException();
+    }
+
+    struct io_uring_sqe* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (uint8_t) opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t) (uintptr_t) buffer;
+    sqe->len = (uint32_t) length;
+    sqe->off = offset;
+    sqe->user_data = tag;
+    sqArray[index] = index;
+
+    __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    if (syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, nullptr, 0) < 0) {
+        throw IoException();
+    }
+} // end submit method
+
+void UringIo::submitRead(int fd, char* buffer, size_t length, uint64_t offset, uint64_t tag) {
+    submit(IORING_OP_READ, fd, buffer, length, offset, tag);
+} // end submitRead method
+
+void UringIo::submitWrite(int fd, const char* buffer, size_t length, uint64_t offset, uint64_t tag) {
+    submit(IORING_OP_WRITE, fd, buffer, length, offset, tag);
+} // end submitWrite method
+
+/**
+ * Summary: Takes the next completion off the completion queue, sleeping in the kernel until there is one.
+ *
+ * @return completion
+ */
+IoBackend::Completion UringIo::wait() {
+
+    unsigned head = *cqHead;
+
+    while (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+        if (syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+            throw IoException();
+        }
+    }
+
+    struct io_uring_cqe* cqe = &cqes[head & *cqMask];
+    Completion completion = {cqe->user_data, cqe->res};
+
+    __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+    return completion;
+} // end wait method
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * IoBackend .h header file
+ *
+ * Asynchronous positioned reads and writes. Requests are submitted with a tag and their completions
+ * collected later, so the disk can work on several requests while the program does something else.
+ *
+ * On Linux this uses io_uring when the kernel allows it, everywhere else (or when io_uring is
+ * blocked, or too old for plain reads and writes) requests are carried out with pread/pwrite as
+ * they're submitted.
+ */
+
+#ifndef SPARQ_IOBACKEND_H
+#define SPARQ_IOBACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <string>
+
+class IoBackend {
+
+public:
+    struct Completion {
+        uint64_t tag;
+        int64_t result; // bytes transferred, or -errno
+    };
+
+    virtual ~IoBackend() {}
+
+    virtual void submitRead(int fd, char* buffer, size_t length, uint64_t offset, uint64_t tag) = 0;
+    virtual void submitWrite(int fd, const char* buffer, size_t length, uint64_t offset, uint64_t tag) = 0;
+    virtual Completion wait() = 0; // waits for the next finished request, there must be one in flight
+    virtual const char* name() const = 0;
+
+    static std::unique_ptr<IoBackend> create(unsigned depth);
+};
+
+// Carries out each request as it's submitted
+class SyncIo : public IoBackend {
+
+private:
+    std::deque<Completion> finished;
+
+public:
+    void submitRead(int fd, char* buffer, size_t length, uint64_t offset, uint64_t tag) override;
+    void submitWrite(int fd, const char* buffer, size_t length, uint64_t offset, uint64_t tag) override;
+    Completion wait() override;
+    const char* name() const override { return "pread/pwrite"; }
+};
+
+#ifdef __linux__
+// io_uring through the raw system calls, no liburing needed
+class UringIo : public IoBackend {
+
+private:
+    int ringFd;
+    void* sqRing;
+    void* cqRing;
+    size_t sqRingSize;
+    size_t cqRingSize;
+    struct io_uring_sqe* sqes;
+    size_t sqesSize;
+
+    // Pointers into the shared rings
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_cqe* cqes;
+
+    bool supportsReadWrite();
+    void submit(int opcode, int fd, const char* buffer, size_t length, uint64_t offset, uint64_t tag);
+
+public:
+    explicit UringIo(unsigned entries); // throws IoException if io_uring or its read and write opcodes aren't available
+    ~UringIo() override;
+    UringIo(const UringIo &) = delete;
+
+    void submitRead(int fd, char* buffer, size_t length, uint64_t offset, uint64_t tag) override;
+    void submitWrite(int fd, const char* buffer, size_t length, uint64_t offset, uint64_t tag) override;
+    Completion wait() override;
+    const char* name() const override { return "io_uring"; }
+};
+#endif
+
+// Custom Exceptions
+struct IoException : public std::exception {
+public:
+    const std::string what() {
+        return "File input/output failed.";
+    }
+};//end IoException struct
+
+#endif //SPARQ_IOBACKEND_H
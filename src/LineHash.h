@@ -0,0 +1,71 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * LineHash .h header file
+ *
+ * Fast non-cryptographic 64 bit hash used to compare lines without comparing their text.
+ */
+
+#ifndef SPARQ_LINEHASH_H
+#define SPARQ_LINEHASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * Summary: Mixes the bits of a 64 bit value (splitmix64 finalizer).
+ *
+ * @param uint64_t x
+ * @return mixed value
+ */
+inline uint64_t mixHash(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+} // end mixHash function
+
+/**
+ * Summary: Hashes a line of text, eight bytes at a time.
+ *
+ * @param const char *data
+ * @param size_t length
+ * @return 64 bit hash of the line
+ */
+inline uint64_t hashLine(const char *data, size_t length) {
+
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ (length * 0xff51afd7ed558ccdULL);
+    uint64_t word;
+
+    // Consume the line in 8 byte words
+    while (length >= 8) {
+        std::memcpy(&word, data, 8);
+        hash = (hash ^ mixHash(word)) * 0x9e3779b97f4a7c15ULL;
+        data += 8;
+        length -= 8;
+    }
+
+    // Fold in the remaining tail bytes
+    if (length > 0) {
+        word = 0;
+        std::memcpy(&word, data, length);
+        hash = (hash ^ mixHash(word)) * 0x9e3779b97f4a7c15ULL;
+    }
+
+    return mixHash(hash);
+} // end hashLine function
+
+inline uint64_t hashLine(const std::string &line) {
+    return hashLine(line.data(), line.size());
+} // end hashLine function
+
+#endif //SPARQ_LINEHASH_H
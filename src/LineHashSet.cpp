@@ -0,0 +1,78 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * LineHashSet .cpp implementation file
+ */
+
+#include "LineHashSet.h"
+#include "LineHash.h"
+
+/**
+ * Constructor
+ *
+ * Sizes the table so the expected number of lines fits under half full.
+ *
+ * @param size_t expected
+ */
+LineHashSet::LineHashSet(size_t expected) : count(0) {
+
+    size_t capacity = 16;
+    while (capacity < expected * 2) { capacity *= 2; }
+
+    slots.assign(capacity, Slot{0, nullptr});
+    mask = capacity - 1;
+} // end LineHashSet constructor
+
+/**
+ * Summary: Adds a line to the set unless an equal line is already there.
+ * The full text is only compared when two hashes are equal.
+ *
+ * @param const Node *node
+ * @return true if the line was added, false if it is a duplicate
+ */
+bool LineHashSet::insert(const Node* node) {
+
+    // Keep the table at most half full so probe chains stay short
+    if ((count + 1) * 2 > slots.size()) { grow(); }
+
+    uint64_t hash = hashLine(node->line());
+    size_t i = hash & mask;
+
+    // Probe until we find the line or an empty slot
+    while (slots[i].node != nullptr) {
+        if (slots[i].hash == hash && slots[i].node->line() == node->line()) {
+            return false;
+        }
+        i = (i + 1) & mask;
+    }
+
+    slots[i].hash = hash;
+    slots[i].node = node;
+    count++;
+
+    return true;
+} // end insert method
+
+/**
+ * Summary: Doubles the table and re-places every entry.
+ */
+void LineHashSet::grow() {
+
+    std::vector<Slot> old(slots.size() * 2, Slot{0, nullptr});
+    old.swap(slots);
+    mask = slots.size() - 1;
+
+    for (const Slot &slot : old) {
+        if (slot.node == nullptr) { continue; }
+
+        size_t i = slot.hash & mask;
+        while (slots[i].node != nullptr) { i = (i + 1) & mask; }
+        slots[i] = slot;
+    }
+} // end grow method
@@ -0,0 +1,46 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * LineHashSet .h header file
+ *
+ * Open addressing (linear probing) set of lines keyed on their hash.
+ * The lines themselves are not copied, the set points at the nodes holding them.
+ */
+
+#ifndef SPARQ_LINEHASHSET_H
+#define SPARQ_LINEHASHSET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LinkedList.h"
+
+class LineHashSet {
+
+private:
+    struct Slot {
+        uint64_t hash;
+        const Node* node; // nullptr marks an empty slot
+    };
+
+    std::vector<Slot> slots;
+    size_t mask; // capacity - 1, capacity is always a power of two
+    size_t count;
+
+    void grow();
+
+public:
+    explicit LineHashSet(size_t expected = 16);
+
+    bool insert(const Node* node); // false if an equal line is already in the set
+    size_t size() const { return count; }
+};
+
+#endif //SPARQ_LINEHASHSET_H
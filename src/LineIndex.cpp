@@ -0,0 +1,295 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * LineIndex .cpp implementation file
+ */
+
+#include "LineIndex.h"
+#include "LineHash.h"
+#include "MappedFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// Sidecar layout: header, checkpoints, then a hash of everything before it
+static const uint64_t SidecarMagic = 0x3130584449515153ULL; // "SQQIDX01"
+static const uint32_t SidecarVersion = 1;
+
+struct SidecarHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t interval;
+    uint64_t size;
+    int64_t modified;
+    uint64_t sample;
+    uint64_t totalLines;
+    uint64_t checkpointCount;
+};
+
+// Sampled blocks for the file signature
+static const uint64_t SampleCount = 16;
+static const uint64_t SampleSize = 4096;
+
+/**
+ * Summary: Signature of a file for checking a sidecar against it. Hashes 16 blocks of 4 KB spread
+ * evenly over the file (always including the first and the last), so a changed file is caught
+ * without reading all of it.
+ *
+ * @param const MappedFile &file
+ * @return signature
+ */
+FileSignature FileSignature::takeSignature(const MappedFile &file) {
+
+    FileSignature signature;
+    signature.size = file.size();
+    signature.modified = file.modifiedTime();
+
+    if (file.size() <= SampleCount * SampleSize) {
+        signature.sample = hashLine(file.data(), (size_t) file.size());
+    } else {
+        signature.sample = 0;
+        for (uint64_t sample = 0; sample < SampleCount; ++sample) {
+            uint64_t offset = (file.size() - SampleSize) * sample / (SampleCount - 1);
+            signature.sample = mixHash(signature.sample ^ hashLine(file.data() + offset, (size_t) SampleSize));
+        }
+    }
+
+    return signature;
+} // end takeSignature method
+
+/**
+ * Summary: Where the sidecar index of a file is kept.
+ *
+ * @param const string &filename
+ * @return sidecar filename
+ */
+std::string LineIndex::sidecarPath(const std::string &filename) {
+    return filename + ".sqidx";
+} // end sidecarPath method
+
+/**
+ * Constructor
+ *
+ * @param uint64_t interval lines between checkpoints
+ */
+LineIndex::LineIndex(uint64_t interval)
+        : checkpointInterval(interval), checkpoints(1, 0), totalLines(0), complete(false) {} // line 1 starts at 0
+
+/**
+ * Summary: Scans the text for newlines and records a checkpoint every interval lines.
+ * Checkpoints are published as they are found, so lookups near the start don't wait for the whole scan.
+ * Lines are counted like populateListFromFile does: the text after the last newline is a line too.
+ *
+ * @param const char *data
+ * @param uint64_t size
+ * @param const atomic<bool> *stop set to abandon the scan early
+ */
+void LineIndex::build(const char* data, uint64_t size, const std::atomic<bool>* stop) {
+
+    uint64_t position = 0;
+    uint64_t line = 1;
+
+    while (position < size) {
+        const char* newline = (const char*) std::memchr(data + position, '\n', (size_t) (size - position));
+        if (newline == nullptr) {
+            break;
+        }
+
+        position = (uint64_t) (newline - data) + 1;
+        line++;
+
+        // Start of a line that gets a checkpoint
+        if ((line - 1) % checkpointInterval == 0) {
+            // Stopping still marks the index complete so nothing is left waiting on it
+            if (stop != nullptr && stop->load(std::memory_order_relaxed)) {
+                break;
+            }
+
+            std::lock_guard<std::mutex> guard(lock);
+            checkpoints.push_back(position);
+            progress.notify_all();
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    totalLines = line;
+    complete = true;
+    progress.notify_all();
+} // end build method
+
+/**
+ * Summary: Records where the next checkpoint's line starts, for an index built as the file is written.
+ * The writer calls it at the start of every interval lines after the first.
+ *
+ * @param uint64_t offset
+ */
+void LineIndex::addCheckpoint(uint64_t offset) {
+    std::lock_guard<std::mutex> guard(lock);
+    checkpoints.push_back(offset);
+} // end addCheckpoint method
+
+/**
+ * Summary: Marks an index built with addCheckpoint() complete.
+ *
+ * @param uint64_t lines in the file, counted like build() does
+ */
+void LineIndex::finish(uint64_t lines) {
+    std::lock_guard<std::mutex> guard(lock);
+    totalLines = lines;
+    complete = true;
+    progress.notify_all();
+} // end finish method
+
+/**
+ * Summary: Finds the checkpoint at or before a line, waiting for the scan to reach it if needed.
+ *
+ * @param uint64_t line one based line number
+ * @param uint64_t *offset byte offset of the checkpoint's line
+ * @return false if the file has fewer lines than that
+ */
+bool LineIndex::checkpoint(uint64_t line, uint64_t* offset) {
+
+    uint64_t which = (line - 1) / checkpointInterval;
+
+    std::unique_lock<std::mutex> guard(lock);
+    progress.wait(guard, [this, which]() { return checkpoints.size() > which || complete; });
+
+    if (checkpoints.size() <= which || (complete && line > totalLines)) {
+        return false;
+    }
+
+    *offset = checkpoints[which];
+    return true;
+} // end checkpoint method
+
+/**
+ * Summary: Number of lines in the file, waiting for the scan to finish.
+ *
+ * @return line count
+ */
+uint64_t LineIndex::lineCount() {
+    std::unique_lock<std::mutex> guard(lock);
+    progress.wait(guard, [this]() { return complete; });
+    return totalLines;
+} // end lineCount method
+
+bool LineIndex::isComplete() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return complete;
+}
+
+uint64_t LineIndex::indexedLines() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return complete ? totalLines : (checkpoints.size() - 1) * checkpointInterval;
+}
+
+/**
+ * Summary: Loads the index from a sidecar file, if it was written for this exact version of the file.
+ *
+ * @param const string &path sidecar filename
+ * @param const FileSignature &signature of the file being opened
+ * @return true if the index was loaded, false if the sidecar is missing, stale or damaged
+ */
+bool LineIndex::load(const std::string &path, const FileSignature &signature) {
+
+    std::ifstream sidecar(path, std::ios::binary);
+    if (sidecar.fail()) {
+        return false;
+    }
+
+    SidecarHeader header;
+    if (!sidecar.read((char*) &header, sizeof(header))
+            || header.magic != SidecarMagic || header.version != SidecarVersion || header.interval == 0
+            || header.size != signature.size || header.modified != signature.modified
+            || header.sample != signature.sample) {
+        return false;
+    }
+
+    // The file can't have more checkpoints than bytes, anything else is a damaged sidecar
+    if (header.totalLines == 0 || header.checkpointCount > header.size + 1
+            || header.checkpointCount != (header.totalLines - 1) / header.interval + 1) {
+        return false;
+    }
+
+    std::vector<uint64_t> loaded((size_t) header.checkpointCount);
+    uint64_t checksum = 0;
+    if (!sidecar.read((char*) loaded.data(), (std::streamsize) (loaded.size() * sizeof(uint64_t)))
+            || !sidecar.read((char*) &checksum, sizeof(checksum))) {
+        return false;
+    }
+
+    uint64_t expected = mixHash(hashLine((const char*) &header, sizeof(header))
+                                ^ hashLine((const char*) loaded.data(), loaded.size() * sizeof(uint64_t)));
+    if (checksum != expected) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    checkpointInterval = header.interval;
+    checkpoints.swap(loaded);
+    totalLines = header.totalLines;
+    complete = true;
+    progress.notify_all();
+    return true;
+} // end load method
+
+/**
+ * Summary: Writes the finished index to a sidecar file. Written to a temporary name first and renamed
+ * into place, so a reader never sees half a sidecar.
+ *
+ * @param const string &path sidecar filename
+ * @param const FileSignature &signature of the file that was indexed
+ * @return true if the sidecar was written
+ */
+bool LineIndex::save(const std::string &path, const FileSignature &signature) const {
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (!complete) {
+        return false;
+    }
+
+    SidecarHeader header;
+    std::memset(&header, 0, sizeof(header)); // no uninitialized padding in the file
+    header.magic = SidecarMagic;
+    header.version = SidecarVersion;
+    header.interval = (uint32_t) checkpointInterval;
+    header.size = signature.size;
+    header.modified = signature.modified;
+    header.sample = signature.sample;
+    header.totalLines = totalLines;
+    header.checkpointCount = checkpoints.size();
+
+    uint64_t checksum = mixHash(hashLine((const char*) &header, sizeof(header))
+                                ^ hashLine((const char*) checkpoints.data(), checkpoints.size() * sizeof(uint64_t)));
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream sidecar(temporary, std::ios::binary | std::ios::trunc);
+        sidecar.write((const char*) &header, sizeof(header));
+        sidecar.write((const char*) checkpoints.data(), (std::streamsize) (checkpoints.size() * sizeof(uint64_t)));
+        sidecar.write((const char*) &checksum, sizeof(checksum));
+        sidecar.close();
+
+        if (sidecar.fail()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // rename won't replace an existing file on Windows
+    std::remove(path.c_str());
+#endif
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+} // end save method
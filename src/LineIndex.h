@@ -0,0 +1,77 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * LineIndex .h header file
+ *
+ * Sparse index of line starts in a file: the byte offset of every 4096th line.
+ * Finding any line means jumping to the checkpoint before it and scanning at most 4095 lines.
+ * The index can be built on one thread while another is already looking lines up.
+ *
+ * A finished index can be saved next to the file (file.sqidx) and loaded the next time the file is
+ * opened instead of scanning it again. The sidecar records the file's size, modification time and a
+ * hash of a few sampled blocks, a sidecar that doesn't match the file any more is ignored.
+ */
+
+#ifndef SPARQ_LINEINDEX_H
+#define SPARQ_LINEINDEX_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class MappedFile;
+
+// What a sidecar has to match to be trusted
+struct FileSignature {
+    uint64_t size;
+    int64_t modified;
+    uint64_t sample; // hash of blocks sampled across the file
+
+    static FileSignature takeSignature(const MappedFile &file);
+    bool operator==(const FileSignature &other) const {
+        return size == other.size && modified == other.modified && sample == other.sample;
+    }
+};
+
+class LineIndex {
+
+private:
+    uint64_t checkpointInterval;
+    std::vector<uint64_t> checkpoints; // offset of line 1, 1 + interval, 1 + 2 * interval, ...
+    uint64_t totalLines; // only valid once complete
+    bool complete;
+    mutable std::mutex lock;
+    std::condition_variable progress;
+
+public:
+    static const uint64_t DefaultInterval = 4096;
+    static const uint64_t MinSidecarSize = 1 << 20; // smaller files are quicker to scan than to check
+
+    static std::string sidecarPath(const std::string &filename);
+
+    explicit LineIndex(uint64_t interval = DefaultInterval);
+
+    void build(const char* data, uint64_t size, const std::atomic<bool>* stop = nullptr);
+    void addCheckpoint(uint64_t offset); // building it while the file is written instead of scanning it
+    void finish(uint64_t lines);
+    bool checkpoint(uint64_t line, uint64_t* offset); // waits until the checkpoint for line is known
+    uint64_t lineCount(); // waits for the whole file to be indexed
+
+    bool load(const std::string &path, const FileSignature &signature);
+    bool save(const std::string &path, const FileSignature &signature) const;
+
+    uint64_t interval() const { return checkpointInterval; }
+    bool isComplete() const;
+    uint64_t indexedLines() const;
+};
+
+#endif //SPARQ_LINEINDEX_H
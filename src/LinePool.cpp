@@ -0,0 +1,122 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * LinePool .cpp implementation file
+ */
+
+#include "LinePool.h"
+#include "LineHash.h"
+
+// Strings this short live inside the std::string object itself (libstdc++ and MSVC both use 15)
+static const size_t ShortStringCapacity = 15;
+
+// Rough cost of one hash table node (key, value, next pointer and cached hash)
+static const size_t TableNodeBytes = 4 * sizeof(void*);
+
+/**
+ * Summary: Heap bytes a string of this length would allocate outside the string object.
+ *
+ * @param size_t length
+ * @return bytes
+ */
+static size_t heapBytes(size_t length) {
+    return length > ShortStringCapacity ? length + 1 : 0;
+} // end heapBytes function
+
+// Constructor
+LinePool::LinePool() : references(0) {}
+
+// Destructor
+LinePool::~LinePool() {
+    for (auto &item : entries) {
+        delete item.second;
+    }
+}
+
+/**
+ * Summary: Returns the shared entry for this text, adding one reference.
+ * Creates the entry if no equal line is in the pool yet.
+ *
+ * @param string &&text
+ * @return Entry*
+ */
+LinePool::Entry* LinePool::intern(std::string &&text) {
+
+    uint64_t hash = hashLine(text);
+
+    // Look for an equal line among the entries with the same hash
+    auto range = entries.equal_range(hash);
+    for (auto i = range.first; i != range.second; ++i) {
+        if (i->second->text == text) {
+            acquire(i->second);
+            return i->second;
+        }
+    }
+
+    Entry* entry = new Entry{std::move(text), hash, 1, this};
+    entry->text.shrink_to_fit();
+    entries.emplace(hash, entry);
+    references++;
+
+    return entry;
+} // end intern method
+
+/**
+ * Summary: Adds a reference to an entry that is already shared.
+ *
+ * @param Entry *entry
+ */
+void LinePool::acquire(Entry* entry) {
+    entry->refs++;
+    references++;
+} // end acquire method
+
+/**
+ * Summary: Drops a reference, freeing the entry when no node uses it anymore.
+ *
+ * @param Entry *entry
+ */
+void LinePool::release(Entry* entry) {
+
+    references--;
+
+    if (--entry->refs > 0) {
+        return;
+    }
+
+    // Last reference, remove it from the table
+    auto range = entries.equal_range(entry->hash);
+    for (auto i = range.first; i != range.second; ++i) {
+        if (i->second == entry) {
+            entries.erase(i);
+            break;
+        }
+    }
+
+    delete entry;
+} // end release method
+
+/**
+ * Summary: Estimates the memory the pooled lines use, and what they would use with one copy per node.
+ *
+ * @param size_t *pooledBytes
+ * @param size_t *unpooledBytes
+ */
+void LinePool::memoryUsage(size_t *pooledBytes, size_t *unpooledBytes) const {
+
+    *pooledBytes = entries.bucket_count() * sizeof(void*);
+    *unpooledBytes = 0;
+
+    for (auto &item : entries) {
+        size_t textBytes = heapBytes(item.second->text.size());
+
+        *pooledBytes += sizeof(Entry) + TableNodeBytes + textBytes;
+        *unpooledBytes += item.second->refs * textBytes;
+    }
+} // end memoryUsage method
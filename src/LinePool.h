@@ -0,0 +1,50 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * LinePool .h header file
+ *
+ * Hash consed pool of line text. Nodes with identical lines share one reference counted copy.
+ */
+
+#ifndef SPARQ_LINEPOOL_H
+#define SPARQ_LINEPOOL_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+class LinePool {
+
+public:
+    // One unique line of text and how many nodes share it
+    struct Entry {
+        std::string text;
+        uint64_t hash;
+        size_t refs;
+        LinePool* pool; // so a node can release the entry without knowing the pool
+    };
+
+private:
+    std::unordered_multimap<uint64_t, Entry*> entries; // keyed on the line hash
+    size_t references; // total refs across all entries
+
+public:
+    LinePool();
+    virtual ~LinePool();
+
+    Entry* intern(std::string &&text);
+    void acquire(Entry* entry);
+    void release(Entry* entry);
+
+    size_t uniqueLines() const { return entries.size(); }
+    size_t sharedLines() const { return references; }
+    void memoryUsage(size_t *pooledBytes, size_t *unpooledBytes) const;
+};
+
+#endif //SPARQ_LINEPOOL_H
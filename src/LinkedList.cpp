@@ -15,12 +15,51 @@
 #include <string>
 
 // Constructor
-LinkedList::LinkedList() : start(nullptr) {
+LinkedList::LinkedList() : start(nullptr), tail(nullptr), version(0) {
 
 }
 
+// Lines this long or shorter fit inside std::string itself, so sharing them saves nothing
+static const size_t MinInternLength = 16;
+
+// Nodes allocated at a time by the node arena
+static const size_t NodesPerSlab = 4096;
+
+/**
+ * Summary: The arena every list's nodes come from. Never destroyed, nodes retired by a list can be
+ * freed late during exit.
+ *
+ * @return NodeArena&
+ */
+static NodeArena &nodeArena() {
+    static NodeArena* arena = new NodeArena(sizeof(Node), NodesPerSlab);
+    return *arena;
+} // end nodeArena function
+
+// The arena's slots are sizeof(Node), anything bigger (a class derived from Node) comes from the heap
+void* Node::operator new(size_t size) {
+    if (size != sizeof(Node)) {
+        return ::operator new(size);
+    }
+    return nodeArena().allocate();
+}
+
+void Node::operator delete(void* node, size_t size) {
+    if (size != sizeof(Node)) {
+        ::operator delete(node);
+        return;
+    }
+    nodeArena().release(node);
+}
+
 // Destructor
 LinkedList::~LinkedList() {
+
+    // Nodes still waiting for readers go first, they need the pool and store that are about to go
+    if (epoch != nullptr) {
+        epoch->drain();
+    }
+
     Node* node = start;
 
     while (node != nullptr) {
@@ -30,6 +69,31 @@ LinkedList::~LinkedList() {
     }
 }
 
+/**
+ * Summary: Creates a node for a line. In interning mode the text is shared through the pool,
+ * with a block store the line joins the block being filled (block storage wins if both are set).
+ *
+ * @param int index
+ * @param string &&data
+ * @return Node*
+ */
+Node* LinkedList::newNode(int index, std::string &&data) {
+
+    Node* node = new Node();
+    node->index = index;
+
+    if (store != nullptr) {
+        node->data = std::move(data);
+        store->append(node);
+    } else if (pool != nullptr && data.size() >= MinInternLength) {
+        node->shared = pool->intern(std::move(data));
+    } else {
+        node->data = std::move(data);
+    }
+
+    return node;
+}
+
 /**
  * Summary: Adds a node to the end of the linked list.
  *
@@ -38,33 +102,20 @@ LinkedList::~LinkedList() {
  */
 void LinkedList::Add(int index,std::string data) {
 
-    Node* newNode = new Node();
-    newNode->index = index;
-    newNode->data = data;
+    version++;
+
+    Node* newNode = this->newNode(index, std::move(data));
 
     if (start == nullptr) {
         // start a new chain
-        start = newNode;
+        publish(start, newNode);
     } else {   // start pointer isn't null
         // add to the end of an existing chain
-        Node* node = start;
-        Node* prev = nullptr;
-
-        // Loop until the end of the chain
-        while (node != nullptr) {
-
-            // set prev pointer to the node we were just at
-            prev = node;
-
-            // move to next node
-            node = node->next;
-        }
-
-        // if the end was found, attach new node
-        if (prev != nullptr) {
-            prev->next = newNode;
-        }
+        publish(tail->next, newNode);
     }
+
+    // the new node is always the end of the chain
+    tail = newNode;
 }
 
 /**
@@ -73,6 +124,7 @@ void LinkedList::Add(int index,std::string data) {
  * @param int index
  */
 void LinkedList::Delete(int index) {
+    version++;
     // find the node
     // note the next pointer
     // update previous node's next pointer
@@ -98,19 +150,71 @@ void LinkedList::Delete(int index) {
         // Are we deleting the start node?
         if(prev == nullptr) { // or is node == start
             // point the start to the second node
-            start = node->next;
+            publish(start, node->next);
         } else {
             // deleting any other node but the first
-            prev->next = node->next; // detaching the node
+            publish(prev->next, node->next); // detaching the node
         }
 
-        delete node; // THEN WE CAN DELETE IT
+        // Are we deleting the end node?
+        if (node == tail) {
+            tail = prev;
+        }
+
+        discard(node); // THEN WE CAN DELETE IT
 
     } else {
         std::cout << "Node not found." << std::endl;
     }
 }
 
+/**
+ * Summary: Deletes every node from line first to line last (inclusive) that shouldDelete returns true for.
+ * Walks the chain once, so removing many lines doesn't search from the start for each one.
+ * Indexes are not touched, call reorderIndexes() afterwards.
+ *
+ * @param int first
+ * @param int last
+ * @param function shouldDelete
+ * @return how many nodes were deleted
+ */
+int LinkedList::DeleteWhere(int first, int last, const std::function<bool(Node*)> &shouldDelete) {
+
+    version++;
+
+    int deleted = 0;
+    Node* node = start;
+    Node* prev = nullptr;
+
+    // Loop through the list, stopping once we pass the last line
+    while (node != nullptr && node->index <= last) {
+
+        Node* next = node->next;
+
+        if (node->index >= first && shouldDelete(node)) {
+            // detach the node from the chain
+            if (prev == nullptr) {
+                publish(start, next);
+            } else {
+                publish(prev->next, next);
+            }
+
+            if (node == tail) {
+                tail = prev;
+            }
+
+            discard(node);
+            deleted++;
+        } else {
+            prev = node;
+        }
+
+        node = next;
+    }
+
+    return deleted;
+}
+
 /**
  * Summary: Inserts a node at the before index, pushes all nodes forward in the chain.
  *
@@ -120,9 +224,9 @@ void LinkedList::Delete(int index) {
  */
 void LinkedList::Insert(int before, int index, std::string data) {
 
-    Node* newNode = new Node();
-    newNode->index = index;
-    newNode->data = data;
+    version++;
+
+    Node* newNode = this->newNode(index, std::move(data));
 
     Node* node = start;
     Node* prev = nullptr;
@@ -145,12 +249,14 @@ void LinkedList::Insert(int before, int index, std::string data) {
 
             // make the new node the new starting node
             newNode->next = start;
-            start = newNode;
+            publish(start, newNode);
         } else {
             // insert the new node in the chain
             newNode->next = prev->next;
-            prev->next = newNode;
+            publish(prev->next, newNode);
         }
+    } else {
+        delete newNode; // nowhere to put it
     }
 }
 
@@ -161,7 +267,7 @@ std::ostream &operator<<(std::ostream &output, LinkedList &list) {
 
     // Print line number followed by the node's string data and end the line
     while (node != nullptr) {
-        output << node->index << "> " << node->data << std::endl;
+        output << node->index << "> " << node->line() << std::endl;
 
         node = node->next;
     }
@@ -203,5 +309,464 @@ void LinkedList::reorderIndexes() {
     }
 }
 
+/**
+ * Summary: Collects the nodes from line first to line last (inclusive) in list order.
+ * The nodes stay in the chain, only pointers to them are handed out.
+ *
+ * @param int first
+ * @param int last
+ * @param vector<Node*> &nodes
+ */
+void LinkedList::collectRange(int first, int last, std::vector<Node*> &nodes) {
+
+    nodes.clear();
+
+    // Loop through the list, stopping once we pass the last line
+    for (Node* node = start; node != nullptr && node->index <= last; node = node->next) {
+
+        if (node->index >= first) {
+            nodes.push_back(node);
+        }
+    }
+}
+
+/**
+ * Summary: Relinks the nodes from line first to line last in the order given.
+ * The nodes must be the ones collectRange() returned for the same lines, no line data is copied.
+ * Indexes are not touched, call reorderIndexes() afterwards.
+ *
+ * In concurrent mode readers may be walking those nodes, so copies are linked in their place
+ * and the originals retired.
+ *
+ * @param int first
+ * @param int last
+ * @param const vector<Node*> &nodes
+ */
+void LinkedList::relinkRange(int first, int last, const std::vector<Node*> &nodes) {
+
+    version++;
+
+    if (epoch == nullptr) {
+        linkRange(first, last, nodes);
+        return;
+    }
+
+    std::vector<Node*> copies;
+    copies.reserve(nodes.size());
+    for (Node* node : nodes) {
+        copies.push_back(newNode(node->index, std::string(node->line())));
+    }
+
+    linkRange(first, last, copies);
+
+    for (Node* node : nodes) {
+        discard(node);
+    }
+}
+
+/**
+ * Summary: Links nodes in place of the lines from first to last, chaining them together before the
+ * chain is attached so the range changes all at once.
+ *
+ * @param int first
+ * @param int last
+ * @param const vector<Node*> &nodes
+ */
+void LinkedList::linkRange(int first, int last, const std::vector<Node*> &nodes) {
+
+    if (nodes.empty()) {
+        return;
+    }
+
+    Node* node = start;
+    Node* prev = nullptr;
+
+    // find the node before the range
+    while (node != nullptr && node->index < first) {
+        prev = node;
+        node = node->next;
+    }
+
+    // find the node after the range
+    while (node != nullptr && node->index <= last) {
+        node = node->next;
+    }
+    Node* after = node;
+
+    // Chain the nodes together in their new order
+    for (size_t i = 0; i + 1 < nodes.size(); ++i) {
+        nodes[i]->next = nodes[i + 1];
+    }
+    nodes.back()->next = after;
+
+    // Attach the range back into the chain
+    if (prev == nullptr) {
+        publish(start, nodes.front());
+    } else {
+        publish(prev->next, nodes.front());
+    }
+
+    // Was the range at the end of the chain?
+    if (after == nullptr) {
+        tail = nodes.back();
+    }
+}
+
+/**
+ * Summary: Replaces the lines from first to last with new lines, taken one at a time from nextLine
+ * until it returns false. The new lines are stored like freshly loaded ones (compressed or interned),
+ * so a huge range never has to be held as plain strings.
+ * Indexes are not touched, call reorderIndexes() afterwards.
+ *
+ * @param int first
+ * @param int last
+ * @param const function<bool(string &)> &nextLine
+ */
+void LinkedList::replaceRange(int first, int last, const std::function<bool(std::string &)> &nextLine) {
+
+    version++;
+
+    std::vector<Node*> oldNodes;
+    std::vector<Node*> newNodes;
+    std::string line;
+
+    collectRange(first, last, oldNodes);
+
+    // If the lines stop coming with an exception the list is left as it was
+    try {
+        while (nextLine(line)) {
+            newNodes.push_back(newNode(first, std::move(line)));
+            line.clear();
+        }
+    }
+    catch (...) {
+        for (Node* node : newNodes) {
+            delete node;
+        }
+        throw;
+    }
+
+    if (newNodes.empty() || oldNodes.empty()) {
+        for (Node* node : newNodes) {
+            delete node;
+        }
+        return;
+    }
+
+    // The new nodes aren't in the chain yet, so they can be linked in without copying
+    linkRange(first, last, newNodes);
+
+    for (Node* node : oldNodes) {
+        discard(node);
+    }
+}
+
+/**
+ * Summary: Applies replacements sorted by line and not overlapping, in one walk down the list.
+ * Line numbers in the patches are from before any of them is applied. Only the nodes around each
+ * patch are relinked, and indexes are renumbered from the first patch to the last node whose
+ * number changed.
+ *
+ * @param vector<LinePatch> &patches the new lines are moved out
+ */
+void LinkedList::applyPatches(std::vector<LinePatch> &patches) {
+
+    if (patches.empty()) {
+        return;
+    }
+    version++;
+
+    Node* node = start;
+    Node* prev = nullptr;
+    int line = 1; // old number of node
+    int shift = 0; // new number minus old number
+
+    for (LinePatch &patch : patches) {
+
+        // Walk to the first replaced line, renumbering what was shifted by earlier patches
+        while (node != nullptr && line < patch.first) {
+            node->index = line + shift;
+            prev = node;
+            node = node->next;
+            line++;
+        }
+
+        // Find the end of the replaced lines
+        Node* replaced = node;
+        int removed = 0;
+        while (removed < patch.count && node != nullptr) {
+            node = node->next;
+            line++;
+            removed++;
+        }
+        shift -= removed;
+
+        // Chain the new lines together first, so the range changes all at once
+        Node* head = node;
+        Node* added = nullptr;
+        for (std::string &text : patch.lines) {
+            Node* created = newNode(line + shift, std::move(text));
+            if (added == nullptr) {
+                head = created;
+            } else {
+                added->next = created;
+            }
+            added = created;
+            shift++;
+        }
+        if (added != nullptr) {
+            added->next = node;
+        }
+
+        if (prev == nullptr) {
+            publish(start, head);
+        } else {
+            publish(prev->next, head);
+        }
+
+        // The replaced lines still link to each other, which is all a reader on them needs
+        for (int i = 0; i < removed; i++) {
+            Node* next = replaced->next;
+            discard(replaced);
+            replaced = next;
+        }
+
+        if (added != nullptr) {
+            prev = added;
+        }
+        if (node == nullptr) {
+            tail = prev;
+        }
+    }
+
+    // Lines after the last patch only need new numbers if the count changed
+    if (shift != 0) {
+        for (; node != nullptr; node = node->next) {
+            node->index = line + shift;
+            line++;
+        }
+    }
+}
+
+/**
+ * Summary: Changes the text of a line. In concurrent mode a reader may be reading the old text,
+ * so a copy with the new text takes the node's place (which walks the list to find the node before it).
+ *
+ * @param Node *node
+ * @param string text
+ */
+void LinkedList::setLine(Node* node, std::string text) {
+
+    version++;
+
+    if (epoch == nullptr) {
+        node->setLine(std::move(text));
+        return;
+    }
+
+    Node* prev = nullptr;
+    for (Node* at = start; at != node; at = at->next) {
+        prev = at;
+    }
+
+    Node* copy = newNode(node->index, std::move(text));
+    copy->next = node->next;
+
+    if (prev == nullptr) {
+        publish(start, copy);
+    } else {
+        publish(prev->next, copy);
+    }
+    if (tail == node) {
+        tail = copy;
+    }
+
+    discard(node);
+}
+
+/**
+ * Summary: Makes a node taken from another list keep its line the way this list does. The line
+ * leaves the other list's block or pool and joins this list's, the node itself stays where it is.
+ *
+ * @param Node *node
+ */
+void LinkedList::adopt(Node* node) {
+
+    if (node->block != nullptr) {
+        node->line(); // decompresses it into data
+        node->block->store->detach(node);
+    }
+    if (node->shared != nullptr && node->shared->pool != pool.get()) {
+        node->setLine(std::string(node->shared->text));
+    }
+
+    if (store != nullptr) {
+        store->append(node);
+    } else if (pool != nullptr && node->shared == nullptr && node->data.size() >= MinInternLength) {
+        node->shared = pool->intern(std::move(node->data));
+        node->data.clear();
+    }
+} // end adopt method
+
+/**
+ * Summary: Links a chain of nodes in before line before (at the end when there is no such line)
+ * and renumbers the lines.
+ *
+ * @param Node *first
+ * @param Node *last
+ * @param int before
+ */
+void LinkedList::linkChain(Node* first, Node* last, int before) {
+
+    version++;
+
+    Node* node = start;
+    Node* prev = nullptr;
+    while (node != nullptr && node->index < before) {
+        prev = node;
+        node = node->next;
+    }
+
+    // The chain is complete before it is published
+    last->next = node;
+    if (prev == nullptr) {
+        publish(start, first);
+    } else {
+        publish(prev->next, first);
+    }
+    if (node == nullptr) {
+        tail = last;
+    }
 
+    reorderIndexes();
+} // end linkChain method
 
+/**
+ * Summary: Copies lines first to last of another list in before line before of this one.
+ *
+ * @param LinkedList &source
+ * @param int first
+ * @param int last
+ * @param int before
+ */
+void LinkedList::copyRangeFrom(LinkedList &source, int first, int last, int before) {
+
+    Node* chainFirst = nullptr;
+    Node* chainLast = nullptr;
+
+    try {
+        for (Node* node = source.start; node != nullptr && node->index <= last; node = node->next) {
+            if (node->index < first) {
+                continue;
+            }
+
+            Node* copy = newNode(node->index, std::string(node->line()));
+            if (chainLast == nullptr) {
+                chainFirst = copy;
+            } else {
+                chainLast->next = copy;
+            }
+            chainLast = copy;
+        }
+    }
+    catch (...) {
+        // A line that couldn't be read back, the copies made so far are dropped
+        while (chainFirst != nullptr) {
+            Node* next = chainFirst->next;
+            delete chainFirst;
+            chainFirst = next;
+        }
+        throw;
+    }
+
+    if (chainFirst != nullptr) {
+        linkChain(chainFirst, chainLast, before);
+    }
+} // end copyRangeFrom method
+
+/**
+ * Summary: Moves lines first to last of another list in before line before of this one. The nodes
+ * are unlinked from one chain and linked into the other, no line is copied unless the lists store
+ * lines differently (a block store or pool is per list).
+ *
+ * In concurrent mode readers may be walking those nodes, so they are copied and the originals retired.
+ *
+ * @param LinkedList &source
+ * @param int first
+ * @param int last
+ * @param int before
+ */
+void LinkedList::moveRangeFrom(LinkedList &source, int first, int last, int before) {
+
+    if (epoch != nullptr || source.epoch != nullptr) {
+        copyRangeFrom(source, first, last, before);
+        source.DeleteWhere(first, last, [](Node*) { return true; });
+        source.reorderIndexes();
+        return;
+    }
+
+    // Find the run of nodes in the other list
+    Node* node = source.start;
+    Node* prev = nullptr;
+    while (node != nullptr && node->index < first) {
+        prev = node;
+        node = node->next;
+    }
+    if (node == nullptr || node->index > last) {
+        return;
+    }
+
+    Node* chainFirst = node;
+    Node* chainLast = node;
+    while (chainLast->next != nullptr && chainLast->next->index <= last) {
+        chainLast = chainLast->next;
+    }
+
+    // Read the lines out of the other list's blocks before anything is unlinked, so a block that
+    // can't be read leaves both lists whole
+    for (Node* moving = chainFirst; moving != chainLast->next; moving = moving->next) {
+        if (moving->block != nullptr && moving->block->store != store.get()) {
+            moving->line();
+            moving->block->store->detach(moving);
+        }
+    }
+
+    // Unlink it there
+    if (prev == nullptr) {
+        source.start = chainLast->next;
+    } else {
+        prev->next = chainLast->next;
+    }
+    if (source.tail == chainLast) {
+        source.tail = prev;
+    }
+    chainLast->next = nullptr;
+    source.version++;
+    source.reorderIndexes();
+
+    for (Node* moved = chainFirst; moved != nullptr; moved = moved->next) {
+        adopt(moved);
+    }
+
+    linkChain(chainFirst, chainLast, before);
+} // end moveRangeFrom method
+
+/**
+ * Summary: Turns concurrent mode on or off. Only call it while no other thread is reading the list.
+ *
+ * @param bool on
+ * @return false if the lines are in a block store, whose reads decompress into the nodes
+ */
+bool LinkedList::setConcurrent(bool on) {
+
+    if (on && store != nullptr) {
+        return false;
+    }
+
+    if (on && epoch == nullptr) {
+        epoch.reset(new EpochManager());
+    } else if (!on && epoch != nullptr) {
+        epoch.reset(); // frees whatever was retired
+    }
+    return true;
+}
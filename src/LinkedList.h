@@ -13,21 +13,104 @@
 #ifndef ASSIGNMENT1_LINKEDLIST_H
 #define ASSIGNMENT1_LINKEDLIST_H
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
+
+#include "LinePool.h"
+#include "BlockStore.h"
+#include "Epoch.h"
+#include "NodeArena.h"
+
 // Internal data class
 class Node {
 public:
-    int index; // to keep track of the line number
-    std::string data; // the string data to be stored
+    int index; // to keep track of the line number, renumbered in place so concurrent readers never read it
+    int blockSlot; // position of the node in its block, next to index so they share 8 bytes
+    std::string data; // the string data to be stored, empty when the line is shared from a pool
+    LinePool::Entry* shared; // the interned copy of the line, or nullptr when data holds it
+    BlockStore::Block* block; // the compressed block holding the line, or nullptr
     Node* next; // a pointer to the next node in the chain
 
-    Node() : index(-1), data(), next(nullptr) {} // constructor
+    Node() : index(-1), blockSlot(-1), data(), shared(nullptr), block(nullptr), next(nullptr) {} // constructor
+    Node(const Node &) = delete;
+
+    // Nodes come from the arena every list shares, so they can move between lists
+    static void* operator new(size_t size);
+    static void operator delete(void* node, size_t size);
+    ~Node() {
+        if (shared != nullptr) { shared->pool->release(shared); }
+        if (block != nullptr) { block->store->detach(this); }
+    }
+
+    // The line text, wherever it is stored. A compressed line is decompressed into data first.
+    const std::string &line() const {
+        if (block != nullptr) {
+            block->store->touch(block);
+            return data;
+        }
+        return shared != nullptr ? shared->text : data;
+    }
+
+    // Replace the line text, a shared or compressed line is copied on write and stops being shared
+    void setLine(std::string text) {
+        if (shared != nullptr) {
+            shared->pool->release(shared);
+            shared = nullptr;
+        }
+        if (block != nullptr) {
+            block->store->detach(this);
+        }
+        data = std::move(text);
+    }
+};
+
+// Lines first to first + count - 1 replaced with new lines, count 0 inserts before line first
+struct LinePatch {
+    int first;
+    int count;
+    std::vector<std::string> lines;
 };
 
 class LinkedList {
 
 private:
     Node* start;
+    Node* tail; // last node in the chain, so Add() doesn't have to walk the list
+    std::shared_ptr<LinePool> pool; // identical lines share storage when set (interning mode)
+    std::shared_ptr<BlockStore> store; // lines are kept compressed in blocks when set
+    std::unique_ptr<EpochManager> epoch; // set in concurrent mode, unlinked nodes are retired through it
+    uint64_t version; // counts changes to the lines
+
+    Node* newNode(int index, std::string &&data);
+    void adopt(Node* node);
+    void linkRange(int first, int last, const std::vector<Node*> &nodes);
+    void linkChain(Node* first, Node* last, int before);
+    static void destroyNode(void* node) { delete (Node*) node; }
+
+    // Points a link at a node. In concurrent mode the node is complete before readers can see it.
+    void publish(Node* &link, Node* value) {
+        if (epoch != nullptr) {
+#if defined(__GNUC__) || defined(__clang__)
+            __atomic_store_n(&link, value, __ATOMIC_RELEASE);
+#else
+            std::atomic_thread_fence(std::memory_order_release);
+            *(Node* volatile*) &link = value;
+#endif
+        } else {
+            link = value;
+        }
+    }
+
+    // Frees an unlinked node, or in concurrent mode once no reader can still be on it
+    void discard(Node* node) {
+        if (epoch != nullptr) {
+            epoch->retire(node, destroyNode);
+        } else {
+            delete node;
+        }
+    }
 
 public:
     class iterator { // like STL C++ library used on vectors
@@ -39,13 +122,33 @@ public:
         iterator(Node* node) : node(node) {}
 
         // Overloaded Ops
-        std::string operator*(){ return node->data; }
+        const std::string &operator*(){ return node->line(); }
         bool operator!=(iterator it){ return this->node != it.node; }
         bool operator==(iterator it){ return this->node == it.node; }
         iterator& operator++() { node = node->next; return *this; }
         // operator--() wouldn't be able unless we add prev pointers to each node
     };
 
+    // Held by a thread reading the list while another thread edits it (concurrent mode only)
+    class ReadGuard {
+    private:
+        EpochManager::Guard guard;
+    public:
+        explicit ReadGuard(LinkedList &list) : guard(*list.epoch) {}
+    };
+
+    // A reader's place in the list in concurrent mode. Only the text can be read through it: the
+    // writer renumbers lines in place, so a reader counts lines itself as it goes.
+    class ReadCursor {
+    private:
+        const Node* node;
+    public:
+        explicit ReadCursor(const Node* node) : node(node) {}
+        bool atEnd() const { return node == nullptr; }
+        const std::string &line() const { return node->line(); }
+        void next() { node = readLink(node->next); }
+    };
+
     LinkedList();
 
     virtual ~LinkedList();
@@ -53,10 +156,46 @@ public:
     void Add(int index, std::string data); // Insert on specified line
     void Delete(int index); // Delete by index
     void Insert( int before, int index, std::string data); // Insert before specified line
+    int DeleteWhere(int first, int last, const std::function<bool(Node*)> &shouldDelete); // Delete matching lines in one pass
 
     int getLineCount();
+    Node* last() { return tail; } // last line, nullptr when the list is empty
+    uint64_t getVersion() const { return version; } // changes whenever the lines do
     void reorderIndexes();
 
+    void setPool(std::shared_ptr<LinePool> linePool) { pool = std::move(linePool); } // Turn interning on (or off with nullptr)
+    LinePool* getPool() { return pool.get(); }
+    void setStore(std::shared_ptr<BlockStore> blockStore) { store = std::move(blockStore); } // Turn block compression on
+    BlockStore* getStore() { return store.get(); }
+
+    void collectRange(int first, int last, std::vector<Node*> &nodes); // Nodes from line first to last
+    void relinkRange(int first, int last, const std::vector<Node*> &nodes); // Put those nodes back in a new order
+    void replaceRange(int first, int last, const std::function<bool(std::string &)> &nextLine); // New lines for first to last
+    void applyPatches(std::vector<LinePatch> &patches); // Several replacements in one pass, renumbers lines
+    void setLine(Node* node, std::string text); // Change a line's text, copied in concurrent mode
+    void copyRangeFrom(LinkedList &source, int first, int last, int before); // Copies of another list's lines, renumbers both
+    void moveRangeFrom(LinkedList &source, int first, int last, int before); // Relinks another list's nodes, renumbers both
+
+    // Concurrent mode: one thread edits while others read under a ReadGuard with a ReadCursor from
+    // readStart(). Readers see every line as it was before or after each edit, never half of one.
+    bool setConcurrent(bool on); // false if lines are in a block store, reading them isn't thread safe
+    bool isConcurrent() const { return epoch != nullptr; }
+    EpochManager* getEpoch() { return epoch.get(); }
+
+    ReadCursor readStart() const { return ReadCursor(readLink(start)); }
+
+private:
+    static const Node* readLink(Node* const &link) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __atomic_load_n(&link, __ATOMIC_ACQUIRE);
+#else
+        const Node* node = *(Node* const volatile*) &link;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return node;
+#endif
+    }
+
+public:
     friend std::ostream& operator<<(std::ostream& output, LinkedList& list);
 
     // Begin is a wrapper for start pointer
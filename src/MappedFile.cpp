@@ -0,0 +1,89 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * MappedFile .cpp implementation file
+ */
+
+#include "MappedFile.h"
+#include "Editor.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+/**
+ * Constructor
+ *
+ * Maps the file read-only. Throws FileFailedToOpenException if it can't be opened.
+ *
+ * @param const string &filename
+ */
+MappedFile::MappedFile(const std::string &filename) : bytes(nullptr), length(0), modified(0) {
+
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw FileFailedToOpenException();
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw FileFailedToOpenException();
+    }
+    length = (uint64_t) info.st_size;
+#ifdef __APPLE__
+    modified = (int64_t) info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    modified = (int64_t) info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+
+    // An empty file can't be mapped, and doesn't need to be
+    if (length == 0) {
+        bytes = "";
+    } else {
+        void* mapping = mmap(nullptr, (size_t) length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw FileFailedToOpenException();
+        }
+        bytes = (const char*) mapping;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+#else
+    std::ifstream myFileIn(filename, std::ios::binary);
+    if (myFileIn.fail()) {
+        throw FileFailedToOpenException();
+    }
+    std::ostringstream contents;
+    contents << myFileIn.rdbuf();
+    fallback = contents.str();
+    bytes = fallback.data();
+    length = fallback.size();
+#endif
+} // end MappedFile constructor
+
+/**
+ * Destructor
+ */
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (length > 0) {
+        munmap((void*) bytes, (size_t) length);
+    }
+#endif
+}
@@ -0,0 +1,40 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * MappedFile .h header file
+ *
+ * Read-only view of a whole file. Memory mapped where the system supports it, so only the
+ * pages that are actually read are loaded.
+ */
+
+#ifndef SPARQ_MAPPEDFILE_H
+#define SPARQ_MAPPEDFILE_H
+
+#include <cstdint>
+#include <string>
+
+class MappedFile {
+
+private:
+    const char* bytes;
+    uint64_t length;
+    int64_t modified; // modification time in nanoseconds, 0 if unknown
+    std::string fallback; // file contents when mapping isn't available
+
+public:
+    explicit MappedFile(const std::string &filename);
+    virtual ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+
+    const char* data() const { return bytes; }
+    uint64_t size() const { return length; }
+    int64_t modifiedTime() const { return modified; }
+};
+
+#endif //SPARQ_MAPPEDFILE_H
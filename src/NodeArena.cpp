@@ -0,0 +1,194 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * NodeArena .cpp implementation file
+ */
+
+#include "NodeArena.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+/**
+ * Summary: Allocates memory aligned to its own size.
+ *
+ * @param size_t bytes a power of two
+ * @return memory, throws bad_alloc if there is none
+ */
+static void* allocateAligned(size_t bytes) {
+#ifdef _WIN32
+    void* memory = _aligned_malloc(bytes, bytes);
+#else
+    void* memory = nullptr;
+    if (posix_memalign(&memory, bytes, bytes) != 0) {
+        memory = nullptr;
+    }
+#endif
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+} // end allocateAligned function
+
+static void freeAligned(void* memory) {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+} // end freeAligned function
+
+/**
+ * Constructor
+ *
+ * @param size_t slotSize bytes in each slot, rounded up so every slot stays aligned
+ * @param size_t slotsPerSlab about how many slots each slab has, the slab is rounded to a power of two
+ */
+NodeArena::NodeArena(size_t slotSize, size_t slotsPerSlab)
+        : slotSize(slotSize), slotsPerSlab(slotsPerSlab), slabSize(1), headerSize(0), partial(nullptr), full(nullptr),
+          slabCount(0), liveSlots(0) {
+
+    const size_t alignment = alignof(std::max_align_t);
+    if (this->slotSize < sizeof(FreeSlot)) {
+        this->slotSize = sizeof(FreeSlot);
+    }
+    this->slotSize = (this->slotSize + alignment - 1) / alignment * alignment;
+    headerSize = (sizeof(Slab) + alignment - 1) / alignment * alignment;
+
+    while (slabSize < this->slotSize * slotsPerSlab || slabSize < headerSize + this->slotSize) {
+        slabSize *= 2;
+    }
+    this->slotsPerSlab = (slabSize - headerSize) / this->slotSize;
+} // end NodeArena constructor
+
+// Destructor
+NodeArena::~NodeArena() {
+    while (partial != nullptr) {
+        freeSlab(partial);
+    }
+    while (full != nullptr) {
+        freeSlab(full);
+    }
+}
+
+void NodeArena::unlink(Slab* &list, Slab* slab) {
+    if (slab->prev != nullptr) {
+        slab->prev->next = slab->next;
+    } else {
+        list = slab->next;
+    }
+    if (slab->next != nullptr) {
+        slab->next->prev = slab->prev;
+    }
+    slab->prev = nullptr;
+    slab->next = nullptr;
+} // end unlink method
+
+void NodeArena::push(Slab* &list, Slab* slab) {
+    slab->prev = nullptr;
+    slab->next = list;
+    if (list != nullptr) {
+        list->prev = slab;
+    }
+    list = slab;
+} // end push method
+
+/**
+ * Summary: Allocates a new slab first in line for allocations, its slots on its free list lowest
+ * address first so nodes allocated one after another are next to each other.
+ */
+void NodeArena::addSlab() {
+
+    char* memory = (char*) allocateAligned(slabSize);
+    Slab* slab = (Slab*) memory;
+    slab->freeSlots = nullptr;
+    slab->live = 0;
+
+    for (size_t i = slotsPerSlab; i-- > 0;) {
+        FreeSlot* slot = (FreeSlot*) (memory + headerSize + i * slotSize);
+        slot->next = slab->freeSlots;
+        slab->freeSlots = slot;
+    }
+
+    push(partial, slab);
+    slabCount++;
+} // end addSlab method
+
+/**
+ * Summary: Gives a slab back to the system, whichever list it's on.
+ *
+ * @param Slab *slab
+ */
+void NodeArena::freeSlab(Slab* slab) {
+    unlink(slab->live == slotsPerSlab ? full : partial, slab);
+    freeAligned(slab);
+    slabCount--;
+} // end freeSlab method
+
+/**
+ * Summary: Hands out an uninitialized slot.
+ *
+ * @return slot of slotSize bytes
+ */
+void* NodeArena::allocate() {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (partial == nullptr) {
+        addSlab();
+    }
+
+    Slab* slab = partial;
+    FreeSlot* slot = slab->freeSlots;
+    slab->freeSlots = slot->next;
+    slab->live++;
+    liveSlots++;
+
+    if (slab->freeSlots == nullptr) {
+        unlink(partial, slab);
+        push(full, slab);
+    }
+    return slot;
+} // end allocate method
+
+/**
+ * Summary: Takes a slot back for the next allocation. A slab left empty is freed, unless it's the only
+ * one with room.
+ *
+ * @param void *slot from allocate(), may be nullptr
+ */
+void NodeArena::release(void* slot) {
+
+    if (slot == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    Slab* slab = (Slab*) ((uintptr_t) slot & ~(uintptr_t) (slabSize - 1));
+    if (slab->freeSlots == nullptr) {
+        unlink(full, slab);
+        push(partial, slab);
+    }
+
+    FreeSlot* freed = (FreeSlot*) slot;
+    freed->next = slab->freeSlots;
+    slab->freeSlots = freed;
+    slab->live--;
+    liveSlots--;
+
+    if (slab->live == 0 && (slab != partial || slab->next != nullptr)) {
+        freeSlab(slab);
+    }
+} // end release method
@@ -0,0 +1,71 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * NodeArena .h header file
+ *
+ * Fixed size allocator for list nodes. Nodes are carved out of large slabs and freed nodes are kept
+ * on a free list for the next one, so loading a file doesn't make a heap allocation per line and
+ * neighbouring lines sit next to each other in memory. Every list in the process shares one arena,
+ * so a node can be relinked from one buffer's list to another's and freed by either.
+ *
+ * Each slab keeps its own free slots and counts the slots in use, a slab whose last node is freed
+ * goes back to the system (except the last one with room, kept for the next node). Slabs are
+ * aligned to their size, so a freed slot finds its slab from its address.
+ */
+
+#ifndef SPARQ_NODEARENA_H
+#define SPARQ_NODEARENA_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+class NodeArena {
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    // At the start of every slab
+    struct Slab {
+        Slab* prev;
+        Slab* next;
+        FreeSlot* freeSlots;
+        size_t live; // slots handed out
+    };
+
+    size_t slotSize;
+    size_t slotsPerSlab;
+    size_t slabSize; // bytes, a power of two
+    size_t headerSize; // the Slab at the start, rounded up to keep the slots aligned
+    std::mutex lock; // the loader and autosave threads allocate too
+    Slab* partial; // slabs with free slots, allocations come from the first
+    Slab* full; // slabs with every slot handed out
+    size_t slabCount;
+    size_t liveSlots;
+
+    void addSlab();
+    void freeSlab(Slab* slab);
+    static void unlink(Slab* &list, Slab* slab);
+    static void push(Slab* &list, Slab* slab);
+
+public:
+    NodeArena(size_t slotSize, size_t slotsPerSlab);
+    virtual ~NodeArena();
+    NodeArena(const NodeArena &) = delete;
+
+    void* allocate();
+    void release(void* slot);
+
+    size_t live() const { return liveSlots; }
+    size_t capacity() const { return slabCount * slotsPerSlab; }
+};
+
+#endif //SPARQ_NODEARENA_H
@@ -0,0 +1,144 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Pager .cpp implementation file
+ */
+
+#include "Pager.h"
+
+#include <cstring>
+
+// Output is collected and written in pieces this big
+static const size_t OutputChunk = 1 << 16;
+
+/**
+ * Constructor
+ *
+ * Maps the file and loads its sidecar index, or starts indexing it in the background
+ * (saving a new sidecar when done if the file is big enough to be worth it).
+ *
+ * @param const string &filename
+ */
+Pager::Pager(const std::string &filename)
+        : file(filename), signature(FileSignature::takeSignature(file)), sidecar(LineIndex::sidecarPath(filename)),
+          stopping(false) {
+
+    if (!index.load(sidecar, signature)) {
+        indexer = std::thread([this]() {
+            index.build(file.data(), file.size(), &stopping);
+            if (!stopping && file.size() >= LineIndex::MinSidecarSize) {
+                index.save(sidecar, signature);
+            }
+        });
+    }
+} // end Pager constructor
+
+/**
+ * Destructor
+ *
+ * Stops the indexer if it's still running.
+ */
+Pager::~Pager() {
+    stopping = true;
+    if (indexer.joinable()) {
+        indexer.join();
+    }
+}
+
+/**
+ * Summary: Prints lines n to m (inclusive), stopping early at the end of the file.
+ * Jumps to the checkpoint before line n and scans forward from there.
+ *
+ * @param uint64_t n
+ * @param uint64_t m
+ * @param ostream &output
+ */
+void Pager::listRange(uint64_t n, uint64_t m, std::ostream &output) {
+
+    const char* data = file.data();
+    uint64_t size = file.size();
+    uint64_t position = 0;
+
+    if (!index.checkpoint(n, &position)) {
+        return; // the file doesn't have that many lines
+    }
+
+    // Skip ahead from the checkpoint to line n
+    for (uint64_t skip = (n - 1) % index.interval(); skip > 0; --skip) {
+        const char* newline = (const char*) std::memchr(data + position, '\n', (size_t) (size - position));
+        if (newline == nullptr) {
+            return;
+        }
+        position = (uint64_t) (newline - data) + 1;
+    }
+
+    std::string buffer;
+
+    // The text after the last newline is a line too, so position == size is still an (empty) line
+    for (uint64_t line = n; line <= m && position <= size; ++line) {
+        const char* start = data + position;
+        const char* newline = (const char*) std::memchr(start, '\n', (size_t) (size - position));
+        uint64_t length = newline != nullptr ? (uint64_t) (newline - start) : size - position;
+
+        buffer += std::to_string(line);
+        buffer += "> ";
+        buffer.append(start, (size_t) length);
+        buffer += '\n';
+
+        position = newline != nullptr ? position + length + 1 : size + 1;
+
+        if (buffer.size() >= OutputChunk) {
+            output.write(buffer.data(), (std::streamsize) buffer.size());
+            buffer.clear();
+        }
+    }
+
+    output.write(buffer.data(), (std::streamsize) buffer.size());
+    output.flush();
+} // end listRange method
+
+/**
+ * Summary: Read-only version of the list command with no index params [L].
+ *
+ * @param ostream &output
+ */
+void Pager::cmdList(std::ostream &output) {
+    listRange(1, UINT64_MAX, output);
+} // end cmdList method
+
+/**
+ * Summary: Read-only version of the list command with one index param [L n].
+ *
+ * @param int n
+ * @param ostream &output
+ */
+void Pager::cmdList(int n, std::ostream &output) {
+    if (n > 0) {
+        listRange((uint64_t) n, (uint64_t) n, output);
+    }
+} // end cmdList method
+
+/**
+ * Summary: Read-only version of the list command with two index params [L n m].
+ *
+ * @param int n
+ * @param int m
+ * @param ostream &output
+ */
+void Pager::cmdList(int n, int m, std::ostream &output) {
+
+    // Only attempt the command if n is less than m
+    if (n < m) {
+
+        // If n is less than 1, set to 1
+        if (n < 1) { n = 1; }
+
+        listRange((uint64_t) n, (uint64_t) m, output);
+    }
+} // end cmdList method
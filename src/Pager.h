@@ -0,0 +1,51 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Pager .h header file
+ *
+ * Read-only view mode (SparQ --view file). Lists lines straight out of the memory mapped file
+ * without building a linked list. A background thread indexes the file while lines are already being listed,
+ * unless a sidecar index saved by an earlier run still matches the file.
+ */
+
+#ifndef SPARQ_PAGER_H
+#define SPARQ_PAGER_H
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "MappedFile.h"
+#include "LineIndex.h"
+
+class Pager {
+
+private:
+    MappedFile file;
+    LineIndex index;
+    FileSignature signature;
+    std::string sidecar;
+    std::atomic<bool> stopping;
+    std::thread indexer;
+
+    void listRange(uint64_t n, uint64_t m, std::ostream &output);
+
+public:
+    explicit Pager(const std::string &filename);
+    virtual ~Pager();
+
+    void cmdList(std::ostream &output);
+    void cmdList(int n, std::ostream &output);
+    void cmdList(int n, int m, std::ostream &output);
+
+    LineIndex &getIndex() { return index; }
+};
+
+#endif //SPARQ_PAGER_H
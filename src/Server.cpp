@@ -0,0 +1,635 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Server .cpp implementation file
+ */
+
+#include "Server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <csignal>
+#include <poll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// Clients are numbered from 1
+static const uint64_t FirstClient = 1;
+
+// Bytes read from a socket at a time
+static const size_t ReadSize = 1 << 16;
+
+// Marks the end of each reply, the client doesn't print it
+static const char ReplyEnd = '\0';
+
+#ifdef __linux__
+
+/**
+ * Summary: Blocks SIGINT and SIGTERM and reads them from a descriptor instead, so the event loop can
+ * stop cleanly. Threads started after this inherit the blocked signals.
+ *
+ * @return signalfd
+ */
+static int openStopSignals() {
+
+    sigset_t stop;
+    sigemptyset(&stop);
+    sigaddset(&stop, SIGINT);
+    sigaddset(&stop, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop, nullptr);
+
+    int fd = signalfd(-1, &stop, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0) {
+        throw ServerException(std::string("Unable to watch for signals: ") + std::strerror(errno));
+    }
+    return fd;
+} // end openStopSignals function
+
+/**
+ * Summary: Fills in a Unix socket address.
+ *
+ * @param const string &path
+ * @param sockaddr_un &address
+ * @return false if the path is too long
+ */
+static bool socketAddress(const std::string &path, sockaddr_un &address) {
+
+    std::memset(&address, 0, sizeof(address));
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+} // end socketAddress function
+
+/**
+ * Constructor
+ *
+ * Listens on the socket. A socket file nobody listens on is left over from a server that didn't stop
+ * cleanly and is replaced.
+ *
+ * @param const string &socketPath
+ */
+Server::Server(const std::string &socketPath)
+        : socketPath(socketPath), listener(-1), signals(openStopSignals()), nextClient(FirstClient) {
+
+    sockaddr_un address;
+    if (!socketAddress(socketPath, address)) {
+        throw ServerException("Socket path " + socketPath + " is too long.");
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0) {
+        bool listening = connect(probe, (sockaddr*) &address, sizeof(address)) == 0;
+        close(probe);
+        if (listening) {
+            throw ServerException("A server is already listening on " + socketPath + ".");
+        }
+        if (errno == ECONNREFUSED) {
+            unlink(socketPath.c_str());
+        }
+    }
+
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0 || bind(listener, (sockaddr*) &address, sizeof(address)) != 0 ||
+        listen(listener, SOMAXCONN) != 0) {
+        std::string reason = std::strerror(errno);
+        if (listener >= 0) {
+            close(listener);
+            listener = -1;
+        }
+        throw ServerException("Unable to listen on " + socketPath + ": " + reason);
+    }
+
+    loop.watch(listener, EventReadable, [this](uint32_t) { acceptClients(); });
+    loop.watch(signals, EventReadable, [this](uint32_t) { loop.stop(); });
+} // end Server constructor
+
+/**
+ * Destructor
+ *
+ * Waits for running requests, then closes every client and removes the socket file.
+ */
+Server::~Server() {
+
+    tasks.wait();
+
+    for (auto &entry : clients) {
+        close(entry.second->fd);
+    }
+    if (listener >= 0) {
+        close(listener);
+        unlink(socketPath.c_str());
+    }
+    if (signals >= 0) { close(signals); }
+}
+
+/**
+ * Summary: Runs the event loop until SIGINT or SIGTERM. Files not saved with E are not saved.
+ *
+ * @return error code
+ */
+int Server::run() {
+
+    std::cout << "Serving on " << socketPath << "." << std::endl;
+
+    try {
+        loop.run();
+    }
+    catch (EventLoopException &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Server stopped." << std::endl;
+    return 0;
+} // end run method
+
+void Server::acceptClients() {
+
+    while (true) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        std::unique_ptr<Client> client(new Client());
+        client->fd = fd;
+        client->buffer = nullptr;
+        client->sent = 0;
+        client->lineNumber = 1;
+        client->isInsert = false;
+        client->waiting = false;
+        client->inputEnded = false;
+        client->closing = false;
+        client->events = EventReadable;
+
+        uint64_t id = nextClient++;
+        loop.watch(fd, EventReadable, [this, id](uint32_t events) { clientReady(id, events); });
+        clients[id] = std::move(client);
+    }
+} // end acceptClients method
+
+/**
+ * Summary: Reads from or writes to a client its socket is ready for.
+ *
+ * @param uint64_t id
+ * @param uint32_t events
+ */
+void Server::clientReady(uint64_t id, uint32_t events) {
+
+    auto found = clients.find(id);
+    if (found == clients.end()) {
+        return;
+    }
+    Client &client = *found->second;
+
+    // Hung up or broken, there is nobody to reply to any more
+    if (events & EventClosed) {
+        closeClient(id);
+        return;
+    }
+    if (events & EventReadable) {
+        readClient(client);
+    }
+    if (events & EventWritable) {
+        writeClient(client);
+    }
+    handleInput(id, client);
+    watch(id, client);
+} // end clientReady method
+
+/**
+ * Summary: Reads whatever the client has sent so far.
+ *
+ * @param Client &client
+ */
+void Server::readClient(Client &client) {
+
+    char buffer[ReadSize];
+
+    while (true) {
+        ssize_t count = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (count > 0) {
+            client.input.append(buffer, (size_t) count);
+        } else if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            client.inputEnded = true;
+            return;
+        } else if (errno != EINTR) {
+            return;
+        }
+    }
+} // end readClient method
+
+/**
+ * Summary: Sends as much of the waiting output as the socket takes.
+ *
+ * @param Client &client
+ */
+void Server::writeClient(Client &client) {
+
+    while (client.sent < client.output.size()) {
+        ssize_t count = send(client.fd, client.output.data() + client.sent, client.output.size() - client.sent,
+                             MSG_NOSIGNAL);
+        if (count > 0) {
+            client.sent += (size_t) count;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        } else if (errno != EINTR) {
+            // Gone, nothing more can be sent
+            client.output.clear();
+            client.sent = 0;
+            client.closing = true;
+            return;
+        }
+    }
+
+    client.output.clear();
+    client.sent = 0;
+} // end writeClient method
+
+/**
+ * Summary: Closes a client. A request it still has running finishes, its reply is dropped.
+ *
+ * @param uint64_t id
+ */
+void Server::closeClient(uint64_t id) {
+
+    auto found = clients.find(id);
+    if (found == clients.end()) {
+        return;
+    }
+    loop.unwatch(found->second->fd);
+    close(found->second->fd);
+    clients.erase(found);
+} // end closeClient method
+
+/**
+ * Summary: Watches the client for what it's waiting on, or closes it once everything has been said.
+ *
+ * @param uint64_t id
+ * @param Client &client
+ */
+void Server::watch(uint64_t id, Client &client) {
+
+    bool sending = client.sent < client.output.size();
+
+    if (!sending && !client.waiting && (client.closing || (client.inputEnded && client.input.empty()))) {
+        closeClient(id);
+        return;
+    }
+
+    // A client that ended its input would keep reporting it
+    uint32_t events = (client.inputEnded ? 0 : EventReadable) | (sending ? EventWritable : 0);
+    if (events != client.events) {
+        client.events = events;
+        loop.modify(client.fd, events);
+    }
+} // end watch method
+
+/**
+ * Summary: Queues the client's next line if it has a whole one and nothing running. The first line
+ * names the file.
+ *
+ * @param uint64_t id
+ * @param Client &client
+ */
+void Server::handleInput(uint64_t id, Client &client) {
+
+    if (client.waiting || client.closing) {
+        return;
+    }
+
+    std::string line;
+    size_t newline = client.input.find('\n');
+    if (newline != std::string::npos) {
+        line = client.input.substr(0, newline);
+        client.input.erase(0, newline + 1);
+    } else if (client.inputEnded && !client.input.empty()) {
+        // The last line doesn't need a line break
+        line.swap(client.input);
+    } else {
+        return;
+    }
+
+    Request request;
+    request.client = id;
+    request.lineNumber = client.lineNumber;
+    request.isInsert = client.isInsert;
+    request.open = client.buffer == nullptr;
+
+    if (request.open) {
+        client.buffer = openBuffer(line);
+    } else {
+        request.line = std::move(line);
+    }
+
+    client.waiting = true;
+    queue(client.buffer, std::move(request));
+} // end handleInput method
+
+/**
+ * Summary: Finds the loaded file with the name, or a new buffer that loads it with its first request.
+ * Like the editor, a name without an extension gets .txt.
+ *
+ * @param const string &filename
+ * @return buffer
+ */
+Server::Buffer* Server::openBuffer(const std::string &filename) {
+
+    std::string name = filename;
+    if (name.find('.') == std::string::npos) {
+        name += DefaultFileExt;
+    }
+
+    std::unique_ptr<Buffer> &buffer = buffers[name];
+    if (buffer == nullptr) {
+        buffer.reset(new Buffer());
+        buffer->filename = name;
+    }
+    return buffer.get();
+} // end openBuffer method
+
+/**
+ * Summary: Adds a request to the file's queue, starting a task for the queue if none is running.
+ *
+ * @param Buffer *buffer
+ * @param Request request
+ */
+void Server::queue(Buffer* buffer, Request request) {
+
+    bool start = false;
+    {
+        std::lock_guard<std::mutex> guard(buffer->lock);
+        buffer->queue.push_back(std::move(request));
+        if (!buffer->busy) {
+            buffer->busy = true;
+            start = true;
+        }
+    }
+
+    if (start) {
+        tasks.run([this, buffer]() { runQueue(buffer); });
+
+        // Without worker threads nothing else would run it
+        if (ThreadPool::shared().size() == 1) {
+            tasks.wait();
+        }
+    }
+} // end queue method
+
+/**
+ * Summary: Runs on the thread pool. Works through a file's requests in order, posting each reply to
+ * the event loop, until the queue is empty.
+ *
+ * @param Buffer *buffer
+ */
+void Server::runQueue(Buffer* buffer) {
+
+    while (true) {
+        Request request;
+        {
+            std::lock_guard<std::mutex> guard(buffer->lock);
+            if (buffer->queue.empty()) {
+                buffer->busy = false;
+                return;
+            }
+            request = std::move(buffer->queue.front());
+            buffer->queue.pop_front();
+        }
+
+        Reply reply = execute(*buffer, request);
+        loop.post([this, reply]() { handleReply(reply); });
+    }
+} // end runQueue method
+
+/**
+ * Summary: Runs one request on the file's editor the way the interactive editor runs a line, and
+ * collects what it printed followed by the next prompt.
+ *
+ * @param Buffer &buffer
+ * @param const Request &request
+ * @return reply
+ */
+Server::Reply Server::execute(Buffer &buffer, const Request &request) {
+
+    Editor &editor = buffer.editor;
+    std::ostringstream text;
+    std::istringstream noAnswers; // the filename is always known, E never asks for one
+    editor.out = &text;
+    editor.in = &noAnswers;
+
+    Reply reply;
+    reply.client = request.client;
+    reply.closing = false;
+
+    try {
+        if (request.open) {
+            if (!buffer.loaded) {
+                if (!editor.isValidFileName(buffer.filename)) {
+                    reply.closing = true;
+                } else {
+                    editor.myFileName = buffer.filename;
+                    editor.populateListFromFile(editor.myFileName, &editor.list);
+                    buffer.loaded = true;
+                }
+            }
+            editor.currentLineNumber = editor.list.getLineCount() + 1;
+            editor.isInsert = false;
+        } else {
+            // Other clients may have changed the file since this client's last request. Text is
+            // always added at the end, an insert point past the end moves to the end.
+            int lineCount = editor.list.getLineCount();
+            editor.isInsert = request.isInsert;
+            editor.currentLineNumber = request.isInsert ? std::min(request.lineNumber, lineCount + 1) : lineCount + 1;
+
+            if (editor.exitCommandEntered(request.line, editor.myFileName, &editor.list)) {
+                reply.closing = true;
+
+                // The file as it was just saved is what a later RELOAD compares with
+                struct stat info;
+                if (stat(editor.myFileName.c_str(), &info) == 0) {
+                    editor.loadedBytes = (uint64_t) info.st_size;
+                    editor.loadedFormat = detectFormat(editor.myFileName);
+                    editor.snapshot = editor.takeSnapshot(editor.myFileName);
+                }
+            } else if (!editor.textCommandEntered(request.line, editor.ptrCurrentLineNumber, &editor.list,
+                                                  editor.ptrIsInsert)) {
+                editor.addDataToList(request.line, editor.ptrCurrentLineNumber, &editor.list, editor.ptrIsInsert);
+            }
+        }
+    }
+    catch (std::exception &e) {
+        text << "The command failed." << std::endl;
+    }
+
+    reply.lineNumber = editor.currentLineNumber;
+    reply.isInsert = editor.isInsert;
+
+    // Same prompt as the interactive editor
+    if (!reply.closing) {
+        if (reply.isInsert) {
+            text << "I ";
+        }
+        text << reply.lineNumber << "> ";
+    }
+    text << ReplyEnd;
+
+    editor.out = &std::cout;
+    editor.in = &std::cin;
+
+    reply.text = text.str();
+    return reply;
+} // end execute method
+
+/**
+ * Summary: Passes a finished reply on to its client and queues the client's next line.
+ *
+ * @param const Reply &reply
+ */
+void Server::handleReply(const Reply &reply) {
+
+    auto found = clients.find(reply.client);
+    if (found == clients.end()) {
+        return; // the client left while it ran
+    }
+    Client &client = *found->second;
+
+    client.waiting = false;
+    client.lineNumber = reply.lineNumber;
+    client.isInsert = reply.isInsert;
+    client.output += reply.text;
+    if (reply.closing) {
+        client.closing = true;
+    }
+
+    writeClient(client);
+    handleInput(reply.client, client);
+    watch(reply.client, client);
+} // end handleReply method
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: Writes all of the text to a socket.
+ *
+ * @param int fd
+ * @param const char *data
+ * @param size_t length
+ * @return false if the server is gone
+ */
+static bool sendAll(int fd, const char* data, size_t length) {
+
+    while (length > 0) {
+        ssize_t count = send(fd, data, length, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += count;
+        length -= (size_t) count;
+    }
+    return true;
+} // end sendAll function
+
+/**
+ * Summary: Client mode (SparQ --connect socket file). Opens the file on the server, then passes what's
+ * typed (or piped in) to it and prints the replies, until E or the end of the input.
+ *
+ * @param const string &socketPath
+ * @param const string &filename
+ * @return error code
+ */
+int connectToServer(const std::string &socketPath, const std::string &filename) {
+
+    sockaddr_un address;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (!socketAddress(socketPath, address) || fd < 0 ||
+        connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+        std::cerr << "Unable to connect to a server on " << socketPath << "." << std::endl;
+        if (fd >= 0) { close(fd); }
+        return 1;
+    }
+
+    std::string opening = filename + "\n";
+    bool inputOpen = sendAll(fd, opening.data(), opening.size());
+
+    char buffer[ReadSize];
+    pollfd fds[2];
+    fds[1].fd = fd;
+
+    while (true) {
+        // A closed input would keep reporting that it hung up
+        fds[0].fd = inputOpen ? STDIN_FILENO : -1;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].events = POLLIN;
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        // Replies, without the marks that end them
+        if (fds[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t count = read(fd, buffer, sizeof(buffer));
+            if (count <= 0) {
+                break;
+            }
+            char* end = std::remove(buffer, buffer + count, ReplyEnd);
+            std::cout.write(buffer, end - buffer);
+            std::cout.flush();
+        }
+
+        // Input goes to the server as it is, it splits the lines
+        if (inputOpen && (fds[0].revents & (POLLIN | POLLHUP | POLLERR))) {
+            ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (count <= 0 || !sendAll(fd, buffer, (size_t) count)) {
+                inputOpen = false;
+                shutdown(fd, SHUT_WR);
+            }
+        }
+    }
+
+    close(fd);
+    return 0;
+} // end connectToServer function
+
+#else
+
+Server::Server(const std::string &socketPath)
+        : socketPath(socketPath), listener(-1), signals(-1), nextClient(FirstClient) {
+    throw ServerException("Server mode is only available on Linux.");
+}
+
+Server::~Server() {}
+
+int Server::run() {
+    return 1;
+}
+
+int connectToServer(const std::string &socketPath, const std::string &filename) {
+    std::cerr << "Server mode is only available on Linux." << std::endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Server .h header file
+ *
+ * Daemon mode (SparQ --serve socket). Keeps files loaded between clients and takes the editor's
+ * commands over a Unix domain socket, so scripts that each make a small edit don't load the file
+ * every time. Clients (SparQ --connect socket file) send the filename on the first line and then
+ * whatever they would have typed, and get back what the editor would have printed. Each reply ends
+ * with the prompt and a '\0', E saves the file and ends the session but the file stays loaded.
+ *
+ * One thread runs an event loop over the sockets. Commands run on the thread pool, one at a time for
+ * each file (in the order they arrived) but in parallel for different files. Every client has its
+ * own current line and insert mode.
+ *
+ * Linux only.
+ */
+
+#ifndef SPARQ_SERVER_H
+#define SPARQ_SERVER_H
+
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Editor.h"
+#include "EventLoop.h"
+#include "ThreadPool.h"
+
+class Server {
+
+private:
+    // A line from a client, or the client opening the file when open is set
+    struct Request {
+        uint64_t client;
+        std::string line;
+        int lineNumber;
+        bool isInsert;
+        bool open;
+    };
+
+    // What a request printed and the client's state after it
+    struct Reply {
+        uint64_t client;
+        std::string text;
+        int lineNumber;
+        bool isInsert;
+        bool closing; // E was entered or the file couldn't be opened
+    };
+
+    // A file kept loaded, its requests run one at a time
+    struct Buffer {
+        std::string filename;
+        Editor editor;
+        bool loaded = false;
+        std::mutex lock; // guards the queue and busy
+        std::deque<Request> queue;
+        bool busy = false; // a task is working through the queue
+    };
+
+    struct Client {
+        int fd;
+        Buffer* buffer; // nullptr until the filename arrives
+        std::string input; // received, not handled yet
+        std::string output; // replies not sent yet
+        size_t sent; // of output
+        int lineNumber;
+        bool isInsert;
+        bool waiting; // a request is queued or running
+        bool inputEnded; // the client closed its end
+        bool closing; // close once the output is sent
+        uint32_t events; // what the loop watches the socket for
+    };
+
+    std::string socketPath;
+    int listener;
+    int signals; // signalfd for SIGINT and SIGTERM
+#ifdef __linux__
+    EventLoop loop;
+#endif
+
+    std::map<std::string, std::unique_ptr<Buffer>> buffers;
+    std::map<uint64_t, std::unique_ptr<Client>> clients; // loop thread only
+    uint64_t nextClient;
+
+    TaskGroup tasks; // last, it waits for running requests before anything else goes
+
+    void acceptClients();
+    void readClient(Client &client);
+    void writeClient(Client &client);
+    void closeClient(uint64_t id);
+    void clientReady(uint64_t id, uint32_t events);
+    void handleInput(uint64_t id, Client &client);
+    void handleReply(const Reply &reply);
+    void watch(uint64_t id, Client &client);
+    Buffer* openBuffer(const std::string &filename);
+    void queue(Buffer* buffer, Request request);
+    void runQueue(Buffer* buffer);
+    Reply execute(Buffer &buffer, const Request &request);
+
+public:
+    explicit Server(const std::string &socketPath); // throws ServerException
+    virtual ~Server();
+    Server(const Server &) = delete;
+
+    int run(); // until SIGINT or SIGTERM
+};
+
+int connectToServer(const std::string &socketPath, const std::string &filename);
+
+// Custom Exceptions
+struct ServerException : public std::exception {
+public:
+    std::string reason;
+
+    explicit ServerException(const std::string &reason) : reason(reason) {}
+
+    const std::string what() {
+        return reason;
+    }
+};//end ServerException struct
+
+#endif //SPARQ_SERVER_H
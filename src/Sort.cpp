@@ -0,0 +1,243 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Sort .cpp implementation file
+ */
+
+#include "Sort.h"
+
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+// Below this many lines a single thread is faster than starting more
+static const size_t MinLinesPerThread = 16384;
+
+// A node together with its precomputed numeric key and its text
+struct SortItem {
+    double key;
+    const std::string* text;
+    Node* node;
+};
+
+/**
+ * Summary: Reads the sort options from the command flags.
+ * N sorts numerically, R reverses the order.
+ *
+ * @param const string &flags
+ * @return SortOptions
+ */
+SortOptions SortOptions::fromFlags(const std::string &flags) {
+    SortOptions options;
+    options.numeric = flags.find('N') != std::string::npos;
+    options.reverse = flags.find('R') != std::string::npos;
+    return options;
+} // end fromFlags method
+
+/**
+ * Summary: Parses the number at the start of a line like sort -n does.
+ * Leading blanks are skipped, a line that doesn't start with a number sorts as 0.
+ *
+ * @param const string &line
+ * @return the leading number
+ */
+double numericSortKey(const std::string &line) {
+
+    size_t i = 0;
+    bool negative = false;
+    double value = 0;
+
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) { i++; }
+
+    if (i < line.size() && line[i] == '-') {
+        negative = true;
+        i++;
+    }
+
+    // Whole part
+    while (i < line.size() && line[i] >= '0' && line[i] <= '9') {
+        value = value * 10 + (line[i] - '0');
+        i++;
+    }
+
+    // Fraction
+    if (i < line.size() && line[i] == '.') {
+        double scale = 0.1;
+        for (i++; i < line.size() && line[i] >= '0' && line[i] <= '9'; i++) {
+            value += (line[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    return negative ? -value : value;
+} // end numericSortKey function
+
+/**
+ * Summary: Compares two lines with the sort options.
+ *
+ * @param const string &a
+ * @param const string &b
+ * @param const SortOptions &options
+ * @return true if a sorts before b
+ */
+bool lessThanLine(const std::string &a, const std::string &b, const SortOptions &options) {
+
+    if (options.numeric) {
+        double keyA = numericSortKey(a);
+        double keyB = numericSortKey(b);
+        return options.reverse ? keyB < keyA : keyA < keyB;
+    }
+
+    return options.reverse ? b.compare(a) < 0 : a.compare(b) < 0;
+} // end lessThanLine function
+
+/**
+ * Summary: Stable merge sort split over the thread pool.
+ * Each chunk is sorted on its own, then neighbouring chunks are merged in parallel until one is left.
+ *
+ * @param vector<SortItem> &items
+ * @param Compare less
+ */
+template<typename Compare>
+static void parallelMergeSort(std::vector<SortItem> &items, Compare less) {
+
+    size_t threads = ThreadPool::shared().size();
+    if (threads > items.size() / MinLinesPerThread) { threads = items.size() / MinLinesPerThread; }
+
+    if (threads <= 1) {
+        std::stable_sort(items.begin(), items.end(), less);
+        return;
+    }
+
+    // Chunk boundaries
+    std::vector<size_t> bounds;
+    for (size_t t = 0; t <= threads; ++t) {
+        bounds.push_back(items.size() * t / threads);
+    }
+
+    // Sort every chunk as its own task
+    parallelFor(0, threads, 1, [&items, &bounds, less](size_t first, size_t last) {
+        for (size_t t = first; t < last; ++t) {
+            std::stable_sort(items.begin() + bounds[t], items.begin() + bounds[t + 1], less);
+        }
+    });
+
+    // Merge pairs of sorted runs until there is only one
+    std::vector<SortItem> buffer(items.size());
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged;
+        for (size_t r = 0; r + 1 < bounds.size(); r += 2) {
+            merged.push_back(bounds[r]);
+        }
+        merged.push_back(items.size());
+
+        // std::merge takes from the left run on ties, which keeps the sort stable
+        parallelFor(0, merged.size() - 1, 1, [&items, &buffer, &bounds, less](size_t first, size_t last) {
+            for (size_t p = first; p < last; ++p) {
+                size_t begin = bounds[2 * p];
+                size_t middle = bounds[2 * p + 1];
+                size_t end = 2 * p + 2 < bounds.size() ? bounds[2 * p + 2] : middle;
+                std::merge(items.begin() + begin, items.begin() + middle,
+                           items.begin() + middle, items.begin() + end,
+                           buffer.begin() + begin, less);
+            }
+        });
+
+        bounds.swap(merged);
+        items.swap(buffer);
+    }
+} // end parallelMergeSort function
+
+/**
+ * Summary: Sorts items by the sort options.
+ *
+ * @param vector<SortItem> &items with text and keys filled in
+ * @param const SortOptions &options
+ */
+static void sortItems(std::vector<SortItem> &items, const SortOptions &options) {
+
+    if (options.numeric && options.reverse) {
+        parallelMergeSort(items, [](const SortItem &a, const SortItem &b) { return b.key < a.key; });
+    } else if (options.numeric) {
+        parallelMergeSort(items, [](const SortItem &a, const SortItem &b) { return a.key < b.key; });
+    } else if (options.reverse) {
+        parallelMergeSort(items, [](const SortItem &a, const SortItem &b) {
+            return b.text->compare(*a.text) < 0;
+        });
+    } else {
+        parallelMergeSort(items, [](const SortItem &a, const SortItem &b) {
+            return a.text->compare(*b.text) < 0;
+        });
+    }
+} // end sortItems function
+
+/**
+ * Summary: Sorts the line nodes in place (the vector of pointers, not the list).
+ * The sort is stable, equal lines keep their order.
+ *
+ * @param vector<Node*> &nodes
+ * @param const SortOptions &options
+ */
+void sortLines(std::vector<Node*> &nodes, const SortOptions &options) {
+
+    std::vector<SortItem> items(nodes.size());
+    std::vector<std::string> copies;
+
+    // Compressed lines can be evicted from memory at any time, so those are sorted on copies.
+    // Everything else is sorted on the nodes' own text.
+    for (Node* node : nodes) {
+        if (node->block != nullptr) {
+            copies.reserve(nodes.size());
+            break;
+        }
+    }
+
+    // Parse numeric keys once up front rather than on every comparison
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (copies.capacity() > 0) {
+            copies.push_back(nodes[i]->line());
+            items[i].text = &copies.back();
+        } else {
+            items[i].text = &nodes[i]->line();
+        }
+        items[i].key = options.numeric ? numericSortKey(*items[i].text) : 0;
+        items[i].node = nodes[i];
+    }
+
+    sortItems(items, options);
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i] = items[i].node;
+    }
+} // end sortLines function
+
+/**
+ * Summary: Sorts a vector of lines in place, stable like sortLines.
+ *
+ * @param vector<string> &lines
+ * @param const SortOptions &options
+ */
+void sortStrings(std::vector<std::string> &lines, const SortOptions &options) {
+
+    std::vector<SortItem> items(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        items[i].text = &lines[i];
+        items[i].key = options.numeric ? numericSortKey(lines[i]) : 0;
+        items[i].node = nullptr;
+    }
+
+    sortItems(items, options);
+
+    // Move the lines into their sorted order
+    std::vector<std::string> sorted(lines.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        sorted[i].swap(const_cast<std::string &>(*items[i].text));
+    }
+    lines.swap(sorted);
+} // end sortStrings function
@@ -0,0 +1,36 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Sort .h header file
+ *
+ * Stable parallel merge sort of line nodes for the SORT command.
+ */
+
+#ifndef SPARQ_SORT_H
+#define SPARQ_SORT_H
+
+#include <string>
+#include <vector>
+
+#include "LinkedList.h"
+
+// How the lines should be compared
+struct SortOptions {
+    bool numeric = false; // compare the leading number of each line (like sort -n)
+    bool reverse = false; // largest first
+
+    static SortOptions fromFlags(const std::string &flags);
+};
+
+double numericSortKey(const std::string &line);
+bool lessThanLine(const std::string &a, const std::string &b, const SortOptions &options);
+void sortLines(std::vector<Node*> &nodes, const SortOptions &options);
+void sortStrings(std::vector<std::string> &lines, const SortOptions &options);
+
+#endif //SPARQ_SORT_H
@@ -0,0 +1,243 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Stats .cpp implementation file
+ */
+
+#include "Stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+// What this thread's commands touched so far, timers take the difference
+static thread_local uint64_t threadLines = 0;
+static thread_local uint64_t threadBytes = 0;
+
+// Constructor
+LatencyHistogram::LatencyHistogram() : samples(0), totalNanoseconds(0), largest(0), lines(0), bytes(0) {
+    for (std::atomic<uint64_t> &bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Summary: Finds the bucket for a value. Below 2 * SubBuckets each value has its own bucket, above
+ * that the highest bit picks the power of two and the next SubBucketBits bits the bucket within it.
+ *
+ * @param uint64_t value
+ * @return bucket
+ */
+int LatencyHistogram::bucketOf(uint64_t value) {
+
+    if (value < (uint64_t) (2 * SubBuckets)) {
+        return (int) value;
+    }
+
+    // Highest bit set, by halving
+    int highestBit = 0;
+    for (int step = 32; step > 0; step /= 2) {
+        if ((value >> (highestBit + step)) != 0) {
+            highestBit += step;
+        }
+    }
+
+    int shift = highestBit - SubBucketBits;
+    int sub = (int) (value >> shift) - SubBuckets;
+    return 2 * SubBuckets + (shift - 1) * SubBuckets + sub;
+} // end bucketOf method
+
+/**
+ * Summary: The highest value that goes in a bucket.
+ *
+ * @param int bucket
+ * @return value
+ */
+uint64_t LatencyHistogram::highestIn(int bucket) {
+
+    if (bucket < 2 * SubBuckets) {
+        return (uint64_t) bucket;
+    }
+
+    int shift = (bucket - 2 * SubBuckets) / SubBuckets + 1;
+    uint64_t sub = (uint64_t) ((bucket - 2 * SubBuckets) % SubBuckets + SubBuckets);
+    return ((sub + 1) << shift) - 1;
+} // end highestIn method
+
+/**
+ * Summary: Adds a sample. Safe from any thread.
+ *
+ * @param uint64_t nanoseconds
+ * @param uint64_t linesTouched
+ * @param uint64_t bytesMoved
+ */
+void LatencyHistogram::record(uint64_t nanoseconds, uint64_t linesTouched, uint64_t bytesMoved) {
+
+    buckets[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+    totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    lines.fetch_add(linesTouched, std::memory_order_relaxed);
+    bytes.fetch_add(bytesMoved, std::memory_order_relaxed);
+
+    uint64_t seen = largest.load(std::memory_order_relaxed);
+    while (nanoseconds > seen && !largest.compare_exchange_weak(seen, nanoseconds, std::memory_order_relaxed)) {}
+} // end record method
+
+/**
+ * Summary: The latency the given fraction of the samples are at or below, to within a bucket.
+ *
+ * @param double fraction 0.5 for the median
+ * @return nanoseconds, 0 if there are no samples
+ */
+uint64_t LatencyHistogram::percentile(double fraction) const {
+
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    // Nearest rank, the sample that many from the bottom
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t) std::ceil(fraction * (double) total));
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < HistogramBuckets; ++bucket) {
+        seen += buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(highestIn(bucket), max());
+        }
+    }
+    return max();
+} // end percentile method
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: The stats for the whole process. Never destroyed, so it can still be printed at exit.
+ *
+ * @return stats
+ */
+Stats &Stats::shared() {
+    static Stats* stats = new Stats();
+    return *stats;
+} // end shared method
+
+/**
+ * Summary: Finds the histogram for a name, adding it the first time. The histogram stays put, so
+ * callers look it up once and keep it.
+ *
+ * @param const string &name
+ * @return histogram
+ */
+LatencyHistogram &Stats::histogram(const std::string &name) {
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::unique_ptr<LatencyHistogram> &entry = histograms[name];
+    if (!entry) {
+        entry.reset(new LatencyHistogram());
+    }
+    return *entry;
+} // end histogram method
+
+/**
+ * Summary: Writes a latency in the unit that suits it, like 850 ns, 12.3 us or 4.56 ms.
+ *
+ * @param uint64_t nanoseconds
+ * @return text
+ */
+static std::string formatLatency(uint64_t nanoseconds) {
+
+    std::ostringstream text;
+    if (nanoseconds < 1000) {
+        text << nanoseconds << " ns";
+    } else if (nanoseconds < 1000000) {
+        text << std::fixed << std::setprecision(1) << (double) nanoseconds / 1e3 << " us";
+    } else if (nanoseconds < 1000000000) {
+        text << std::fixed << std::setprecision(2) << (double) nanoseconds / 1e6 << " ms";
+    } else {
+        text << std::fixed << std::setprecision(2) << (double) nanoseconds / 1e9 << " s";
+    }
+    return text.str();
+} // end formatLatency function
+
+/**
+ * Summary: Prints a line for everything timed so far: count, median, 99th percentile and slowest,
+ * and the lines touched and bytes moved altogether.
+ *
+ * @param ostream &out
+ */
+void Stats::report(std::ostream &out) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::ostringstream table;
+    table << std::left << std::setw(12) << "command" << std::right << std::setw(10) << "count"
+          << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max"
+          << std::setw(14) << "lines" << std::setw(16) << "bytes" << '\n';
+
+    bool any = false;
+    for (auto &entry : histograms) {
+        const LatencyHistogram &histogram = *entry.second;
+        if (histogram.count() == 0) {
+            continue;
+        }
+        any = true;
+        table << std::left << std::setw(12) << entry.first << std::right << std::setw(10) << histogram.count()
+              << std::setw(12) << formatLatency(histogram.percentile(0.5))
+              << std::setw(12) << formatLatency(histogram.percentile(0.99))
+              << std::setw(12) << formatLatency(histogram.max())
+              << std::setw(14) << histogram.linesTouched() << std::setw(16) << histogram.bytesMoved() << '\n';
+    }
+
+    if (!any) {
+        out << "Nothing has been timed yet." << std::endl;
+        return;
+    }
+    out << table.str() << std::flush;
+} // end report method
+
+/**
+ * Summary: Counts lines touched and bytes moved by the command running on this thread.
+ *
+ * @param uint64_t lines
+ * @param uint64_t bytes
+ */
+void Stats::touched(uint64_t lines, uint64_t bytes) {
+    threadLines += lines;
+    threadBytes += bytes;
+} // end touched method
+
+uint64_t Stats::linesTouched() {
+    return threadLines;
+} // end linesTouched method
+
+uint64_t Stats::bytesMoved() {
+    return threadBytes;
+} // end bytesMoved method
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Constructor, starts the clock
+ *
+ * @param LatencyHistogram *histogram where it's recorded, can be set later with recordTo
+ */
+StatsTimer::StatsTimer(LatencyHistogram* histogram)
+        : histogram(histogram), started(std::chrono::steady_clock::now()),
+          startLines(Stats::linesTouched()), startBytes(Stats::bytesMoved()) {}
+
+/**
+ * Destructor, records the time since the constructor
+ */
+StatsTimer::~StatsTimer() {
+    if (histogram != nullptr) {
+        auto elapsed = std::chrono::steady_clock::now() - started;
+        histogram->record((uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                          Stats::linesTouched() - startLines, Stats::bytesMoved() - startBytes);
+    }
+}
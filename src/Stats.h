@@ -0,0 +1,108 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Stats .h header file
+ *
+ * Latency of every command, load and save, kept for the whole process and printed by the STATS
+ * command (or at exit with --stats). Each kind of command has a histogram in the style of HDR
+ * histograms: buckets grow with the value, each power of two split into 32, so any latency from a
+ * nanosecond to hours is kept to within about 3% in a fixed 15K of counters. Recording is a clock
+ * read and a few relaxed atomic adds, no lock, so it's always on.
+ *
+ * Commands also say how many lines they touched and how many bytes they moved (listed, read or
+ * written) through Stats::touched(). Those are counted per thread and a timer takes the difference,
+ * so a timed save inside a timed E counts for both.
+ */
+
+#ifndef SPARQ_STATS_H
+#define SPARQ_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Each power of two is split into 2^SubBucketBits buckets
+const int SubBucketBits = 5;
+const int SubBuckets = 1 << SubBucketBits;
+
+// Values below 2 * SubBuckets have a bucket each, every power of two above gets SubBuckets more
+const int HistogramBuckets = 2 * SubBuckets + (64 - SubBucketBits - 1) * SubBuckets;
+
+class LatencyHistogram {
+
+private:
+    std::atomic<uint64_t> buckets[HistogramBuckets];
+    std::atomic<uint64_t> samples;
+    std::atomic<uint64_t> totalNanoseconds;
+    std::atomic<uint64_t> largest;
+    std::atomic<uint64_t> lines;
+    std::atomic<uint64_t> bytes;
+
+    static int bucketOf(uint64_t value);
+    static uint64_t highestIn(int bucket);
+
+public:
+    LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram &) = delete;
+
+    void record(uint64_t nanoseconds, uint64_t linesTouched, uint64_t bytesMoved);
+    uint64_t percentile(double fraction) const;
+
+    uint64_t count() const { return samples.load(std::memory_order_relaxed); }
+    uint64_t total() const { return totalNanoseconds.load(std::memory_order_relaxed); }
+    uint64_t max() const { return largest.load(std::memory_order_relaxed); }
+    uint64_t linesTouched() const { return lines.load(std::memory_order_relaxed); }
+    uint64_t bytesMoved() const { return bytes.load(std::memory_order_relaxed); }
+};
+
+class Stats {
+
+private:
+    std::mutex lock; // only for adding histograms, recording doesn't lock
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms;
+
+    Stats() = default;
+
+public:
+    Stats(const Stats &) = delete;
+
+    static Stats &shared();
+
+    LatencyHistogram &histogram(const std::string &name);
+    void report(std::ostream &out);
+
+    static void touched(uint64_t lines, uint64_t bytes);
+    static uint64_t linesTouched();
+    static uint64_t bytesMoved();
+};
+
+// Times the scope it's in and records it when it ends, with what was touched meanwhile on this thread
+class StatsTimer {
+
+private:
+    LatencyHistogram* histogram;
+    std::chrono::steady_clock::time_point started;
+    uint64_t startLines;
+    uint64_t startBytes;
+
+public:
+    explicit StatsTimer(LatencyHistogram* histogram = nullptr);
+    StatsTimer(const StatsTimer &) = delete;
+    ~StatsTimer();
+
+    // Set once it's known what's being timed, nullptr to not record it after all
+    void recordTo(LatencyHistogram* histogram) { this->histogram = histogram; }
+};
+
+#endif //SPARQ_STATS_H
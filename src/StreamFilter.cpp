@@ -0,0 +1,195 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * StreamFilter .cpp implementation file
+ */
+
+#include "StreamFilter.h"
+
+#include <algorithm>
+#include <regex>
+#include <sstream>
+
+/**
+ * Summary: Reads the script. Throws InvalidScriptException on the first line that isn't a valid edit.
+ *
+ * @param istream &script
+ */
+void StreamFilter::load(std::istream &script) {
+
+    // Same command syntax as the editor
+    std::regex deleteNumExpr("[D][\\s][0-9]+");
+    std::regex deleteNumMExpr("[D][\\s][0-9]+[\\s][0-9]+");
+    std::regex insertNumExpr("[I][\\s][0-9]+");
+
+    std::string line;
+    size_t lineNumber = 0;
+
+    while (getline(script, line)) {
+        lineNumber++;
+
+        std::istringstream ss(line);
+        std::string cmd;
+        uint64_t n = 0;
+        uint64_t m = 0;
+
+        if (line.empty()) {
+            continue;
+        } else if (regex_match(line, deleteNumExpr)) {
+            ss >> cmd >> n;
+            if (n > 0) {
+                deletions.push_back({n, n});
+            }
+        } else if (regex_match(line, deleteNumMExpr)) {
+            ss >> cmd >> n >> m;
+
+            // Like the editor, only when n is less than m, and n less than 1 means 1
+            if (n < m) {
+                deletions.push_back({std::max<uint64_t>(n, 1), m});
+            }
+        } else if (regex_match(line, insertNumExpr)) {
+            ss >> cmd >> n;
+
+            // The line after I n is the text to insert
+            std::string text;
+            if (!getline(script, text)) {
+                throw InvalidScriptException("Script line " + std::to_string(lineNumber) + ": I n needs a line of text after it.");
+            }
+            lineNumber++;
+
+            if (n > 0) {
+                insertions.push_back({n, text});
+            }
+        } else if (line[0] == 'S') {
+            parseSubstitution(line, lineNumber);
+        } else {
+            throw InvalidScriptException("Script line " + std::to_string(lineNumber) + ": '" + line + "' isn't D n, D n m, I n or S/old/new/.");
+        }
+    }
+
+    // Sort the deletions and merge the ones that overlap, so the pass only ever looks at one
+    std::sort(deletions.begin(), deletions.end(), [](const Range &a, const Range &b) { return a.first < b.first; });
+    std::vector<Range> merged;
+    for (const Range &range : deletions) {
+        if (!merged.empty() && range.first <= merged.back().last + 1) {
+            merged.back().last = std::max(merged.back().last, range.last);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    deletions.swap(merged);
+
+    std::stable_sort(insertions.begin(), insertions.end(),
+                     [](const Insertion &a, const Insertion &b) { return a.line < b.line; });
+} // end load method
+
+/**
+ * Summary: Parses S/old/new/ or S n m/old/new/. The character after S (or after the range) is the delimiter.
+ *
+ * @param const string &line
+ * @param size_t lineNumber for error messages
+ */
+void StreamFilter::parseSubstitution(const std::string &line, size_t lineNumber) {
+
+    std::smatch match;
+    std::regex substituteExpr("S(?:[\\s]+([0-9]+)[\\s]+([0-9]+))?[\\s]*([^\\s0-9])(.*)");
+
+    std::string error = "Script line " + std::to_string(lineNumber) + ": '" + line + "' isn't S/old/new/ or S n m/old/new/.";
+    if (!regex_match(line, match, substituteExpr)) {
+        throw InvalidScriptException(error);
+    }
+
+    Substitution substitution;
+    substitution.range = {1, UINT64_MAX};
+    if (match[1].matched) {
+        substitution.range = {std::stoull(match[1].str()), std::stoull(match[2].str())};
+    }
+
+    // old and new are separated by the delimiter, which also has to end the command
+    char delimiter = match[3].str()[0];
+    std::string rest = match[4].str();
+    size_t middle = rest.find(delimiter);
+    if (middle == std::string::npos || middle == 0 || rest.empty() || rest.back() != delimiter || rest.size() - 1 == middle) {
+        throw InvalidScriptException(error);
+    }
+
+    substitution.pattern = rest.substr(0, middle);
+    substitution.replacement = rest.substr(middle + 1, rest.size() - middle - 2);
+    if (substitution.replacement.find(delimiter) != std::string::npos) {
+        throw InvalidScriptException(error);
+    }
+
+    substitutions.push_back(substitution);
+} // end parseSubstitution method
+
+/**
+ * Summary: Copies in to out, applying the script on the way. Reads one line at a time, so memory use
+ * only depends on the longest line. A missing newline at the end of the input stays missing.
+ *
+ * @param istream &in
+ * @param ostream &out
+ * @return number of input lines read
+ */
+uint64_t StreamFilter::run(std::istream &in, std::ostream &out) {
+
+    std::string line;
+    std::string replaced;
+    uint64_t lineNumber = 0;
+    size_t nextDeletion = 0;
+    size_t nextInsertion = 0;
+
+    while (getline(in, line)) {
+        lineNumber++;
+
+        // Inserted lines go before the line they were inserted at
+        while (nextInsertion < insertions.size() && insertions[nextInsertion].line == lineNumber) {
+            out << insertions[nextInsertion].text << '\n';
+            nextInsertion++;
+        }
+
+        // Deletions are sorted and don't overlap, only the next one can cover this line
+        while (nextDeletion < deletions.size() && deletions[nextDeletion].last < lineNumber) {
+            nextDeletion++;
+        }
+        if (nextDeletion < deletions.size() && deletions[nextDeletion].first <= lineNumber) {
+            continue;
+        }
+
+        for (const Substitution &substitution : substitutions) {
+            if (lineNumber < substitution.range.first || lineNumber > substitution.range.last) {
+                continue;
+            }
+
+            size_t found = line.find(substitution.pattern);
+            if (found == std::string::npos) {
+                continue;
+            }
+
+            // Rebuild the line with every occurrence replaced
+            replaced.clear();
+            size_t from = 0;
+            while (found != std::string::npos) {
+                replaced.append(line, from, found - from);
+                replaced += substitution.replacement;
+                from = found + substitution.pattern.size();
+                found = line.find(substitution.pattern, from);
+            }
+            replaced.append(line, from, std::string::npos);
+            line.swap(replaced);
+        }
+
+        out << line;
+        if (!in.eof()) {
+            out << '\n';
+        }
+    }
+
+    out.flush();
+    return lineNumber;
+} // end run method
@@ -0,0 +1,74 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * StreamFilter .h header file
+ *
+ * Streaming mode (SparQ --filter script [input [output]]). Applies a script of edits to the input in one
+ * forward pass without building a linked list, so only the current line is ever held in memory.
+ *
+ * Script lines:
+ *   D n          delete line n
+ *   D n m        delete lines n to m
+ *   I n          insert the next script line before line n
+ *   S/old/new/   replace every occurrence of old with new (any delimiter, S n m/old/new/ for a range)
+ *
+ * Line numbers are always input line numbers, edits don't renumber the lines after them.
+ */
+
+#ifndef SPARQ_STREAMFILTER_H
+#define SPARQ_STREAMFILTER_H
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class StreamFilter {
+
+private:
+    struct Range {
+        uint64_t first;
+        uint64_t last;
+    };
+
+    struct Insertion {
+        uint64_t line;
+        std::string text;
+    };
+
+    struct Substitution {
+        Range range;
+        std::string pattern;
+        std::string replacement;
+    };
+
+    std::vector<Range> deletions; // sorted and merged once the script is loaded
+    std::vector<Insertion> insertions; // sorted by line, script order kept for the same line
+    std::vector<Substitution> substitutions;
+
+    void parseSubstitution(const std::string &line, size_t lineNumber);
+
+public:
+    void load(std::istream &script);
+    uint64_t run(std::istream &in, std::ostream &out);
+};
+
+// Custom Exceptions
+struct InvalidScriptException : public std::exception {
+public:
+    std::string message;
+
+    explicit InvalidScriptException(const std::string &message) : message(message) {}
+    const std::string what() {
+        return message;
+    }
+};//end InvalidScriptException struct
+
+#endif //SPARQ_STREAMFILTER_H
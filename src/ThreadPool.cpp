@@ -0,0 +1,348 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * ThreadPool .cpp implementation file
+ */
+
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+
+// Chunks per thread for parallelFor, a few more than one so faster threads can steal from slower ones
+static const size_t ChunksPerThread = 4;
+
+// Threads the shared pool is started with, 0 for one per core
+static unsigned sharedThreads = 0;
+static std::atomic<bool> sharedStarted(false);
+
+// The pool and queue of the worker running on this thread, if it is one
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local size_t currentQueue = 0;
+
+/**
+ * Constructor
+ *
+ * @param unsigned threads including the submitting thread, at least 1
+ */
+ThreadPool::ThreadPool(unsigned threads) : queued(0), stopping(false) {
+
+    threads = std::max(1u, threads);
+
+    for (unsigned i = 0; i < threads; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back([this, i]() { work(i); });
+    }
+} // end ThreadPool constructor
+
+/**
+ * Destructor
+ *
+ * Tasks still waiting are dropped.
+ */
+ThreadPool::~ThreadPool() {
+
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * Summary: Sets how many threads the shared pool is started with. Only works before anything used it.
+ *
+ * @param unsigned threads 0 for one per core
+ * @return false if the shared pool is already running
+ */
+bool ThreadPool::configure(unsigned threads) {
+
+    if (sharedStarted.load()) {
+        return false;
+    }
+    sharedThreads = threads;
+    return true;
+} // end configure method
+
+/**
+ * Summary: The pool every parallel operation uses, started on first use.
+ *
+ * @return ThreadPool
+ */
+ThreadPool &ThreadPool::shared() {
+
+    static ThreadPool pool(sharedThreads > 0 ? sharedThreads : std::max(1u, std::thread::hardware_concurrency()));
+    sharedStarted.store(true);
+    return pool;
+} // end shared method
+
+/**
+ * Summary: The queue this thread submits to, its own if it's a worker of this pool.
+ *
+ * @return index into queues
+ */
+size_t ThreadPool::ownQueue() const {
+    return currentPool == this ? currentQueue : 0;
+} // end ownQueue method
+
+/**
+ * Summary: Queues a task, it runs on whichever thread gets to it first.
+ *
+ * @param Task task
+ * @param const TaskGroup *group the group it belongs to, whose waiter may run it, or nullptr
+ */
+void ThreadPool::submit(Task task, const TaskGroup* group) {
+
+    Queue &queue = *queues[ownQueue()];
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back({std::move(task), group});
+    }
+    queued.fetch_add(1);
+
+    // Taking the lock makes sure a worker about to sleep sees the task or gets the notification
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wake.notify_one();
+} // end submit method
+
+/**
+ * Summary: Takes the newest task of the thread's own queue, or else steals the oldest of another queue.
+ * Given a group, only that group's tasks are taken.
+ *
+ * @param size_t self own queue
+ * @param const TaskGroup *group nullptr for any task
+ * @param Task &task
+ * @return false if there was no task to take
+ */
+bool ThreadPool::take(size_t self, const TaskGroup* group, Task &task) {
+
+    if (queued.load() == 0) {
+        return false;
+    }
+
+    // Takes the first task from the given end that's wanted
+    auto takeFrom = [this, group, &task](Queue &queue, bool newest) {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        for (size_t i = 0; i < queue.tasks.size(); i++) {
+            auto item = newest ? queue.tasks.end() - 1 - (std::ptrdiff_t) i : queue.tasks.begin() + (std::ptrdiff_t) i;
+            if (group == nullptr || item->group == group) {
+                task = std::move(item->task);
+                queue.tasks.erase(item);
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (takeFrom(*queues[self], true)) {
+        return true;
+    }
+
+    for (size_t i = 1; i < queues.size(); i++) {
+        if (takeFrom(*queues[(self + i) % queues.size()], false)) {
+            return true;
+        }
+    }
+
+    return false;
+} // end take method
+
+/**
+ * Summary: Runs on each worker thread, taking tasks until the pool is destroyed.
+ *
+ * @param size_t self the worker's queue
+ */
+void ThreadPool::work(size_t self) {
+
+    currentPool = this;
+    currentQueue = self;
+    Trace::nameThread("pool worker");
+
+    while (true) {
+        Task task;
+        if (take(self, nullptr, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return stopping || queued.load() > 0; });
+        if (stopping) {
+            return;
+        }
+    }
+} // end work method
+
+/**
+ * Summary: Runs one waiting task on the calling thread, used by threads waiting on tasks to help out.
+ *
+ * @param const TaskGroup *group only a task of this group, nullptr for any
+ * @return false if there was nothing to run
+ */
+bool ThreadPool::runPending(const TaskGroup* group) {
+
+    Task task;
+    if (!take(ownQueue(), group, task)) {
+        return false;
+    }
+    task();
+    return true;
+} // end runPending method
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Constructor
+ *
+ * @param ThreadPool &pool
+ * @param const CancelToken *cancel cancels the group from outside too, may be nullptr
+ */
+TaskGroup::TaskGroup(ThreadPool &pool, const CancelToken* cancel) : pool(pool), outer(cancel), pending(0), queued(0) {}
+
+/**
+ * Destructor
+ *
+ * Tasks refer to the group, so it waits for them. An exception nobody waited for is dropped.
+ */
+TaskGroup::~TaskGroup() {
+
+    try {
+        wait();
+    }
+    catch (...) {
+    }
+}
+
+/**
+ * Summary: Queues a task in the group. It is skipped if the group is cancelled before it starts.
+ *
+ * @param Task task
+ */
+void TaskGroup::run(ThreadPool::Task task) {
+
+    pending.fetch_add(1);
+    queued.fetch_add(1);
+
+    pool.submit([this, task]() {
+        queued.fetch_sub(1);
+        if (!isCancelled()) {
+            try {
+                task();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+                own.cancel();
+            }
+        }
+        complete();
+    }, this);
+
+    // A waiter asleep while the rest of the group ran elsewhere can run this one
+    {
+        std::lock_guard<std::mutex> guard(lock);
+    }
+    finished.notify_all();
+} // end run method
+
+void TaskGroup::complete() {
+
+    // The waiter may destroy the group as soon as pending is 0, so that happens under the lock
+    std::lock_guard<std::mutex> guard(lock);
+    if (pending.fetch_sub(1) == 1) {
+        finished.notify_all();
+    }
+} // end complete method
+
+/**
+ * Summary: Waits for every task of the group, running its queued tasks meanwhile instead of sleeping.
+ * Tasks of other groups are left to the workers, the wait is never held up by unrelated work.
+ * Throws the first exception a task threw.
+ */
+void TaskGroup::wait() {
+
+    while (pending.load() > 0) {
+        if (runPending()) {
+            continue;
+        }
+
+        // Nothing left to help with, the group's last tasks are running on other threads (or a
+        // worker is just taking one)
+        std::unique_lock<std::mutex> guard(lock);
+        finished.wait(guard, [this]() { return pending.load() == 0 || queued.load() > 0; });
+        if (queued.load() > 0) {
+            guard.unlock();
+            std::this_thread::yield();
+        }
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        error = failure;
+        failure = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+} // end wait method
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: Calls body(first, last) over chunks of [begin, end) spread over the shared pool. A range of
+ * less than two grains runs on the calling thread.
+ *
+ * @param size_t begin
+ * @param size_t end
+ * @param size_t grain smallest chunk worth a task
+ * @param const function<void(size_t, size_t)> &body
+ * @param const CancelToken *cancel chunks not started yet are skipped once it's cancelled, may be nullptr
+ * @return false if it was cancelled before every chunk ran
+ */
+bool parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)> &body,
+                 const CancelToken* cancel) {
+
+    if (begin >= end) {
+        return true;
+    }
+
+    ThreadPool &pool = ThreadPool::shared();
+    size_t length = end - begin;
+    size_t chunks = std::min(length / std::max<size_t>(grain, 1), pool.size() * ChunksPerThread);
+
+    if (chunks <= 1 || pool.size() == 1) {
+        if (cancel != nullptr && cancel->isCancelled()) {
+            return false;
+        }
+        body(begin, end);
+        return true;
+    }
+
+    TaskGroup group(pool, cancel);
+    for (size_t c = 0; c < chunks; c++) {
+        size_t first = begin + length * c / chunks;
+        size_t last = begin + length * (c + 1) / chunks;
+        group.run([&body, first, last]() { body(first, last); });
+    }
+    group.wait();
+
+    return !group.isCancelled();
+} // end parallelFor function
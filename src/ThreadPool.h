@@ -0,0 +1,123 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * ThreadPool .h header file
+ *
+ * One set of worker threads shared by everything that works in parallel (sorting, hashing, compressing),
+ * so running several of those at once doesn't start more threads than --threads allows.
+ *
+ * Every worker has its own deque of tasks. A worker takes its newest task first and, when it has none,
+ * steals the oldest task of another worker. Threads outside the pool submit to a deque of their own.
+ * A thread waiting for a TaskGroup helps run that group's tasks, never anyone else's, so a pool of one
+ * thread (no workers) still gets everything done and a wait never runs unrelated work nested inside it.
+ */
+
+#ifndef SPARQ_THREADPOOL_H
+#define SPARQ_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskGroup;
+
+class ThreadPool {
+
+public:
+    typedef std::function<void()> Task;
+
+private:
+    struct Queued {
+        Task task;
+        const TaskGroup* group; // the group it was run in, or nullptr
+    };
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<Queued> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // [0] for threads outside the pool, then one per worker
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued; // tasks waiting in all the queues
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping;
+
+    size_t ownQueue() const;
+    bool take(size_t self, const TaskGroup* group, Task &task);
+    void work(size_t self);
+
+public:
+    // threads counts the thread that submits too, 1 runs everything on that thread
+    explicit ThreadPool(unsigned threads);
+    virtual ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+
+    static bool configure(unsigned threads); // size of the shared pool, 0 for one per core, before first use
+    static ThreadPool &shared();
+
+    unsigned size() const { return (unsigned) workers.size() + 1; }
+
+    void submit(Task task, const TaskGroup* group = nullptr);
+    bool runPending(const TaskGroup* group = nullptr); // runs one waiting task (of the group) on this thread, false if there was none
+};
+
+// Stops work that hasn't started yet, running work can check it to stop early
+class CancelToken {
+
+private:
+    std::atomic<bool> cancelled;
+
+public:
+    CancelToken() : cancelled(false) {}
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+};
+
+// Tasks that are waited for together. The first exception a task throws cancels the rest and is
+// thrown again by wait().
+class TaskGroup {
+
+private:
+    ThreadPool &pool;
+    const CancelToken* outer; // cancels the group too, may be nullptr
+    CancelToken own;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> queued; // tasks of the group that haven't started yet
+    std::mutex lock;
+    std::condition_variable finished;
+    std::exception_ptr failure;
+
+    void complete();
+
+public:
+    explicit TaskGroup(ThreadPool &pool = ThreadPool::shared(), const CancelToken* cancel = nullptr);
+    virtual ~TaskGroup();
+    TaskGroup(const TaskGroup &) = delete;
+
+    void run(ThreadPool::Task task);
+    void wait(); // runs the group's waiting tasks meanwhile, throws what a task threw
+    bool runPending() { return pool.runPending(this); } // runs one of the group's waiting tasks on this thread
+    void cancel() { own.cancel(); }
+    bool isCancelled() const { return own.isCancelled() || (outer != nullptr && outer->isCancelled()); }
+};
+
+bool parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)> &body,
+                 const CancelToken* cancel = nullptr);
+
+#endif //SPARQ_THREADPOOL_H
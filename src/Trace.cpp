@@ -0,0 +1,248 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Trace .cpp implementation file
+ */
+
+#include "Trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::enabled(false);
+
+// One span. Every field is atomic so a ring can be read while its thread writes it.
+struct TraceEvent {
+    std::atomic<uint64_t> sequence; // event number + 1 once written, 0 while it's being written
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> started;
+    std::atomic<uint64_t> ended;
+};
+
+struct TraceRing {
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<uint64_t> written; // events ever written, only its thread writes it
+    int row; // tid in the trace
+    const char* threadName; // guarded by the registry lock
+};
+
+// Every ring ever made, and the rings of threads that have exited, free for the next thread
+struct TraceRegistry {
+    std::mutex lock;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    std::vector<TraceRing*> retired;
+};
+
+/**
+ * Summary: The registry for the whole process. Never destroyed, threads still hand rings back at exit.
+ *
+ * @return registry
+ */
+static TraceRegistry &registry() {
+    static TraceRegistry* rings = new TraceRegistry();
+    return *rings;
+} // end registry function
+
+// The thread's ring, handed back when the thread exits
+struct RingHolder {
+    TraceRing* ring = nullptr;
+    const char* threadName = nullptr;
+
+    ~RingHolder() {
+        if (ring != nullptr) {
+            std::lock_guard<std::mutex> guard(registry().lock);
+            registry().retired.push_back(ring);
+        }
+    }
+};
+
+static thread_local RingHolder holder;
+
+/**
+ * Summary: The calling thread's ring, a retired one or a new one the first time the thread records.
+ *
+ * @return ring
+ */
+static TraceRing &threadRing() {
+
+    if (holder.ring == nullptr) {
+        TraceRegistry &rings = registry();
+        std::lock_guard<std::mutex> guard(rings.lock);
+
+        if (!rings.retired.empty()) {
+            holder.ring = rings.retired.back();
+            rings.retired.pop_back();
+        } else {
+            // Value initialized, every sequence starts at 0
+            std::unique_ptr<TraceRing> ring(new TraceRing());
+            ring->events.reset(new TraceEvent[TraceEventsPerThread]());
+            ring->written.store(0, std::memory_order_relaxed);
+            ring->row = (int) rings.rings.size() + 1;
+            ring->threadName = nullptr;
+            holder.ring = ring.get();
+            rings.rings.push_back(std::move(ring));
+        }
+
+        holder.ring->threadName = holder.threadName; // the row is named after its latest thread
+    }
+    return *holder.ring;
+} // end threadRing function
+
+/**
+ * Summary: Where the trace's clock starts, the first time it's asked for.
+ *
+ * @return time point
+ */
+static std::chrono::steady_clock::time_point traceEpoch() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return epoch;
+} // end traceEpoch function
+
+/**
+ * Summary: Starts recording spans.
+ */
+void Trace::start() {
+    traceEpoch();
+    enabled.store(true);
+} // end start method
+
+/**
+ * Summary: Stops recording spans, what's been recorded is kept.
+ */
+void Trace::stop() {
+    enabled.store(false);
+} // end stop method
+
+/**
+ * Summary: The trace clock.
+ *
+ * @return nanoseconds since tracing first started
+ */
+uint64_t Trace::now() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - traceEpoch()).count();
+} // end now method
+
+/**
+ * Summary: Adds a span to the calling thread's ring, over the oldest one once it's full.
+ *
+ * @param const char *name a string literal
+ * @param uint64_t started from now()
+ * @param uint64_t ended from now()
+ */
+void Trace::record(const char* name, uint64_t started, uint64_t ended) {
+
+    TraceRing &ring = threadRing();
+    uint64_t number = ring.written.load(std::memory_order_relaxed);
+    TraceEvent &event = ring.events[number % TraceEventsPerThread];
+
+    // Marked as being written first, so a reader that sees the old sequence afterwards knows it changed
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    event.name.store(name, std::memory_order_relaxed);
+    event.started.store(started, std::memory_order_relaxed);
+    event.ended.store(ended, std::memory_order_relaxed);
+
+    event.sequence.store(number + 1, std::memory_order_release);
+    ring.written.store(number + 1, std::memory_order_release);
+} // end record method
+
+/**
+ * Summary: Names the calling thread's row in the trace.
+ *
+ * @param const char *name a string literal
+ */
+void Trace::nameThread(const char* name) {
+
+    holder.threadName = name;
+    if (holder.ring != nullptr) {
+        std::lock_guard<std::mutex> guard(registry().lock);
+        holder.ring->threadName = name;
+    }
+} // end nameThread method
+
+/**
+ * Summary: Writes everything in the rings as Chrome trace JSON. Threads can keep recording meanwhile.
+ *
+ * @param ostream &out
+ * @return events written
+ */
+size_t Trace::write(std::ostream &out) {
+
+    TraceRegistry &rings = registry();
+    std::lock_guard<std::mutex> guard(rings.lock);
+
+    size_t events = 0;
+    bool first = true;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\": [";
+
+    for (const std::unique_ptr<TraceRing> &ring : rings.rings) {
+
+        // Name the row
+        out << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << ring->row
+            << ", \"args\": {\"name\": \"";
+        if (ring->threadName != nullptr) {
+            out << ring->threadName;
+        } else {
+            out << "thread " << ring->row;
+        }
+        out << "\"}}";
+        first = false;
+
+        uint64_t written = ring->written.load(std::memory_order_acquire);
+        uint64_t oldest = written > TraceEventsPerThread ? written - TraceEventsPerThread : 0;
+
+        for (uint64_t number = oldest; number < written; ++number) {
+            TraceEvent &event = ring->events[number % TraceEventsPerThread];
+
+            uint64_t sequence = event.sequence.load(std::memory_order_acquire);
+            const char* name = event.name.load(std::memory_order_relaxed);
+            uint64_t started = event.started.load(std::memory_order_relaxed);
+            uint64_t ended = event.ended.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // Overwritten since, or being overwritten now
+            if (sequence != number + 1 || event.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+
+            // Complete events, times in microseconds
+            out << ",\n{\"name\": \"" << name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << ring->row
+                << ", \"ts\": " << (double) started / 1e3 << ", \"dur\": " << (double) (ended - started) / 1e3 << "}";
+            events++;
+        }
+    }
+
+    out << "\n],\n\"displayTimeUnit\": \"ms\"}\n";
+    return events;
+} // end write method
+
+/**
+ * Summary: Writes the trace to a file.
+ *
+ * @param const string &filename
+ * @param size_t &events set to the events written
+ * @return false if the file couldn't be written
+ */
+bool Trace::write(const std::string &filename, size_t &events) {
+
+    std::ofstream file(filename, std::ios::trunc);
+    if (file.fail()) {
+        return false;
+    }
+    events = write(file);
+    file.close();
+    return !file.fail();
+} // end write method
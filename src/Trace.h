@@ -0,0 +1,84 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * Trace .h header file
+ *
+ * Records where time goes while files load and save and commands run, as spans (a name, a start and
+ * an end) written out in the Chrome trace format, for chrome://tracing or ui.perfetto.dev. Tracing
+ * is off until --trace or the TRACE command turns it on, and then a span costs two clock reads and
+ * an event in a buffer of the thread's own. Off, a span is one relaxed atomic load.
+ *
+ * Each thread writes to its own ring of TraceEventsPerThread events without any lock, the oldest
+ * events are overwritten once it's full. Every event has a sequence number written last, so a ring
+ * can be read while its thread keeps writing and an event caught half written is skipped. A thread's
+ * ring is kept when it exits and handed to the next new thread, so loader threads started for each
+ * file share rows of the trace instead of adding a ring each.
+ *
+ * Span names must be string literals, only the pointer is kept.
+ */
+
+#ifndef SPARQ_TRACE_H
+#define SPARQ_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Events kept for each thread, the newest ones
+const size_t TraceEventsPerThread = 1 << 16;
+
+class Trace {
+
+private:
+    static std::atomic<bool> enabled;
+
+public:
+    static void start();
+    static void stop();
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    static uint64_t now();
+    static void record(const char* name, uint64_t started, uint64_t ended);
+    static void nameThread(const char* name);
+
+    static size_t write(std::ostream &out);
+    static bool write(const std::string &filename, size_t &events);
+};
+
+// A span from where it's declared to the end of the scope, recorded only if tracing was on at the start
+class TraceSpan {
+
+private:
+    const char* name;
+    uint64_t started;
+
+public:
+    explicit TraceSpan(const char* name) : name(Trace::isEnabled() ? name : nullptr), started(0) {
+        if (this->name != nullptr) {
+            started = Trace::now();
+        }
+    }
+    TraceSpan(const TraceSpan &) = delete;
+
+    ~TraceSpan() {
+        if (name != nullptr) {
+            Trace::record(name, started, Trace::now());
+        }
+    }
+
+    // Once it's known what the span is, like which command is running
+    void rename(const char* name) {
+        if (this->name != nullptr) {
+            this->name = name;
+        }
+    }
+};
+
+#endif //SPARQ_TRACE_H
@@ -14,107 +14,758 @@
  * by default this is the cmake-build-debug folder.
  */
 
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include "LinkedList.h"
 #include "Editor.h"
+#include "BufferList.h"
+#include "Pager.h"
+#include "StreamFilter.h"
+#include "ExternalSort.h"
+#include "ThreadPool.h"
+#include "Server.h"
+#include "EventLoop.h"
+#include "BatchEdit.h"
+#include "Stats.h"
+#include "Trace.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
 
 // Using namespace
 using namespace std;
 
+// Decompressed blocks kept in memory with --compress (256 lines each)
+const size_t HotBlocks = 64;
+
+// Memory for --sort when --max-mem isn't given
+const size_t DefaultSortMemory = (size_t) 256 << 20;
+
+// Most threads --threads takes
+const size_t MaxThreads = 1024;
+
+// Longest --autosave interval, a day
+const size_t MaxAutosaveSeconds = 86400;
+
+// Where --trace writes the trace at exit
+static std::string traceFile;
+
 // --------------------------------------------------------------------------------
 
 /**
- * Summary: main routine for EDIT text editor
+ * Summary: Parses a size like 512M. Accepts K, M and G suffixes (powers of 1024), plain numbers are bytes.
  *
- * Accepts command line arguments
- * Adapted from: https://www.geeksforgeeks.org/command-line-arguments-in-c-cpp/
+ * @param const string &text
+ * @return size in bytes, 0 if it isn't a valid size
+ */
+static size_t parseSize(const std::string &text) {
+
+    size_t digits = 0;
+    size_t value = 0;
+
+    while (digits < text.size() && isdigit((unsigned char) text[digits])) {
+        value = value * 10 + (text[digits] - '0');
+        digits++;
+    }
+
+    if (digits == 0) { return 0; }
+    if (digits == text.size()) { return value; }
+    if (digits + 1 != text.size()) { return 0; }
+
+    switch (toupper((unsigned char) text[digits])) {
+        case 'K':
+            return value << 10;
+        case 'M':
+            return value << 20;
+        case 'G':
+            return value << 30;
+        default:
+            return 0;
+    }
+} // end parseSize function
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: Read-only view mode. Lists lines straight from the file without loading it into the list,
+ * so the first page shows up right away no matter how big the file is.
  *
- * @param argc
- * @param argv
+ * @param Editor &editor used to recognize the commands
+ * @param const string &filename
  * @return error code
  */
-int main(int argc, char **argv) {
+static int viewFile(Editor &editor, const std::string &filename) {
 
-    // Declare variables
-    Editor editor; // editor object
+    // Pages are read straight from the mapped file, a compressed one has to be loaded to read it
+    if (detectFormat(filename) != formatPlain) {
+        cout << "View mode needs an uncompressed file, open it without --view to edit it." << endl;
+        return 0;
+    }
 
-    // Set the filename using the command line arguments.
-    if (argc > 2) {
+    try {
+        Pager pager(filename);
+        std::string input;
+
+        cout << "view> ";
+
+        // Loop until E command is entered
+        while (getline(cin, input) && editor.checkCommand(input) != cmdE) {
+
+            std::istringstream ss(input);
+            std::string cmd;
+            int n = 0;
+            int m = 0;
+
+            switch (editor.checkCommand(input)) {
+                case cmdL:
+                    pager.cmdList(cout);
+                    break;
+                case cmdLn:
+                    ss >> cmd;
+                    ss >> n;
+                    pager.cmdList(n, cout);
+                    break;
+                case cmdLnm:
+                    ss >> cmd;
+                    ss >> n;
+                    ss >> m;
+                    pager.cmdList(n, m, cout);
+                    break;
+                default:
+                    cout << "View mode is read-only, only L, L n, L n m and E are available." << endl;
+                    break;
+            }
 
-        cout << "EDIT provided with too many arguments." << endl;
-        cout << "EDIT takes either no arguments or a valid filename as an argument." << endl;
-        return 0;
+            cout << "view> ";
+        }
+    }
+    catch (FileFailedToOpenException &e) {
+        cout << e.what() << endl;
+        return 1;
+    }
 
-    } else if (argc == 1) {
+    return 0;
+} // end viewFile function
 
-        // No command line arguments passed except for program name
-        editor.currentLineNumber = 1;
+// --------------------------------------------------------------------------------
 
-    } else if (argc == 2) {
+/**
+ * Summary: Streaming mode. Applies a script of edits from input to output (stdin and stdout when not given)
+ * in a single pass, without loading the file.
+ *
+ * @param const string &scriptName
+ * @param const string &inputName empty or - for stdin
+ * @param const string &outputName empty or - for stdout
+ * @return error code
+ */
+static int filterStream(const std::string &scriptName, const std::string &inputName, const std::string &outputName) {
+
+    // Messages go to stderr, stdout may be the output
+    StreamFilter filter;
+    std::ifstream script(scriptName);
+    if (script.fail()) {
+        cerr << "Unable to open script '" << scriptName << "'." << endl;
+        return 1;
+    }
 
-        // Set the filename using the command line arguments
-        editor.myFileName = argv[1];
+    try {
+        filter.load(script);
+    }
+    catch (InvalidScriptException &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
 
-        //cout << "The filename to be edited is: '" << myFileName << "'" << endl; // TEST
+    bool fromStdin = inputName.empty() || inputName == "-";
+    bool toStdout = outputName.empty() || outputName == "-";
 
-        // Check if the filename is a valid file name.
-        if (editor.isValidFileName(editor.myFileName)) {
+    if (!fromStdin && !toStdout && inputName == outputName) {
+        cerr << "The output can't be the input file, it would be overwritten while it's read." << endl;
+        return 1;
+    }
 
-            //cout << "Filename '" << myFileName << "' is valid." << endl; // TEST
+    std::ifstream inFile;
+    if (!fromStdin) {
+        inFile.open(inputName, std::ios::binary);
+        if (inFile.fail()) {
+            cerr << "Unable to open file '" << inputName << "'." << endl;
+            return 1;
+        }
+    }
 
-            // If file is valid but no '.' exists, assume .txt as the file extension
-            if (editor.myFileName.find('.') == string::npos) {
+    std::ofstream outFile;
+    if (!toStdout) {
+        outFile.open(outputName, std::ios::binary | std::ios::trunc);
+        if (outFile.fail()) {
+            cerr << "Unable to open file '" << outputName << "'." << endl;
+            return 1;
+        }
+    }
 
-                //Add .txt as the file extension
-                editor.myFileName += DefaultFileExt;
+    filter.run(fromStdin ? cin : inFile, toStdout ? cout : outFile);
 
-                //cout << "Default file extension " << DefaultFileExt << " added." << endl; // TEST
-                //cout << "New file name is: '" << myFileName << "'" << endl; // TEST
-            }
+    if (!toStdout) {
+        outFile.close();
+        if (outFile.fail()) {
+            cerr << "Unable to write file '" << outputName << "'." << endl;
+            return 1;
+        }
+    }
+    return 0;
+} // end filterStream function
 
-            // Add each line of the file to the list
-            editor.populateListFromFile(editor.myFileName, &editor.list);
+// --------------------------------------------------------------------------------
 
-            // Get the current line from the number of lines
-            editor.currentLineNumber = editor.list.getLineCount() + 1;
+/**
+ * Summary: Sorts a file (or stdin) straight to another file (or stdout) without loading it into the list.
+ * Lines beyond the memory budget are sorted in runs on disk and merged.
+ *
+ * @param const string &flags N and/or R, like the SORT command
+ * @param size_t memoryLimit
+ * @param const string &inputName empty or - for stdin
+ * @param const string &outputName empty or - for stdout
+ * @return error code
+ */
+static int sortStream(const std::string &flags, size_t memoryLimit, const std::string &inputName, const std::string &outputName) {
+
+    bool fromStdin = inputName.empty() || inputName == "-";
+    bool toStdout = outputName.empty() || outputName == "-";
+
+    std::ifstream inFile;
+    if (!fromStdin) {
+        inFile.open(inputName, std::ios::binary);
+        if (inFile.fail()) {
+            cerr << "Unable to open file '" << inputName << "'." << endl;
+            return 1;
+        }
+    }
+
+    try {
+        ExternalSort sorter(SortOptions::fromFlags(flags), memoryLimit);
+        std::istream &in = fromStdin ? cin : inFile;
+        std::string line;
+
+        while (getline(in, line)) {
+            sorter.add(std::move(line));
+            line.clear();
+        }
+        sorter.finish();
+
+        // The output is only opened once the input has been read, so it can be the input file
+        std::ofstream outFile;
+        if (!toStdout) {
+            inFile.close();
+            outFile.open(outputName, std::ios::binary | std::ios::trunc);
+            if (outFile.fail()) {
+                cerr << "Unable to open file '" << outputName << "'." << endl;
+                return 1;
+            }
+        }
 
-            // List the contents of the file when program starts for testing purposes.
-            // cmdList(&list); // TEST
+        std::ostream &out = toStdout ? cout : outFile;
+        while (sorter.next(line)) {
+            out << line << '\n';
         }
+        out.flush();
+
+        if (out.fail()) {
+            cerr << "Unable to write the sorted lines." << endl;
+            return 1;
+        }
+    }
+    catch (SortFileException &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+} // end sortStream function
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: Batch mode. Runs a script of editor input on every file and saves them, several files at a time.
+ *
+ * @param const string &scriptName
+ * @param const vector<string> &arguments filenames or glob patterns
+ * @param size_t jobs most files edited at once, 0 for one per thread
+ * @return error code, 1 if a file wasn't saved (a file a script without E left unchanged is fine)
+ */
+static int applyScript(const std::string &scriptName, const std::vector<std::string> &arguments, size_t jobs) {
+
+    std::ifstream script(scriptName);
+    if (script.fail()) {
+        cerr << "Unable to open script '" << scriptName << "'." << endl;
+        return 1;
+    }
+
+    BatchEdit batch;
+    batch.load(script);
+
+    std::vector<std::string> files = BatchEdit::expandFiles(arguments);
+    return batch.run(files, jobs > 0 ? jobs : ThreadPool::shared().size(), cout) ? 0 : 1;
+} // end applyScript function
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: Prints how long commands, loads and saves took, for --stats. Runs at exit.
+ */
+static void printStats() {
+    cerr << "Command latency:" << endl;
+    Stats::shared().report(cerr);
+} // end printStats function
+
+/**
+ * Summary: Writes the trace to the file given with --trace. Runs at exit.
+ */
+static void writeTrace() {
+
+    size_t events = 0;
+    if (!Trace::write(traceFile, events)) {
+        cerr << "Unable to write the trace to " << traceFile << "." << endl;
+        return;
+    }
+    cerr << "Wrote " << events << (events == 1 ? " trace event" : " trace events") << " to " << traceFile << "." << endl;
+} // end writeTrace function
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: Prints the prompt for the next command or line of text.
+ *
+ * @param Editor &editor
+ */
+static void printPrompt(Editor &editor) {
+
+    // Prefix with I #> when in Insert mode
+    if (editor.isInsert) {
+        cout << "I " << editor.currentLineNumber << "> ";
     } else {
-        return 1; // Exit with error code
+        cout << editor.currentLineNumber << "> ";
     }
+} // end printPrompt function
 
-    // -----------------------------------------------------------------------------------
+/**
+ * Summary: Runs the line in the current buffer's currentLineInput as a command or adds it as text,
+ * then prompts for the next.
+ *
+ * @param BufferList &buffers
+ * @param bool autosave remove the autosave copy of a buffer E saves
+ * @return false once E has saved and closed the last buffer
+ */
+static bool runLine(BufferList &buffers, bool autosave) {
+
+    Editor &editor = buffers.current();
 
-    // TODO: Extract into linePrompt function
-    // Prompt for command or text to be added
-    cout << editor.currentLineNumber << "> ";
-    getline(cin, editor.currentLineInput);
+    if (editor.exitCommandEntered(editor.currentLineInput, editor.myFileName, &editor.list)) {
+        if (!buffers.closeCurrent(autosave)) {
+            return false;
+        }
+        printPrompt(buffers.current());
+        return true;
+    }
+
+    // Buffer commands switch buffers, so the prompt is the current buffer's after them
+    if (buffers.commandEntered(editor.currentLineInput)) {
+        printPrompt(buffers.current());
+        return true;
+    }
+
+    // Check if a command has been entered
+    if (!editor.textCommandEntered(editor.currentLineInput, editor.ptrCurrentLineNumber, &editor.list, editor.ptrIsInsert)) {
+
+        // Call to add the input as data in the linked list
+        editor.addDataToList(editor.currentLineInput, editor.ptrCurrentLineNumber, &editor.list, editor.ptrIsInsert);
+    }
+
+    // Pick up the real end of the file once a background load is done
+    editor.pollLoading();
+
+    // Report lines the file gained in follow mode
+    editor.pollFollowing();
+
+    printPrompt(editor);
+    return true;
+} // end runLine function
+
+/**
+ * Summary: Reads lines and runs them until the last buffer is closed or the input ends, blocked in
+ * getline between lines. What the background threads do is reported at the next prompt.
+ *
+ * @param BufferList &buffers
+ * @param bool autosave
+ */
+static void readLines(BufferList &buffers, bool autosave) {
+
+    printPrompt(buffers.current());
+    while (getline(cin, buffers.current().currentLineInput) && runLine(buffers, autosave)) {}
+} // end readLines function
 
-    // Loop until E command is entered to save and exit
-    while (!editor.exitCommandEntered(editor.currentLineInput, editor.myFileName, &editor.list)) {
+#ifdef __linux__
+
+/**
+ * Summary: Reads lines from an event loop instead of blocking in getline, so while the editor waits
+ * for input it can report a background load finishing or lines a followed file gained, and write
+ * autosaves. Everything runs on this thread, background threads only post to the loop.
+ *
+ * Falls back to readLines() when the input can't be watched (redirected from a file).
+ *
+ * @param BufferList &buffers
+ * @param size_t autosaveSeconds 0 for no autosave
+ */
+static void runEventLoop(BufferList &buffers, size_t autosaveSeconds) {
 
-        // Check if a command has been entered
-        if (!editor.textCommandEntered(editor.currentLineInput, editor.ptrCurrentLineNumber, &editor.list, editor.ptrIsInsert)) {
+    std::unique_ptr<EventLoop> loop;
+    try {
+        loop.reset(new EventLoop());
+    }
+    catch (EventLoopException &e) {
+        readLines(buffers, autosaveSeconds > 0);
+        return;
+    }
+
+    // Lines typed while commands ran are already in cin's buffer, run them all before prompting again
+    bool watching = loop->watch(STDIN_FILENO, EventReadable, [&](uint32_t) {
+        do {
+            if (!getline(cin, buffers.current().currentLineInput) || !runLine(buffers, autosaveSeconds > 0)) {
+                loop->stop();
+                return;
+            }
+        } while (cin.rdbuf()->in_avail() > 0);
+        cout.flush();
+    });
+
+    if (!watching) {
+        readLines(buffers, autosaveSeconds > 0);
+        return;
+    }
 
-            // Call to add the input as data in the linked list
-            editor.addDataToList(editor.currentLineInput, editor.ptrCurrentLineNumber, &editor.list, editor.ptrIsInsert);
+    // Reports what the current buffer's background threads did and prompts again, if there was
+    // anything to report. Other buffers report when they're switched to.
+    auto reportBackground = [&]() {
+        Editor &editor = buffers.current();
+        std::ostringstream news;
+        int lineNumber = editor.currentLineNumber;
+        bool loadPending = editor.loadPending;
+
+        editor.out = &news;
+        editor.pollLoading();
+        editor.pollFollowing();
+        editor.out = &cout;
+
+        if (loadPending && !editor.loadPending) {
+            news << "Loaded all " << editor.loadedLines << " lines of " << editor.myFileName << "." << endl;
         }
+        if (news.str().empty() && lineNumber == editor.currentLineNumber) {
+            return;
+        }
+
+        cout << endl << news.str();
+        printPrompt(editor);
+        cout.flush();
+    };
+
+    buffers.setBackgroundUpdate([&]() {
+        loop->post(reportBackground);
+    });
+
+    // One round of autosaves at a time, the next timer writes whatever changed meanwhile
+    size_t autosavesRunning = 0;
+    if (autosaveSeconds > 0) {
+        loop->addTimer(autosaveSeconds * 1000, true, [&]() {
+            if (autosavesRunning > 0) {
+                return;
+            }
+            for (size_t i = 0; i < buffers.count(); ++i) {
+                std::string autosaveName = buffers.at(i).myFileName + AutosaveExt;
+                bool started = buffers.at(i).startAutosave([&, autosaveName](bool written) {
+                    loop->post([&, autosaveName, written]() {
+                        autosavesRunning--;
+                        if (!written) {
+                            cout << endl << "Unable to write " << autosaveName << "." << endl;
+                            printPrompt(buffers.current());
+                            cout.flush();
+                        }
+                    });
+                });
+                if (started) {
+                    autosavesRunning++;
+                }
+            }
+        });
+    }
+
+    printPrompt(buffers.current());
+    cout.flush();
+    loop->run();
+
+    // Nothing may post to the loop once it's gone
+    buffers.stopBackground();
+    buffers.setBackgroundUpdate(nullptr);
+} // end runEventLoop function
+
+#endif
+
+// --------------------------------------------------------------------------------
+
+/**
+ * Summary: main routine for EDIT text editor
+ *
+ * Accepts command line arguments
+ * Adapted from: https://www.geeksforgeeks.org/command-line-arguments-in-c-cpp/
+ *
+ * @param argc
+ * @param argv
+ * @return error code
+ */
+int main(int argc, char **argv) {
+
+    // Nothing uses the C streams, and this lets cin buffer ahead so the event loop can see whether
+    // another line is already waiting
+    std::ios::sync_with_stdio(false);
 
-        // Prefix with I #> when in Insert mode
-        if (editor.isInsert) {
-            cout << "I " << editor.currentLineNumber << "> ";
+    // Declare variables
+    Editor editor; // recognizes the commands in view mode
+
+    // Separate the option flags from the filename
+    std::string fileArgument;
+    std::string outputArgument; // second filename, only used by --filter
+    int fileArguments = 0;
+    bool compressLines = false;
+    codec blockCodec = codecLZ;
+    size_t memoryLimit = 0;
+    bool viewOnly = false;
+    bool followFile = false;
+    std::string filterScript;
+    bool sortOnly = false;
+    std::string sortFlags;
+    std::string serveSocket;
+    std::string connectSocket;
+    std::string applyScriptName;
+    std::vector<std::string> fileList; // every filename, --apply takes any number
+    size_t jobs = 0;
+    bool threadsGiven = false;
+    size_t autosaveSeconds = 0;
+    bool internLines = false;
+    bool statsAtExit = false;
+
+    for (int arg = 1; arg < argc; ++arg) {
+        std::string option = argv[arg];
+
+        if (option == "--view") {
+            // Read-only pager, the file is never loaded into the list
+            viewOnly = true;
+        } else if (option == "-f" || option == "--follow") {
+            // Keep appending whatever is written to the end of the file, like tail -f
+            followFile = true;
+        } else if (option == "--filter" && arg + 1 < argc) {
+            // Stream the input through a script of edits instead of editing it
+            filterScript = argv[++arg];
+        } else if (option == "--sort" || option.compare(0, 7, "--sort=") == 0) {
+            // Sort the input to the output without editing it, --sort=NR for numeric and reverse
+            sortOnly = true;
+            sortFlags = option.size() > 7 ? option.substr(7) : "";
+        } else if (option == "--intern") {
+            // Share the storage of identical lines
+            internLines = true;
+        } else if (option == "--compress" || option == "--compress=zlib") {
+            // Keep lines compressed in blocks, only recently used blocks stay decompressed
+            compressLines = true;
+            blockCodec = option == "--compress" ? codecLZ : codecZlib;
+        } else if (option == "--max-mem" && arg + 1 < argc) {
+            // Memory budget for the lines of every open file together, blocks past it are spilled to a swap file
+            memoryLimit = parseSize(argv[++arg]);
+            if (memoryLimit == 0) {
+                cout << "Invalid memory size '" << argv[arg] << "', use a number with K, M or G (e.g. 512M)." << endl;
+                return 0;
+            }
+        } else if (option == "--threads" && arg + 1 < argc) {
+            // Threads for parallel work, counting the editor's own, so SparQ can share the machine
+            std::string count = argv[++arg];
+            size_t threads = count.find_first_not_of("0123456789") == string::npos ? parseSize(count) : 0;
+            if (threads == 0 || threads > MaxThreads) {
+                cout << "Invalid thread count '" << argv[arg] << "', use a number from 1 to " << MaxThreads << "." << endl;
+                return 0;
+            }
+            ThreadPool::configure((unsigned) threads);
+            threadsGiven = true;
+        } else if (option == "--apply" && arg + 1 < argc) {
+            // Run a script of editor input on every file given
+            applyScriptName = argv[++arg];
+        } else if (option == "--jobs" && arg + 1 < argc) {
+            // Files --apply edits at once
+            std::string count = argv[++arg];
+            jobs = count.find_first_not_of("0123456789") == string::npos ? parseSize(count) : 0;
+            if (jobs == 0 || jobs > MaxThreads) {
+                cout << "Invalid job count '" << argv[arg] << "', use a number from 1 to " << MaxThreads << "." << endl;
+                return 0;
+            }
+        } else if (option == "--autosave" && arg + 1 < argc) {
+            // Write a copy of the text to filename.autosave every so many seconds while it's edited
+            std::string seconds = argv[++arg];
+            autosaveSeconds = seconds.find_first_not_of("0123456789") == string::npos ? parseSize(seconds) : 0;
+            if (autosaveSeconds == 0 || autosaveSeconds > MaxAutosaveSeconds) {
+                cout << "Invalid autosave interval '" << argv[arg] << "', use a number of seconds from 1 to "
+                     << MaxAutosaveSeconds << "." << endl;
+                return 0;
+            }
+        } else if (option == "--serve" && arg + 1 < argc) {
+            // Keep files loaded and take commands from clients over a Unix socket
+            serveSocket = argv[++arg];
+        } else if (option == "--connect" && arg + 1 < argc) {
+            // Edit a file loaded by a server instead of loading it here
+            connectSocket = argv[++arg];
+        } else if (option == "--trace" && arg + 1 < argc) {
+            // Record load, save and command spans and write them as Chrome trace JSON at exit
+            traceFile = argv[++arg];
+        } else if (option == "--stats") {
+            // Print how long commands took when the program exits (STATS prints it any time)
+            statsAtExit = true;
+        } else if (option.compare(0, 2, "--") == 0) {
+            cout << "Unknown option '" << option << "'." << endl;
+            cout << "Usage: SparQ [--intern] [--compress[=zlib]] [--max-mem size] [--threads n] [--autosave seconds] [--stats] [--trace file] [--view] [-f] [filename]" << endl;
+            cout << "       SparQ --filter script [input [output]]" << endl;
+            cout << "       SparQ --sort[=NR] [--max-mem size] [--threads n] [input [output]]" << endl;
+            cout << "       SparQ --serve socket [--threads n] [--stats] [--trace file]" << endl;
+            cout << "       SparQ --connect socket filename" << endl;
+            cout << "       SparQ --apply script [--jobs n] [--threads n] [--stats] [--trace file] files..." << endl;
+            return 0;
         } else {
-            cout << editor.currentLineNumber << "> ";
+            if (fileArguments == 0) {
+                fileArgument = option;
+            } else {
+                outputArgument = option;
+            }
+            fileList.push_back(option);
+            fileArguments++;
+        }
+    }
+
+    if (statsAtExit) {
+        std::atexit(printStats);
+    }
+
+    Trace::nameThread("main");
+    if (!traceFile.empty()) {
+        Trace::start();
+        std::atexit(writeTrace);
+    }
+
+    if (!applyScriptName.empty()) {
+        if (fileArguments == 0) {
+            cerr << "Usage: SparQ --apply script [--jobs n] [--threads n] files..." << endl;
+            return 1;
+        }
+
+        // A thread per job unless the thread count was given
+        if (jobs > 0 && !threadsGiven) {
+            ThreadPool::configure((unsigned) jobs);
+        }
+        return applyScript(applyScriptName, fileList, jobs);
+    }
+
+    if (!filterScript.empty()) {
+        if (fileArguments > 2) {
+            cerr << "Usage: SparQ --filter script [input [output]]" << endl;
+            return 1;
         }
+        return filterStream(filterScript, fileArgument, outputArgument);
+    }
 
-        // Wait for line input
-        getline(cin, editor.currentLineInput);
+    if (sortOnly) {
+        if (fileArguments > 2 || sortFlags.find_first_not_of("NR") != std::string::npos) {
+            cerr << "Usage: SparQ --sort[=NR] [--max-mem size] [--threads n] [input [output]]" << endl;
+            return 1;
+        }
+        return sortStream(sortFlags, memoryLimit > 0 ? memoryLimit : DefaultSortMemory, fileArgument, outputArgument);
+    }
 
+    if (!serveSocket.empty()) {
+        if (fileArguments != 0) {
+            cerr << "Usage: SparQ --serve socket [--threads n]" << endl;
+            return 1;
+        }
+        try {
+            Server server(serveSocket);
+            return server.run();
+        }
+        catch (ServerException &e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+
+    if (!connectSocket.empty()) {
+        if (fileArguments != 1) {
+            cerr << "Usage: SparQ --connect socket filename" << endl;
+            return 1;
+        }
+        return connectToServer(connectSocket, fileArgument);
     }
 
+    if (viewOnly) {
+        if (fileArguments != 1) {
+            cout << "View mode needs exactly one filename." << endl;
+            return 0;
+        }
+        return viewFile(editor, fileArgument);
+    }
+
+    if (followFile && fileArguments != 1) {
+        cout << "Follow mode needs exactly one filename." << endl;
+        return 0;
+    }
+
+    // A memory budget needs the block store, compressed with the built-in codec unless asked otherwise
+    bool storeLines = compressLines || memoryLimit > 0;
+    if (storeLines && !isCodecAvailable(blockCodec)) {
+        cout << "zlib is not available in this build, using the built-in codec." << endl;
+        blockCodec = codecLZ;
+    }
+
+    // Every buffer gets its own pool or block store, the budget is split between the stores
+    BufferList buffers([&](Editor &buffer) {
+        if (internLines) {
+            buffer.list.setPool(std::make_shared<LinePool>());
+        }
+        if (storeLines) {
+            buffer.list.setStore(std::make_shared<BlockStore>(blockCodec, HotBlocks));
+        }
+    });
+    buffers.setMemoryLimit(memoryLimit);
+
+    // Set the filename using the command line arguments.
+    if (fileArguments > 1) {
+
+        cout << "EDIT provided with too many arguments." << endl;
+        cout << "EDIT takes either no arguments or a valid filename as an argument." << endl;
+        return 0;
+
+    } else if (fileArguments == 0) {
+
+        // No command line arguments passed except for program name
+        buffers.add();
+
+    } else {
+
+        // Load the file named on the command line, more can be opened with OPEN
+        buffers.open(fileArgument, followFile);
+    }
+
+    // -----------------------------------------------------------------------------------
+
+#ifdef __linux__
+    runEventLoop(buffers, autosaveSeconds);
+#else
+    readLines(buffers, autosaveSeconds > 0);
+#endif
+
     return 0;
 } // end main routine
 
@@ -0,0 +1,216 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * concurrent_reads .cpp test file
+ *
+ * Concurrent mode under load: one writer thread edits a list (changing, inserting, deleting,
+ * patching, reordering and appending lines) while reader threads walk it over and over. Every line
+ * a reader sees has to be a whole line the writer wrote, and once the writer is done the list has to
+ * match the copy the writer kept in a vector. Build it with -fsanitize=thread to check for races.
+ *
+ * Exits with 0 if every check passed.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LinkedList.h"
+
+using namespace std;
+
+// Writer edits, reader threads
+static const int Edits = 20000;
+static const int Readers = 3;
+static const int StartLines = 500;
+
+/**
+ * Summary: A line the readers can check on its own: every character is the same letter, picked
+ * by the length. A line torn between two versions or read after being freed won't match.
+ *
+ * @param size_t length
+ * @return line
+ */
+static string makeLine(size_t length) {
+    return string(length, (char) ('a' + length % 26));
+} // end makeLine function
+
+/**
+ * Summary: Checks a line is one makeLine() wrote.
+ *
+ * @param const string &line
+ * @return true if it is
+ */
+static bool isWholeLine(const string &line) {
+    if (line.empty()) {
+        return false;
+    }
+    char letter = (char) ('a' + line.size() % 26);
+    return all_of(line.begin(), line.end(), [letter](char c) { return c == letter; });
+} // end isWholeLine function
+
+/**
+ * Summary: Finds the node of a line, from the writer's thread.
+ *
+ * @param LinkedList &list
+ * @param int line
+ * @return node
+ */
+static Node* nodeAt(LinkedList &list, int line) {
+    LinkedList::iterator i = list.begin();
+    for (int k = 1; k < line; ++k) {
+        ++i;
+    }
+    return i.node;
+} // end nodeAt function
+
+// --------------------------------------------------------------------------------
+
+int main() {
+
+    LinkedList list;
+    if (!list.setConcurrent(true)) {
+        cout << "FAIL: concurrent mode couldn't be turned on" << endl;
+        return 1;
+    }
+
+    // The writer's copy of what the list should hold
+    vector<string> expected;
+    mt19937 random(12345);
+    uniform_int_distribution<size_t> lengths(1, 80); // short lines fit in the string, longer ones don't
+
+    for (int line = 1; line <= StartLines; ++line) {
+        expected.push_back(makeLine(lengths(random)));
+        list.Add(line, expected.back());
+    }
+
+    atomic<bool> writing(true);
+    atomic<long> linesRead(0);
+    atomic<long> badLines(0);
+
+    vector<thread> readers;
+    for (int r = 0; r < Readers; ++r) {
+        readers.emplace_back([&]() {
+            while (writing.load()) {
+                LinkedList::ReadGuard guard(list);
+                for (LinkedList::ReadCursor cursor = list.readStart(); !cursor.atEnd(); cursor.next()) {
+                    if (!isWholeLine(cursor.line())) {
+                        badLines++;
+                    }
+                    linesRead++;
+                }
+            }
+        });
+    }
+
+    // One writer, every kind of edit concurrent mode supports
+    for (int edit = 0; edit < Edits; ++edit) {
+
+        int count = (int) expected.size();
+        int line = uniform_int_distribution<int>(1, max(count, 1))(random);
+
+        switch (edit % 6) {
+            case 0: {
+                // Change a line
+                string text = makeLine(lengths(random));
+                list.setLine(nodeAt(list, line), text);
+                expected[line - 1] = text;
+                break;
+            }
+            case 1: {
+                // Insert before a line
+                string text = makeLine(lengths(random));
+                list.Insert(line, line, text);
+                list.reorderIndexes();
+                expected.insert(expected.begin() + (line - 1), text);
+                break;
+            }
+            case 2: {
+                // Delete a line, keeping a few
+                if (count > 10) {
+                    list.DeleteWhere(line, line, [](Node*) { return true; });
+                    list.reorderIndexes();
+                    expected.erase(expected.begin() + (line - 1));
+                }
+                break;
+            }
+            case 3: {
+                // Replace up to three lines with up to three others
+                LinePatch patch;
+                patch.first = line;
+                patch.count = min(uniform_int_distribution<int>(0, 3)(random), count - line + 1);
+                int added = uniform_int_distribution<int>(0, 3)(random);
+                for (int k = 0; k < added; ++k) {
+                    patch.lines.push_back(makeLine(lengths(random)));
+                }
+
+                expected.erase(expected.begin() + (line - 1), expected.begin() + (line - 1 + patch.count));
+                expected.insert(expected.begin() + (line - 1), patch.lines.begin(), patch.lines.end());
+
+                vector<LinePatch> patches(1, patch);
+                list.applyPatches(patches);
+                break;
+            }
+            case 4: {
+                // Reverse a run of lines, the way SORT relinks them
+                int last = min(count, line + 7);
+                vector<Node*> nodes;
+                list.collectRange(line, last, nodes);
+                reverse(nodes.begin(), nodes.end());
+                list.relinkRange(line, last, nodes);
+                list.reorderIndexes();
+                reverse(expected.begin() + (line - 1), expected.begin() + last);
+                break;
+            }
+            default: {
+                // Add to the end
+                expected.push_back(makeLine(lengths(random)));
+                list.Add(count + 1, expected.back());
+                break;
+            }
+        }
+    }
+
+    writing.store(false);
+    for (thread &reader : readers) {
+        reader.join();
+    }
+
+    // What the readers saw, then what the list ended up as
+    int failures = 0;
+    if (badLines.load() > 0) {
+        cout << "FAIL: readers saw " << badLines.load() << " broken lines out of " << linesRead.load() << endl;
+        failures++;
+    }
+
+    vector<string> actual;
+    int index = 0;
+    bool numbered = true;
+    for (LinkedList::iterator i = list.begin(); i != list.end(); ++i) {
+        actual.push_back(*i);
+        numbered = numbered && i.node->index == ++index;
+    }
+    if (actual != expected) {
+        cout << "FAIL: the list has " << actual.size() << " lines, " << expected.size() << " expected, or they differ" << endl;
+        failures++;
+    }
+    if (!numbered) {
+        cout << "FAIL: the lines aren't numbered 1 to " << actual.size() << endl;
+        failures++;
+    }
+
+    if (failures == 0) {
+        cout << "PASS: " << Edits << " edits, " << linesRead.load() << " lines read by " << Readers << " readers" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+} // end main function
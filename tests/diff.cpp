@@ -0,0 +1,168 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * diff .cpp test file
+ *
+ * LineDiff on random pairs of short sequences from a small alphabet, so lines repeat a lot: the
+ * changes have to turn the old sequence into the new one and be as few as the longest common
+ * subsequence allows. Then writeUnified on a few fixed cases, against what diff -u prints.
+ *
+ * Exits with 0 if every check passed.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Diff.h"
+
+using namespace std;
+
+// Random pairs tried, and the longest sequence in them
+static const int Pairs = 3000;
+static const int MaxLines = 40;
+
+/**
+ * Summary: Length of the longest common subsequence, the slow way.
+ *
+ * @param const vector<uint64_t> &a
+ * @param const vector<uint64_t> &b
+ * @return length
+ */
+static int commonLength(const vector<uint64_t> &a, const vector<uint64_t> &b) {
+
+    vector<vector<int>> table(a.size() + 1, vector<int>(b.size() + 1, 0));
+    for (size_t x = 1; x <= a.size(); x++) {
+        for (size_t y = 1; y <= b.size(); y++) {
+            table[x][y] = a[x - 1] == b[y - 1] ? table[x - 1][y - 1] + 1 : max(table[x - 1][y], table[x][y - 1]);
+        }
+    }
+    return table[a.size()][b.size()];
+} // end commonLength function
+
+/**
+ * Summary: Checks the changes are in order, turn a into b, and change no more lines than needed.
+ *
+ * @param const vector<uint64_t> &a
+ * @param const vector<uint64_t> &b
+ * @return true if they do
+ */
+static bool checkChanges(const vector<uint64_t> &a, const vector<uint64_t> &b) {
+
+    LineDiff diff(a, b);
+
+    vector<uint64_t> rebuilt;
+    int x = 0;
+    int changed = 0;
+    for (const DiffChange &change : diff.changes()) {
+        if (change.oldStart < x || change.oldEnd < change.oldStart || change.newEnd < change.newStart ||
+            change.oldEnd > (int) a.size() || change.newEnd > (int) b.size()) {
+            return false;
+        }
+        // Unchanged lines, then the new side of the change
+        rebuilt.insert(rebuilt.end(), a.begin() + x, a.begin() + change.oldStart);
+        if ((int) rebuilt.size() != change.newStart) {
+            return false;
+        }
+        rebuilt.insert(rebuilt.end(), b.begin() + change.newStart, b.begin() + change.newEnd);
+        changed += (change.oldEnd - change.oldStart) + (change.newEnd - change.newStart);
+        x = change.oldEnd;
+    }
+    rebuilt.insert(rebuilt.end(), a.begin() + x, a.end());
+
+    return rebuilt == b && changed == (int) (a.size() + b.size()) - 2 * commonLength(a, b);
+} // end checkChanges function
+
+/**
+ * Summary: Runs writeUnified on two texts given one line per character.
+ *
+ * @param const string &oldText
+ * @param const string &newText
+ * @return the diff
+ */
+static string unified(const string &oldText, const string &newText) {
+
+    DiffLines oldLines;
+    DiffLines newLines;
+    for (const char &c : oldText) {
+        oldLines.add(&c, 1);
+    }
+    for (const char &c : newText) {
+        newLines.add(&c, 1);
+    }
+
+    string output;
+    LineDiff(oldLines.hashes, newLines.hashes).writeUnified(output, oldLines, newLines, "old", "new");
+    return output;
+} // end unified function
+
+// --------------------------------------------------------------------------------
+
+int main() {
+
+    int failures = 0;
+
+    mt19937 random(7);
+    uniform_int_distribution<int> lengths(0, MaxLines);
+    uniform_int_distribution<int> letters(1, 4);
+
+    int wrong = 0;
+    for (int pair = 0; pair < Pairs; pair++) {
+        vector<uint64_t> a(lengths(random));
+        vector<uint64_t> b(lengths(random));
+        generate(a.begin(), a.end(), [&]() { return (uint64_t) letters(random); });
+        generate(b.begin(), b.end(), [&]() { return (uint64_t) letters(random); });
+
+        // Half the time the new side is an edit of the old one, like most real diffs
+        if (pair % 2 == 0 && !a.empty()) {
+            b = a;
+            b.erase(b.begin() + uniform_int_distribution<int>(0, (int) b.size() - 1)(random));
+            b.insert(b.begin() + uniform_int_distribution<int>(0, (int) b.size())(random), (uint64_t) letters(random));
+        }
+
+        if (!checkChanges(a, b)) {
+            wrong++;
+        }
+    }
+    if (wrong > 0) {
+        cout << "FAIL: " << wrong << " of " << Pairs << " random diffs were wrong or not minimal" << endl;
+        failures++;
+    }
+
+    // What diff -u prints for the same lines
+    struct Case {
+        const char* name;
+        string oldText;
+        string newText;
+        string expected;
+    };
+    vector<Case> cases = {
+        {"no changes", "abc", "abc", ""},
+        {"one hunk", "abcdefg", "abXdefgh",
+         "--- old\n+++ new\n@@ -1,7 +1,8 @@\n a\n b\n-c\n+X\n d\n e\n f\n g\n+h\n"},
+        {"two hunks", "abcdefghijklmn", "aBcdefghijklmN",
+         "--- old\n+++ new\n@@ -1,5 +1,5 @@\n a\n-b\n+B\n c\n d\n e\n@@ -11,4 +11,4 @@\n k\n l\n m\n-n\n+N\n"},
+        {"into an empty file", "", "ab", "--- old\n+++ new\n@@ -0,0 +1,2 @@\n+a\n+b\n"},
+        {"everything deleted", "a", "", "--- old\n+++ new\n@@ -1 +0,0 @@\n-a\n"},
+    };
+    for (const Case &test : cases) {
+        string output = unified(test.oldText, test.newText);
+        if (output != test.expected) {
+            cout << "FAIL: unified diff, " << test.name << ":\n" << output;
+            failures++;
+        }
+    }
+
+    if (failures == 0) {
+        cout << "PASS: " << Pairs << " random diffs and " << cases.size() << " unified diffs" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+} // end main function
@@ -0,0 +1,136 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * external_sort .cpp test file
+ *
+ * ExternalSort against std::stable_sort with the same comparison, for input that fits in one run,
+ * input spread over a few runs (one loser tree merge) and input over more than MaxFanIn runs (merged
+ * in several passes). Numeric keys repeat with different text, so a merge that isn't stable shows.
+ *
+ * Exits with 0 if every check passed.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ExternalSort.h"
+
+using namespace std;
+
+// Smallest budget ExternalSort takes, each run is half of it
+static const size_t Budget = 2 << 20;
+
+/**
+ * Summary: Lines with a leading number from a small range, so many share a numeric key, and a
+ * random tail that tells them apart.
+ *
+ * @param size_t count
+ * @param mt19937 &random
+ * @return lines
+ */
+static vector<string> makeLines(size_t count, mt19937 &random) {
+
+    uniform_int_distribution<int> numbers(-500, 500);
+    uniform_int_distribution<int> letters('a', 'z');
+    uniform_int_distribution<int> lengths(0, 40);
+
+    vector<string> lines;
+    lines.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        string line = to_string(numbers(random)) + " ";
+        for (int k = lengths(random); k > 0; k--) {
+            line += (char) letters(random);
+        }
+        lines.push_back(line);
+    }
+    return lines;
+} // end makeLines function
+
+/**
+ * Summary: Sorts the lines with ExternalSort and checks them against std::stable_sort.
+ *
+ * @param const string &name
+ * @param const vector<string> &lines
+ * @param const string &flags N and/or R
+ * @param size_t minRuns fewest runs spilled before the last one
+ * @return true if it passed
+ */
+static bool check(const string &name, const vector<string> &lines, const string &flags, size_t minRuns) {
+
+    SortOptions options = SortOptions::fromFlags(flags);
+
+    vector<string> expected = lines;
+    stable_sort(expected.begin(), expected.end(), [&options](const string &a, const string &b) {
+        return lessThanLine(a, b, options);
+    });
+
+    vector<string> actual;
+    size_t runs;
+    {
+        ExternalSort sorter(options, Budget);
+        for (const string &line : lines) {
+            string copy = line;
+            sorter.add(move(copy));
+        }
+        runs = sorter.runCount(); // before finish() merges them down
+        sorter.finish();
+
+        string line;
+        while (sorter.next(line)) {
+            actual.push_back(line);
+        }
+    }
+
+    if (runs < minRuns) {
+        cout << "FAIL: " << name << " made " << runs << " runs, at least " << minRuns << " expected" << endl;
+        return false;
+    }
+    if (actual != expected) {
+        size_t first = 0;
+        while (first < actual.size() && first < expected.size() && actual[first] == expected[first]) {
+            first++;
+        }
+        cout << "FAIL: " << name << " sorted " << actual.size() << " lines, " << expected.size()
+             << " expected, first difference at line " << first + 1 << endl;
+        return false;
+    }
+    return true;
+} // end check function
+
+// --------------------------------------------------------------------------------
+
+int main() {
+
+    mt19937 random(2024);
+    int failures = 0;
+
+    // Nothing at all, and one run that never leaves memory
+    failures += check("empty input", vector<string>(), "", 0) ? 0 : 1;
+    vector<string> small = makeLines(2000, random);
+    failures += check("one run", small, "", 0) ? 0 : 1;
+    failures += check("one run, numeric", small, "N", 0) ? 0 : 1;
+
+    // A few runs, merged by one loser tree
+    vector<string> some = makeLines(60000, random);
+    failures += check("a few runs", some, "", 3) ? 0 : 1;
+    failures += check("a few runs, numeric", some, "N", 3) ? 0 : 1;
+    failures += check("a few runs, numeric reversed", some, "NR", 3) ? 0 : 1;
+
+    // More runs than one merge takes, merged in groups first
+    vector<string> many = makeLines(820000, random);
+    failures += check("more than MaxFanIn runs, numeric", many, "N", ExternalSort::MaxFanIn) ? 0 : 1;
+
+    if (failures == 0) {
+        cout << "PASS: external sort matches stable_sort" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+} // end main function
@@ -0,0 +1,186 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * line_index .cpp test file
+ *
+ * LineIndex sidecars: a saved index loads back the same, an index built while writing saves the same
+ * sidecar as one built by scanning, and a sidecar that is missing, written for a different version of
+ * the file, or damaged in any way is refused.
+ *
+ * Writes its sidecars in the working directory and removes them. Exits with 0 if every check passed.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "LineIndex.h"
+
+using namespace std;
+
+// Small checkpoints, so a small text has plenty of them
+static const uint64_t Interval = 64;
+static const int Lines = 10000;
+
+static const string Sidecar = "line_index_test.sqidx";
+static const string Other = "line_index_test_other.sqidx";
+
+/**
+ * Summary: Reads a whole file.
+ *
+ * @param const string &path
+ * @return its bytes, empty if it can't be read
+ */
+static string readFile(const string &path) {
+    ifstream file(path, ios::binary);
+    return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+} // end readFile function
+
+static void writeFile(const string &path, const string &bytes) {
+    ofstream file(path, ios::binary | ios::trunc);
+    file.write(bytes.data(), (streamsize) bytes.size());
+} // end writeFile function
+
+/**
+ * Summary: Loads a sidecar into a new index.
+ *
+ * @param const string &path
+ * @param const FileSignature &signature
+ * @return true if it was accepted
+ */
+static bool loads(const string &path, const FileSignature &signature) {
+    LineIndex index(Interval);
+    return index.load(path, signature);
+} // end loads function
+
+// --------------------------------------------------------------------------------
+
+int main() {
+
+    int failures = 0;
+
+    // Lines of different lengths, the last one without a newline
+    string text;
+    for (int line = 1; line <= Lines; line++) {
+        text += string((size_t) (line * 7 % 50), 'x') + to_string(line);
+        if (line < Lines) {
+            text += '\n';
+        }
+    }
+    FileSignature signature = {text.size(), 1234567890, 42};
+
+    LineIndex built(Interval);
+    built.build(text.data(), text.size());
+    if (!built.save(Sidecar, signature)) {
+        cout << "FAIL: the sidecar couldn't be written" << endl;
+        return 1;
+    }
+
+    // Loaded back, every checkpoint is where the scan put it
+    LineIndex loaded(Interval);
+    if (!loaded.load(Sidecar, signature)) {
+        cout << "FAIL: a fresh sidecar was refused" << endl;
+        failures++;
+    } else if (loaded.lineCount() != (uint64_t) Lines) {
+        cout << "FAIL: the sidecar has " << loaded.lineCount() << " lines, " << Lines << " expected" << endl;
+        failures++;
+    } else {
+        for (uint64_t line = 1; line <= (uint64_t) Lines; line += Interval) {
+            uint64_t expected = 0;
+            uint64_t actual = 0;
+            if (!built.checkpoint(line, &expected) || !loaded.checkpoint(line, &actual) || actual != expected) {
+                cout << "FAIL: checkpoint for line " << line << " differs" << endl;
+                failures++;
+                break;
+            }
+        }
+    }
+
+    // Built as the file is written, the way a save does it
+    LineIndex written(Interval);
+    uint64_t bytes = 0;
+    uint64_t lines = 0;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == string::npos) {
+            end = text.size();
+        }
+        if (lines > 0 && lines % Interval == 0) {
+            written.addCheckpoint(bytes);
+        }
+        bytes += end - start + (end < text.size() ? 1 : 0);
+        lines++;
+        start = end + 1;
+    }
+    written.finish(lines);
+    if (!written.save(Other, signature) || readFile(Other) != readFile(Sidecar)) {
+        cout << "FAIL: the index built while writing saves a different sidecar" << endl;
+        failures++;
+    }
+
+    // Written for another version of the file
+    FileSignature changed = signature;
+    changed.size++;
+    if (loads(Sidecar, changed)) {
+        cout << "FAIL: a sidecar for a file of another size was loaded" << endl;
+        failures++;
+    }
+    changed = signature;
+    changed.modified++;
+    if (loads(Sidecar, changed)) {
+        cout << "FAIL: a sidecar for a file modified since was loaded" << endl;
+        failures++;
+    }
+    changed = signature;
+    changed.sample++;
+    if (loads(Sidecar, changed)) {
+        cout << "FAIL: a sidecar for a file with other contents was loaded" << endl;
+        failures++;
+    }
+
+    // Missing, cut short, or with any byte changed
+    if (loads("line_index_test_missing.sqidx", signature)) {
+        cout << "FAIL: a missing sidecar was loaded" << endl;
+        failures++;
+    }
+
+    string good = readFile(Sidecar);
+    int accepted = 0;
+    for (size_t length = 0; length < good.size(); length += 7) {
+        writeFile(Other, good.substr(0, length));
+        accepted += loads(Other, signature) ? 1 : 0;
+    }
+    if (accepted > 0) {
+        cout << "FAIL: " << accepted << " sidecars cut short were loaded" << endl;
+        failures++;
+    }
+
+    accepted = 0;
+    for (size_t position = 0; position < good.size(); position++) {
+        string damaged = good;
+        damaged[position] ^= 0x10;
+        writeFile(Other, damaged);
+        accepted += loads(Other, signature) ? 1 : 0;
+    }
+    if (accepted > 0) {
+        cout << "FAIL: " << accepted << " damaged sidecars were loaded" << endl;
+        failures++;
+    }
+
+    std::remove(Sidecar.c_str());
+    std::remove(Other.c_str());
+
+    if (failures == 0) {
+        cout << "PASS: sidecars load back and stale or damaged ones are refused" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+} // end main function
@@ -0,0 +1,115 @@
+/*
+ * Adam Hemeon
+ *
+ * Data Structures: Linked List
+ *
+ *
+ * This program uses the Linked List data structure in a simple text editor.
+ * Keeps the entire text on a linked list, one line in each separate node.
+ *
+ * stream_filter .cpp test file
+ *
+ * StreamFilter scripts run over a small input, mostly S/old/new/ in its different forms (other
+ * delimiters, ranges, an empty replacement), and scripts that have to be refused with
+ * InvalidScriptException.
+ *
+ * Exits with 0 if every check passed.
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "StreamFilter.h"
+
+using namespace std;
+
+// Every case filters this
+static const string Input = "one fish\ntwo fish\nred fish\nblue fish";
+
+/**
+ * Summary: Loads a script and runs it over Input.
+ *
+ * @param const string &script
+ * @return the output
+ */
+static string filter(const string &script) {
+
+    StreamFilter streamFilter;
+    istringstream scriptStream(script);
+    streamFilter.load(scriptStream);
+
+    istringstream in(Input);
+    ostringstream out;
+    streamFilter.run(in, out);
+    return out.str();
+} // end filter function
+
+// --------------------------------------------------------------------------------
+
+int main() {
+
+    int failures = 0;
+
+    struct Case {
+        const char* name;
+        string script;
+        string expected;
+    };
+    vector<Case> cases = {
+        {"empty script", "", Input},
+        {"every line", "S/fish/cat/", "one cat\ntwo cat\nred cat\nblue cat"},
+        {"every occurrence", "S/o/0/", "0ne fish\ntw0 fish\nred fish\nblue fish"},
+        {"another delimiter", "S|fish|a/b|", "one a/b\ntwo a/b\nred a/b\nblue a/b"},
+        {"letter delimiter", "Sxfishxcatx", "one cat\ntwo cat\nred cat\nblue cat"},
+        {"empty replacement", "S/ fish//", "one\ntwo\nred\nblue"},
+        {"range", "S 2 3/fish/cat/", "one fish\ntwo cat\nred cat\nblue fish"},
+        {"range and delimiter", "S 4 4 #blue#green#", "one fish\ntwo fish\nred fish\ngreen fish"},
+        {"in script order", "S/fish/cat/\nS/cat/dog/", "one dog\ntwo dog\nred dog\nblue dog"},
+        {"with deletes and inserts", "D 1\nI 3\nnew\nS/fish/cat/", "two cat\nnew\nred cat\nblue cat"},
+        {"replacement with the pattern", "S/fish/fishfish/", "one fishfish\ntwo fishfish\nred fishfish\nblue fishfish"},
+    };
+    for (const Case &test : cases) {
+        try {
+            string output = filter(test.script);
+            if (output != test.expected) {
+                cout << "FAIL: " << test.name << ", got:\n" << output << endl;
+                failures++;
+            }
+        }
+        catch (InvalidScriptException &e) {
+            cout << "FAIL: " << test.name << ", refused: " << e.what() << endl;
+            failures++;
+        }
+    }
+
+    // Each of these has to be refused
+    vector<string> invalid = {
+        "S",
+        "S/fish",
+        "S/fish/",
+        "S//cat/",
+        "S/fish/cat",
+        "S/fish/c/at/",
+        "S 2/fish/cat/",
+        "S 2 3",
+        "X 1",
+        "I 2",
+    };
+    for (const string &script : invalid) {
+        try {
+            filter(script);
+            cout << "FAIL: '" << script << "' was accepted" << endl;
+            failures++;
+        }
+        catch (InvalidScriptException &e) {
+            // Refused, as it should be
+        }
+    }
+
+    if (failures == 0) {
+        cout << "PASS: " << cases.size() << " scripts run and " << invalid.size() << " refused" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+} // end main function